@@ -0,0 +1,156 @@
+/* Local header files */
+#include "app_options.hpp"
+
+/* Standard libraries */
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Returns the value following the option at index i and advances past it
+std::string TakeValue(int argc, char* argv[], int& i) {
+    if (i + 1 >= argc) {
+        throw std::invalid_argument(std::string("missing value for ") +
+                                    argv[i] + "!");
+    }
+    return argv[++i];
+}
+
+}  // namespace
+
+AppOptions ParseArguments(int argc, char* argv[]) {
+    AppOptions options;
+
+    // The first argument is the name of the executable
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+
+        if (argument == "--benchmark-mips") {
+            options.benchmark_mips = true;
+            options.headless = true;
+        } else if (argument == "--capture-video") {
+            options.video_path = TakeValue(argc, argv, i);
+        } else if (argument == "--capture-format") {
+            std::string format = TakeValue(argc, argv, i);
+            if (format == "yuv420") {
+                options.video_format = VIDEO_FORMAT_YUV420;
+            } else if (format == "rgb") {
+                options.video_format = VIDEO_FORMAT_RGB;
+            } else {
+                throw std::invalid_argument("unknown capture format: " +
+                                            format + "!");
+            }
+        } else if (argument == "--golden") {
+            options.golden_dir = TakeValue(argc, argv, i);
+            options.headless = true;
+        } else if (argument == "--batch") {
+            options.batch_job_path = TakeValue(argc, argv, i);
+            options.headless = true;
+        } else if (argument == "--validate-ktx2") {
+            options.ktx2_validation_dir = TakeValue(argc, argv, i);
+            options.headless = true;
+        } else if (argument == "--update-golden") {
+            options.update_golden = true;
+        } else if (argument == "--platform") {
+            std::string platform = TakeValue(argc, argv, i);
+            if (platform == "auto") {
+                options.window_platform = WINDOW_PLATFORM_AUTO;
+            } else if (platform == "x11") {
+                options.window_platform = WINDOW_PLATFORM_X11;
+            } else if (platform == "wayland") {
+                options.window_platform = WINDOW_PLATFORM_WAYLAND;
+            } else {
+                throw std::invalid_argument("unknown platform: " + platform +
+                                            "!");
+            }
+        } else if (argument == "--latency-log") {
+            options.latency_log_path = TakeValue(argc, argv, i);
+        } else if (argument == "--validation") {
+            options.validation = true;
+        } else if (argument == "--no-validation") {
+            options.validation = false;
+        } else if (argument == "--gpu-validation") {
+            options.gpu_assisted_validation = true;
+        } else if (argument == "--sync-validation") {
+            options.sync_validation = true;
+        } else if (argument == "--overlay") {
+            options.show_overlay = true;
+        } else if (argument == "--metrics-file") {
+            options.metrics_file_path = TakeValue(argc, argv, i);
+        } else if (argument == "--metrics-socket") {
+            options.metrics_socket_path = TakeValue(argc, argv, i);
+        } else if (argument == "--metrics-interval") {
+            std::string seconds = TakeValue(argc, argv, i);
+            if (seconds.empty() ||
+                seconds.find_first_not_of("0123456789") != std::string::npos ||
+                seconds.size() > 5 || std::stoul(seconds) == 0) {
+                throw std::invalid_argument("invalid metrics interval: " +
+                                            seconds + "!");
+            }
+            options.metrics_interval =
+                static_cast<uint32_t>(std::stoul(seconds));
+        } else if (argument == "--recover-device-lost") {
+            options.recover_device_lost = true;
+        } else if (argument == "--render-path") {
+            std::string path = TakeValue(argc, argv, i);
+            if (path == "graphics_pipeline") {
+                options.render_path = RENDER_PATH_GRAPHICS_PIPELINE;
+            } else if (path == "shader_object") {
+                options.render_path = RENDER_PATH_SHADER_OBJECT;
+            } else {
+                throw std::invalid_argument("unknown render path: " + path +
+                                            "!");
+            }
+        } else if (argument == "--windows") {
+            std::string count = TakeValue(argc, argv, i);
+            if (count.empty() ||
+                count.find_first_not_of("0123456789") != std::string::npos ||
+                count.size() > 2 || std::stoul(count) == 0) {
+                throw std::invalid_argument("invalid window count: " + count +
+                                            "!");
+            }
+            options.window_count = static_cast<uint32_t>(std::stoul(count));
+        } else {
+            throw std::invalid_argument("unknown argument: " + argument + "!");
+        }
+    }
+
+    if (options.update_golden && options.golden_dir.empty()) {
+        throw std::invalid_argument("--update-golden requires --golden!");
+    }
+
+    // The validation features run inside the validation layers
+    if (options.gpu_assisted_validation || options.sync_validation) {
+        options.validation = true;
+    }
+
+    if (options.window_count > 1 && options.headless) {
+        throw std::invalid_argument(
+            "--windows cannot be combined with headless rendering!");
+    }
+
+    // Only frames that are presented are paced
+    if (!options.latency_log_path.empty() && options.headless) {
+        throw std::invalid_argument(
+            "--latency-log cannot be combined with headless rendering!");
+    }
+
+    // Recovery restarts the frames of a window, a video would lose its
+    // encoder state
+    if (options.recover_device_lost &&
+        (options.headless || !options.video_path.empty())) {
+        throw std::invalid_argument(
+            "--recover-device-lost cannot be combined with headless rendering "
+            "or --capture-video!");
+    }
+
+    // The metrics describe presented frames
+    if ((!options.metrics_file_path.empty() ||
+         !options.metrics_socket_path.empty()) &&
+        options.headless) {
+        throw std::invalid_argument(
+            "metrics cannot be combined with headless rendering!");
+    }
+
+    return options;
+}
@@ -0,0 +1,93 @@
+#ifndef APP_OPTIONS_H
+#define APP_OPTIONS_H
+
+/* Local header files */
+#include "metrics_exporter.hpp"
+#include "video_capture.hpp"
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+
+// NDEBUG is defined by the Release and RelWithDebInfo build types, which
+// skip the validation layers unless they are requested
+#ifdef NDEBUG
+const bool VALIDATION_BY_DEFAULT = false;
+#else
+const bool VALIDATION_BY_DEFAULT = true;
+#endif
+
+// Window system GLFW connects to on Linux, where both may be available
+enum WindowPlatform : uint32_t {
+    WINDOW_PLATFORM_AUTO,
+    WINDOW_PLATFORM_X11,
+    WINDOW_PLATFORM_WAYLAND,
+};
+
+// How the scene is drawn, chosen at startup so the two can be compared
+enum RenderPath : uint32_t {
+    RENDER_PATH_GRAPHICS_PIPELINE,
+    RENDER_PATH_SHADER_OBJECT,
+};
+
+// Settings taken from the command line
+struct AppOptions {
+    // Time the compute and blit mip generation paths instead of rendering,
+    // without a window
+    bool benchmark_mips = false;
+
+    // Stream every presented frame into this file, "-" for stdout
+    std::string video_path;
+    VideoFormat video_format = VIDEO_FORMAT_YUV420;
+
+    // Render the golden image scenes without a window and compare them
+    // against the images in this directory, or replace those images
+    std::string golden_dir;
+    bool update_golden = false;
+
+    // Render the frames of this job file without a window
+    std::string batch_job_path;
+
+    // Load the KTX2 files of this directory and check which ones are
+    // rejected, without a window or a device
+    std::string ktx2_validation_dir;
+
+    // No window or surface is created, frames go to offscreen images
+    bool headless = false;
+
+    // Windows showing the scene, all presented together
+    uint32_t window_count = 1;
+    WindowPlatform window_platform = WINDOW_PLATFORM_AUTO;
+
+    // Write the input-to-present latency of every frame to this file
+    std::string latency_log_path;
+
+    // Load the validation layers. GPU-assisted validation instruments the
+    // shaders to check descriptor and buffer accesses, synchronization
+    // validation checks for hazards between commands. Both imply the layers.
+    bool validation = VALIDATION_BY_DEFAULT;
+    bool gpu_assisted_validation = false;
+    bool sync_validation = false;
+
+    // Show the performance overlay from the start, F1 toggles it
+    bool show_overlay = false;
+
+    // Export metrics in the Prometheus text format to a file rewritten
+    // every interval in seconds, to a Unix socket, or both
+    std::string metrics_file_path;
+    std::string metrics_socket_path;
+    uint32_t metrics_interval = DEFAULT_METRICS_INTERVAL;
+
+    // Create the device and its resources anew after the device was lost,
+    // instead of exiting
+    bool recover_device_lost = false;
+
+    // Shader objects need VK_EXT_shader_object, the device is not created
+    // without it
+    RenderPath render_path = RENDER_PATH_GRAPHICS_PIPELINE;
+};
+
+// Throws std::invalid_argument for arguments that are not recognized
+AppOptions ParseArguments(int argc, char* argv[]);
+
+#endif  // APP_OPTIONS_H
@@ -0,0 +1,306 @@
+/* Local header files */
+#include "barrier_batch.hpp"
+
+namespace {
+
+VkPipelineStageFlags ToLegacyStages(VkPipelineStageFlags2KHR stages) {
+    if ((stages & (VK_PIPELINE_STAGE_2_COPY_BIT_KHR |
+                   VK_PIPELINE_STAGE_2_RESOLVE_BIT_KHR |
+                   VK_PIPELINE_STAGE_2_BLIT_BIT_KHR |
+                   VK_PIPELINE_STAGE_2_CLEAR_BIT_KHR)) != 0) {
+        stages |= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT_KHR;
+    }
+    if ((stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT_KHR |
+                   VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT_KHR)) != 0) {
+        stages |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT_KHR;
+    }
+    if ((stages & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT_KHR) != 0) {
+        stages |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT_KHR |
+                  VK_PIPELINE_STAGE_2_TESSELLATION_CONTROL_SHADER_BIT_KHR |
+                  VK_PIPELINE_STAGE_2_TESSELLATION_EVALUATION_SHADER_BIT_KHR |
+                  VK_PIPELINE_STAGE_2_GEOMETRY_SHADER_BIT_KHR;
+    }
+
+    // Every other stage has the same bit in both
+    return static_cast<VkPipelineStageFlags>(stages & UINT32_MAX);
+}
+
+VkAccessFlags ToLegacyAccess(VkAccessFlags2KHR access) {
+    if ((access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT_KHR |
+                   VK_ACCESS_2_SHADER_STORAGE_READ_BIT_KHR)) != 0) {
+        access |= VK_ACCESS_2_SHADER_READ_BIT_KHR;
+    }
+    if ((access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR) != 0) {
+        access |= VK_ACCESS_2_SHADER_WRITE_BIT_KHR;
+    }
+
+    // Every other access has the same bit in both
+    return static_cast<VkAccessFlags>(access & UINT32_MAX);
+}
+
+}  // namespace
+
+void Synchronization2::Init(VkDevice device, bool enabled) {
+    pipeline_barrier = nullptr;
+    queue_submit = nullptr;
+    if (!enabled) {
+        return;
+    }
+
+    // Device level extension functions
+    pipeline_barrier = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(
+        vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2KHR"));
+    queue_submit = reinterpret_cast<PFN_vkQueueSubmit2KHR>(
+        vkGetDeviceProcAddr(device, "vkQueueSubmit2KHR"));
+
+    if (pipeline_barrier == nullptr || queue_submit == nullptr) {
+        pipeline_barrier = nullptr;
+        queue_submit = nullptr;
+    }
+}
+
+bool Synchronization2::IsEnabled() const {
+    return pipeline_barrier != nullptr;
+}
+
+void Synchronization2::CmdPipelineBarrier(
+    VkCommandBuffer command_buffer,
+    const VkDependencyInfoKHR& dependency_info) const {
+    pipeline_barrier(command_buffer, &dependency_info);
+}
+
+VkResult Synchronization2::Submit(
+    VkQueue queue, const std::vector<VkSemaphoreSubmitInfoKHR>& waits,
+    const std::vector<VkCommandBuffer>& command_buffers,
+    const std::vector<VkSemaphoreSubmitInfoKHR>& signals,
+    VkFence fence) const {
+    if (IsEnabled()) {
+        std::vector<VkCommandBufferSubmitInfoKHR> command_buffer_infos(
+            command_buffers.size());
+        for (size_t i = 0; i < command_buffers.size(); i++) {
+            command_buffer_infos[i].sType =
+                VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO_KHR;
+            command_buffer_infos[i].commandBuffer = command_buffers[i];
+        }
+
+        VkSubmitInfo2KHR submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2_KHR;
+        submit_info.waitSemaphoreInfoCount =
+            static_cast<uint32_t>(waits.size());
+        submit_info.pWaitSemaphoreInfos = waits.data();
+        submit_info.commandBufferInfoCount =
+            static_cast<uint32_t>(command_buffer_infos.size());
+        submit_info.pCommandBufferInfos = command_buffer_infos.data();
+        submit_info.signalSemaphoreInfoCount =
+            static_cast<uint32_t>(signals.size());
+        submit_info.pSignalSemaphoreInfos = signals.data();
+
+        return queue_submit(queue, 1, &submit_info, fence);
+    }
+
+    // A wait without stages holds up nothing, which the end of the pipe
+    // expresses for vkQueueSubmit. Semaphores are always signaled once
+    // every command has completed.
+    std::vector<VkSemaphore> wait_semaphores(waits.size());
+    std::vector<VkPipelineStageFlags> wait_stages(waits.size());
+    for (size_t i = 0; i < waits.size(); i++) {
+        wait_semaphores[i] = waits[i].semaphore;
+        wait_stages[i] = ToLegacyStages(waits[i].stageMask);
+        if (wait_stages[i] == 0) {
+            wait_stages[i] = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        }
+    }
+
+    std::vector<VkSemaphore> signal_semaphores(signals.size());
+    for (size_t i = 0; i < signals.size(); i++) {
+        signal_semaphores[i] = signals[i].semaphore;
+    }
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.waitSemaphoreCount =
+        static_cast<uint32_t>(wait_semaphores.size());
+    submit_info.pWaitSemaphores = wait_semaphores.data();
+    submit_info.pWaitDstStageMask = wait_stages.data();
+    submit_info.commandBufferCount =
+        static_cast<uint32_t>(command_buffers.size());
+    submit_info.pCommandBuffers = command_buffers.data();
+    submit_info.signalSemaphoreCount =
+        static_cast<uint32_t>(signal_semaphores.size());
+    submit_info.pSignalSemaphores = signal_semaphores.data();
+
+    return vkQueueSubmit(queue, 1, &submit_info, fence);
+}
+
+VkSemaphoreSubmitInfoKHR SemaphoreSubmit(VkSemaphore semaphore,
+                                         VkPipelineStageFlags2KHR stages) {
+    VkSemaphoreSubmitInfoKHR info{};
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR;
+    info.semaphore = semaphore;
+    info.stageMask = stages;
+    return info;
+}
+
+VkImageSubresourceRange ColorLevels(uint32_t base_level,
+                                    uint32_t level_count) {
+    VkImageSubresourceRange range{};
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.baseMipLevel = base_level;
+    range.levelCount = level_count;
+    range.baseArrayLayer = 0;
+    range.layerCount = 1;
+    return range;
+}
+
+void BarrierBatch::AddMemoryBarrier(SyncScope src, SyncScope dst) {
+    VkMemoryBarrier2KHR barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR;
+    barrier.srcStageMask = src.stages;
+    barrier.srcAccessMask = src.access;
+    barrier.dstStageMask = dst.stages;
+    barrier.dstAccessMask = dst.access;
+    memory_barriers.push_back(barrier);
+}
+
+void BarrierBatch::AddBufferBarrier(VkBuffer buffer, VkDeviceSize offset,
+                                    VkDeviceSize size, SyncScope src,
+                                    SyncScope dst) {
+    VkBufferMemoryBarrier2KHR barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+    barrier.srcStageMask = src.stages;
+    barrier.srcAccessMask = src.access;
+    barrier.dstStageMask = dst.stages;
+    barrier.dstAccessMask = dst.access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+    buffer_barriers.push_back(barrier);
+}
+
+void BarrierBatch::AddImageBarrier(VkImage image,
+                                   const VkImageSubresourceRange& range,
+                                   VkImageLayout old_layout,
+                                   VkImageLayout new_layout, SyncScope src,
+                                   SyncScope dst) {
+    VkImageMemoryBarrier2KHR barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+    barrier.srcStageMask = src.stages;
+    barrier.srcAccessMask = src.access;
+    barrier.dstStageMask = dst.stages;
+    barrier.dstAccessMask = dst.access;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = range;
+    image_barriers.push_back(barrier);
+}
+
+bool BarrierBatch::IsEmpty() const {
+    return memory_barriers.empty() && buffer_barriers.empty() &&
+           image_barriers.empty();
+}
+
+void BarrierBatch::Flush(VkCommandBuffer command_buffer,
+                         const Synchronization2& synchronization2) {
+    if (IsEmpty()) {
+        return;
+    }
+
+    if (synchronization2.IsEnabled()) {
+        VkDependencyInfoKHR dependency_info{};
+        dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+        dependency_info.memoryBarrierCount =
+            static_cast<uint32_t>(memory_barriers.size());
+        dependency_info.pMemoryBarriers = memory_barriers.data();
+        dependency_info.bufferMemoryBarrierCount =
+            static_cast<uint32_t>(buffer_barriers.size());
+        dependency_info.pBufferMemoryBarriers = buffer_barriers.data();
+        dependency_info.imageMemoryBarrierCount =
+            static_cast<uint32_t>(image_barriers.size());
+        dependency_info.pImageMemoryBarriers = image_barriers.data();
+
+        synchronization2.CmdPipelineBarrier(command_buffer, dependency_info);
+    } else {
+        FlushLegacy(command_buffer);
+    }
+
+    memory_barriers.clear();
+    buffer_barriers.clear();
+    image_barriers.clear();
+}
+
+void BarrierBatch::FlushLegacy(VkCommandBuffer command_buffer) {
+    /* vkCmdPipelineBarrier takes a single pair of stage masks for all of its
+    barriers, so the batch waits for the union of the source stages before
+    any of the destination stages. The access masks stay per barrier. */
+    VkPipelineStageFlags src_stages = 0;
+    VkPipelineStageFlags dst_stages = 0;
+
+    legacy_memory_barriers.clear();
+    for (const VkMemoryBarrier2KHR& barrier : memory_barriers) {
+        src_stages |= ToLegacyStages(barrier.srcStageMask);
+        dst_stages |= ToLegacyStages(barrier.dstStageMask);
+
+        VkMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccess(barrier.dstAccessMask);
+        legacy_memory_barriers.push_back(legacy);
+    }
+
+    legacy_buffer_barriers.clear();
+    for (const VkBufferMemoryBarrier2KHR& barrier : buffer_barriers) {
+        src_stages |= ToLegacyStages(barrier.srcStageMask);
+        dst_stages |= ToLegacyStages(barrier.dstStageMask);
+
+        VkBufferMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccess(barrier.dstAccessMask);
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.buffer = barrier.buffer;
+        legacy.offset = barrier.offset;
+        legacy.size = barrier.size;
+        legacy_buffer_barriers.push_back(legacy);
+    }
+
+    legacy_image_barriers.clear();
+    for (const VkImageMemoryBarrier2KHR& barrier : image_barriers) {
+        src_stages |= ToLegacyStages(barrier.srcStageMask);
+        dst_stages |= ToLegacyStages(barrier.dstStageMask);
+
+        VkImageMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        legacy.srcAccessMask = ToLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = ToLegacyAccess(barrier.dstAccessMask);
+        legacy.oldLayout = barrier.oldLayout;
+        legacy.newLayout = barrier.newLayout;
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.image = barrier.image;
+        legacy.subresourceRange = barrier.subresourceRange;
+        legacy_image_barriers.push_back(legacy);
+    }
+
+    // Neither mask may be empty without synchronization2
+    if (src_stages == 0) {
+        src_stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    }
+    if (dst_stages == 0) {
+        dst_stages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    }
+
+    vkCmdPipelineBarrier(
+        command_buffer, src_stages, dst_stages, 0,
+        static_cast<uint32_t>(legacy_memory_barriers.size()),
+        legacy_memory_barriers.data(),
+        static_cast<uint32_t>(legacy_buffer_barriers.size()),
+        legacy_buffer_barriers.data(),
+        static_cast<uint32_t>(legacy_image_barriers.size()),
+        legacy_image_barriers.data());
+}
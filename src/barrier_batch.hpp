@@ -0,0 +1,86 @@
+#ifndef BARRIER_BATCH_H
+#define BARRIER_BATCH_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <vector>
+
+/* Device level functions of VK_KHR_synchronization2. They name stages and
+accesses per barrier and per semaphore, e.g. a copy rather than every
+transfer, or a sampled read rather than every shader read.
+
+Without the extension, barriers and submissions go through
+vkCmdPipelineBarrier and vkQueueSubmit instead. The stages and accesses that
+only synchronization2 knows are widened to the ones that contain them. */
+class Synchronization2 {
+   private:
+    PFN_vkCmdPipelineBarrier2KHR pipeline_barrier = nullptr;
+    PFN_vkQueueSubmit2KHR queue_submit = nullptr;
+
+   public:
+    // Only enabled if the feature was enabled on the device
+    void Init(VkDevice device, bool enabled);
+    bool IsEnabled() const;
+
+    void CmdPipelineBarrier(VkCommandBuffer command_buffer,
+                            const VkDependencyInfoKHR& dependency_info) const;
+
+    // Waits for and signals every semaphore at the stages given with it
+    VkResult Submit(VkQueue queue,
+                    const std::vector<VkSemaphoreSubmitInfoKHR>& waits,
+                    const std::vector<VkCommandBuffer>& command_buffers,
+                    const std::vector<VkSemaphoreSubmitInfoKHR>& signals,
+                    VkFence fence) const;
+};
+
+// Stages and the accesses within them on one side of a barrier
+struct SyncScope {
+    VkPipelineStageFlags2KHR stages = VK_PIPELINE_STAGE_2_NONE_KHR;
+    VkAccessFlags2KHR access = VK_ACCESS_2_NONE_KHR;
+};
+
+// Semaphore to wait for or signal at the given stages
+VkSemaphoreSubmitInfoKHR SemaphoreSubmit(VkSemaphore semaphore,
+                                         VkPipelineStageFlags2KHR stages);
+
+// Range of mip levels of the first layer of a color image
+VkImageSubresourceRange ColorLevels(uint32_t base_level, uint32_t level_count);
+
+/* Collects barriers and records all of them with a single command once
+flushed. Barriers that are added together must not depend on each other,
+as they all take effect at once.
+
+A batch keeps its storage between flushes, so one that lives as long as
+its owner records a frame without allocating. */
+class BarrierBatch {
+   private:
+    std::vector<VkMemoryBarrier2KHR> memory_barriers;
+    std::vector<VkBufferMemoryBarrier2KHR> buffer_barriers;
+    std::vector<VkImageMemoryBarrier2KHR> image_barriers;
+
+    // Conversions of the barriers for vkCmdPipelineBarrier
+    std::vector<VkMemoryBarrier> legacy_memory_barriers;
+    std::vector<VkBufferMemoryBarrier> legacy_buffer_barriers;
+    std::vector<VkImageMemoryBarrier> legacy_image_barriers;
+
+    void FlushLegacy(VkCommandBuffer command_buffer);
+
+   public:
+    void AddMemoryBarrier(SyncScope src, SyncScope dst);
+    void AddBufferBarrier(VkBuffer buffer, VkDeviceSize offset,
+                          VkDeviceSize size, SyncScope src, SyncScope dst);
+    void AddImageBarrier(VkImage image, const VkImageSubresourceRange& range,
+                         VkImageLayout old_layout, VkImageLayout new_layout,
+                         SyncScope src, SyncScope dst);
+
+    bool IsEmpty() const;
+
+    // Records every barrier that was added and empties the batch
+    void Flush(VkCommandBuffer command_buffer,
+               const Synchronization2& synchronization2);
+};
+
+#endif  // BARRIER_BATCH_H
@@ -0,0 +1,203 @@
+/* Local header files */
+#include "batch_job.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::sort
+#include <fstream>
+#include <iomanip>
+#include <limits>  // Required for std::numeric_limits
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::string Trim(const std::string& text) {
+    const char* whitespace = " \t\r\n";
+    size_t begin = text.find_first_not_of(whitespace);
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(whitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+// True if the whole value was consumed
+bool IsFullyRead(std::istringstream& stream) {
+    return !stream.fail() && (stream >> std::ws).eof();
+}
+
+// Reads a resolution written as WIDTHxHEIGHT
+bool ReadResolution(std::istringstream& stream, VkExtent2D& resolution) {
+    char separator = 0;
+    stream >> resolution.width >> separator >> resolution.height;
+    return !stream.fail() && separator == 'x' && resolution.width > 0 &&
+           resolution.height > 0;
+}
+
+const char* const VIEW_PLACEHOLDER = "{view}";
+
+}  // namespace
+
+BatchJob LoadBatchJob(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open batch job: " + path + "!");
+    }
+
+    BatchJob job;
+    bool has_frames = false;
+
+    std::string line;
+    uint32_t line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        line = Trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::string location = path + ":" + std::to_string(line_number);
+        size_t separator = line.find('=');
+        if (separator == std::string::npos) {
+            throw std::runtime_error(location + ": expected key = value!");
+        }
+
+        std::string key = Trim(line.substr(0, separator));
+        std::string value = Trim(line.substr(separator + 1));
+        std::istringstream stream(value);
+
+        bool valid = true;
+        if (key == "scene") {
+            job.scene = value;
+        } else if (key == "output") {
+            job.output_pattern = value;
+            valid = value.find('#') != std::string::npos;
+        } else if (key == "resolution") {
+            valid = ReadResolution(stream, job.resolution) &&
+                    IsFullyRead(stream);
+        } else if (key == "frames") {
+            // Either a single frame or an inclusive range
+            char dash = 0;
+            stream >> job.first_frame;
+            job.last_frame = job.first_frame;
+            // Skipping whitespace at the end of the value fails the stream
+            if (!stream.eof() && !(stream >> std::ws).eof()) {
+                stream >> dash >> job.last_frame;
+            }
+            // The last frame number is reserved, so that the frame loop and
+            // the frame count cannot wrap around
+            valid = IsFullyRead(stream) && (dash == 0 || dash == '-') &&
+                    job.first_frame <= job.last_frame &&
+                    job.last_frame < std::numeric_limits<uint32_t>::max();
+            has_frames = true;
+        } else if (key == "camera") {
+            CameraKeyframe keyframe;
+            stream >> keyframe.frame >> keyframe.camera.x >>
+                keyframe.camera.y >> keyframe.camera.zoom >>
+                keyframe.camera.rotation;
+            valid = IsFullyRead(stream);
+            job.camera_path.push_back(keyframe);
+        } else if (key == "view") {
+            BatchView view;
+            stream >> view.name;
+            valid = ReadResolution(stream, view.resolution);
+            stream >> view.camera.x >> view.camera.y >> view.camera.zoom >>
+                view.camera.rotation;
+            valid = valid && IsFullyRead(stream);
+            job.views.push_back(view);
+        } else {
+            throw std::runtime_error(location + ": unknown key " + key + "!");
+        }
+
+        if (!valid) {
+            throw std::runtime_error(location + ": invalid " + key + "!");
+        }
+    }
+
+    if (job.output_pattern.empty() || !has_frames ||
+        (job.resolution.width == 0 && job.views.empty())) {
+        throw std::runtime_error(
+            "batch job needs an output, a resolution and frames!");
+    }
+
+    // Every view needs its own file name
+    if (job.views.size() > 1 &&
+        job.output_pattern.find(VIEW_PLACEHOLDER) == std::string::npos) {
+        throw std::runtime_error(
+            "output of a batch job with views needs {view}!");
+    }
+
+    std::sort(job.camera_path.begin(), job.camera_path.end(),
+              [](const CameraKeyframe& a, const CameraKeyframe& b) {
+                  return a.frame < b.frame;
+              });
+
+    return job;
+}
+
+Camera SampleCameraPath(const std::vector<CameraKeyframe>& camera_path,
+                        uint32_t frame) {
+    if (camera_path.empty()) {
+        return Camera{};
+    }
+
+    // First keyframe after the frame
+    auto next = std::upper_bound(
+        camera_path.begin(), camera_path.end(), frame,
+        [](uint32_t value, const CameraKeyframe& keyframe) {
+            return value < keyframe.frame;
+        });
+
+    if (next == camera_path.begin()) {
+        return next->camera;
+    }
+    if (next == camera_path.end()) {
+        return camera_path.back().camera;
+    }
+
+    const CameraKeyframe& previous = *(next - 1);
+    float t = static_cast<float>(frame - previous.frame) /
+              static_cast<float>(next->frame - previous.frame);
+
+    const Camera& a = previous.camera;
+    const Camera& b = next->camera;
+    Camera camera;
+    camera.x = a.x + (b.x - a.x) * t;
+    camera.y = a.y + (b.y - a.y) * t;
+    camera.zoom = a.zoom + (b.zoom - a.zoom) * t;
+    camera.rotation = a.rotation + (b.rotation - a.rotation) * t;
+    return camera;
+}
+
+Camera CombineCameras(const Camera& base, const Camera& offset) {
+    Camera camera;
+    camera.x = base.x + offset.x;
+    camera.y = base.y + offset.y;
+    camera.zoom = base.zoom * offset.zoom;
+    camera.rotation = base.rotation + offset.rotation;
+    return camera;
+}
+
+std::string FormatOutputPath(const std::string& pattern, uint32_t frame,
+                             const std::string& view_name) {
+    std::string path = pattern;
+    size_t view = path.find(VIEW_PLACEHOLDER);
+    if (view != std::string::npos) {
+        path.replace(view, std::string(VIEW_PLACEHOLDER).size(), view_name);
+    }
+
+    // The first run of '#' sets the width of the frame number
+    size_t begin = path.find('#');
+    if (begin == std::string::npos) {
+        return path;
+    }
+    size_t end = path.find_first_not_of('#', begin);
+    if (end == std::string::npos) {
+        end = path.size();
+    }
+
+    std::ostringstream number;
+    number << std::setw(static_cast<int>(end - begin)) << std::setfill('0')
+           << frame;
+    return path.substr(0, begin) + number.str() + path.substr(end);
+}
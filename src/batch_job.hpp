@@ -0,0 +1,82 @@
+#ifndef BATCH_JOB_H
+#define BATCH_JOB_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "camera.hpp"
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+#include <vector>
+
+// Camera at a given frame of a batch job
+struct CameraKeyframe {
+    uint32_t frame = 0;
+    Camera camera;
+};
+
+// One of several images rendered every frame, with its own resolution and a
+// camera relative to the camera path
+struct BatchView {
+    std::string name;
+    VkExtent2D resolution{};
+    Camera camera;
+};
+
+/* Offline rendering job, read from a text file with one "key = value"
+setting per line. Lines starting with '#' are comments.
+
+    scene = textures/streamed.ktx2
+    resolution = 1920x1080
+    frames = 0-239
+    output = frames/frame_####.png
+    camera = 0 0.0 0.0 1.0 0.0
+    camera = 239 0.25 -0.1 2.0 90.0
+
+The scene is the texture shown behind the triangle. Each camera line is a
+keyframe: frame, x, y, zoom and rotation in degrees. The run of '#' in the
+output path is replaced by the zero padded frame number, and the extension
+picks the image format as for screenshots.
+
+Instead of a single image, every frame can render several views:
+
+    view = left 960x540 -0.5 0.0 1.0 0.0
+    view = detail 512x512 0.0 0.0 4.0 0.0
+    output = frames/{view}_####.png
+
+A view is named and followed by its resolution and its camera, which is
+offset from the camera path: positions and rotations add up, zooms
+multiply. "{view}" in the output path is replaced by the name. */
+struct BatchJob {
+    std::string scene;
+    VkExtent2D resolution{};
+    uint32_t first_frame = 0;
+    uint32_t last_frame = 0;
+    std::string output_pattern;
+
+    // Sorted by frame
+    std::vector<CameraKeyframe> camera_path;
+
+    // Empty unless views are given, in which case they replace the single
+    // image and the resolution is optional
+    std::vector<BatchView> views;
+};
+
+// Throws std::runtime_error naming the line of an invalid setting
+BatchJob LoadBatchJob(const std::string& path);
+
+// Interpolates linearly between the keyframes around the frame. Frames
+// outside of the path hold the camera of the nearest keyframe.
+Camera SampleCameraPath(const std::vector<CameraKeyframe>& camera_path,
+                        uint32_t frame);
+
+// Views are combined with the camera of the path
+Camera CombineCameras(const Camera& base, const Camera& offset);
+
+std::string FormatOutputPath(const std::string& pattern, uint32_t frame,
+                             const std::string& view_name = "");
+
+#endif  // BATCH_JOB_H
@@ -0,0 +1,99 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+bool TriangleApplication::RunBatchJob() {
+    /* Render every frame of the job headlessly and write it to disk. Frames
+    are submitted back to back with MAX_FRAMES_IN_FLIGHT in flight, the
+    readback of a frame is picked up when its slot comes around again, and
+    the images are encoded on the writer threads. Rendering only waits for
+    the writers when they have fallen BATCH_MAX_PENDING_IMAGES behind. Jobs
+    with views render all of them every frame, in a single submission. */
+    camera = SampleCameraPath(batch_job.camera_path, batch_job.first_frame);
+    WarmUpStreaming();
+
+    uint32_t frame_count = batch_job.last_frame - batch_job.first_frame + 1;
+    if (render_views.empty()) {
+        std::cout << "rendering " << frame_count << " frames at "
+                  << swap_chain_extent.width << "x" << swap_chain_extent.height
+                  << std::endl;
+    } else {
+        std::cout << "rendering " << frame_count << " frames of "
+                  << render_views.size() << " views" << std::endl;
+    }
+    uint64_t image_count = static_cast<uint64_t>(frame_count) *
+                           std::max<uint32_t>(1, render_views.size());
+
+    // Only the frames of the job count towards the GPU averages
+    gpu_profiler.ResetAverages();
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t frame = batch_job.first_frame; frame <= batch_job.last_frame;
+         frame++) {
+        image_writer.WaitForPendingBelow(BATCH_MAX_PENDING_IMAGES);
+
+        camera = SampleCameraPath(batch_job.camera_path, frame);
+        if (render_views.empty()) {
+            frame_readback.RequestCapture(
+                FormatOutputPath(batch_job.output_pattern, frame));
+            DrawOffscreenFrame();
+            continue;
+        }
+
+        for (RenderView& view : render_views) {
+            view.frame_readback.RequestCapture(
+                FormatOutputPath(batch_job.output_pattern, frame, view.name));
+        }
+        DrawRenderViews();
+    }
+
+    // Hand the frames still in flight to the writers and wait until
+    // everything is on disk
+    vkDeviceWaitIdle(device);
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frame_readback.Collect(i, image_writer);
+        for (RenderView& view : render_views) {
+            view.frame_readback.Collect(i, image_writer);
+        }
+    }
+    image_writer.WaitIdle();
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "wrote " << image_writer.GetWrittenCount() << " of "
+              << image_count << " images in " << std::fixed
+              << std::setprecision(2) << elapsed.count() << " s ("
+              << frame_count / elapsed.count() << " frames/s)" << std::endl;
+
+    PrintGpuAverages();
+
+    return image_writer.GetWrittenCount() == image_count;
+}
+
+void TriangleApplication::PrintGpuAverages() const {
+    /* One line per scope with its average time and invocation counts, so
+    runs on CI can be compared over time. Counts do not depend on the speed
+    of the machine, which makes them stable even on software renderers. */
+    std::vector<GpuScopeTiming> averages = gpu_profiler.GetAverages();
+    if (averages.empty()) {
+        return;
+    }
+
+    std::cout << std::left << std::setw(20) << "gpu scope" << std::right
+              << std::setw(11) << "time (ms)" << std::setw(10) << "vertices"
+              << std::setw(12) << "primitives" << std::setw(11) << "fragments"
+              << std::setw(9) << "compute" << std::endl;
+    for (const GpuScopeTiming& average : averages) {
+        std::cout << std::left << std::setw(20) << average.name << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(11)
+                  << average.milliseconds;
+
+        if (average.has_statistics) {
+            const GpuScopeStatistics& statistics = average.statistics;
+            std::cout << std::setw(10) << statistics.vertex_invocations
+                      << std::setw(12) << statistics.clipping_primitives
+                      << std::setw(11) << statistics.fragment_invocations
+                      << std::setw(9) << statistics.compute_invocations;
+        }
+        std::cout << std::endl;
+    }
+}
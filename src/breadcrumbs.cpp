@@ -0,0 +1,206 @@
+/* Local header files */
+#include "breadcrumbs.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::sort
+#include <numeric>    // Required for std::iota
+#include <sstream>
+#include <stdexcept>
+
+void Breadcrumbs::Init(VkPhysicalDevice physical_device, VkDevice device,
+                       uint32_t frames_in_flight, uint32_t max_passes,
+                       bool buffer_marker_enabled,
+                       const DebugMarkers& debug_markers) {
+    this->device = device;
+    this->frames_in_flight = frames_in_flight;
+    this->max_passes = max_passes;
+
+    // Device level extension function
+    if (buffer_marker_enabled) {
+        write_buffer_marker = reinterpret_cast<PFN_vkCmdWriteBufferMarkerAMD>(
+            vkGetDeviceProcAddr(device, "vkCmdWriteBufferMarkerAMD"));
+    }
+
+    // A begin and an end marker for every pass of every frame slot
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = sizeof(uint32_t) * frames_in_flight * max_passes * 2;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &buffer_info, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create breadcrumb buffer!");
+    }
+    debug_markers.SetName(buffer, "breadcrumbs");
+
+    VkMemoryRequirements mem_requirements{};
+    vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
+
+    VkPhysicalDeviceMemoryProperties mem_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
+
+    // Coherent memory needs no invalidation, which is no longer possible
+    // once the device is lost
+    const VkMemoryPropertyFlags properties =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    uint32_t memory_type = UINT32_MAX;
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++) {
+        if ((mem_requirements.memoryTypeBits & (1U << i)) &&
+            (mem_properties.memoryTypes[i].propertyFlags & properties) ==
+                properties) {
+            memory_type = i;
+            break;
+        }
+    }
+
+    if (memory_type == UINT32_MAX) {
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex = memory_type;
+
+    if (vkAllocateMemory(device, &alloc_info, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate breadcrumb memory!");
+    }
+    debug_markers.SetName(memory, "breadcrumb memory");
+
+    vkBindBufferMemory(device, buffer, memory, 0);
+
+    // Every marker starts out as never written
+    void* data = nullptr;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+    std::fill_n(static_cast<uint32_t*>(data),
+                static_cast<size_t>(frames_in_flight) * max_passes * 2, 0U);
+    markers = static_cast<const volatile uint32_t*>(data);
+
+    next_frame_number = 1;
+    frame_numbers.assign(frames_in_flight, 0);
+    pass_names.assign(frames_in_flight, {});
+}
+
+void Breadcrumbs::Destroy() {
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkUnmapMemory(device, memory);
+    vkDestroyBuffer(device, buffer, nullptr);
+    vkFreeMemory(device, memory, nullptr);
+
+    buffer = VK_NULL_HANDLE;
+    memory = VK_NULL_HANDLE;
+    markers = nullptr;
+    write_buffer_marker = nullptr;
+    frame_numbers.clear();
+    pass_names.clear();
+}
+
+void Breadcrumbs::BeginFrame(uint32_t frame) {
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // The numbers skip 0 when they wrap around
+    recording_frame = frame;
+    frame_numbers[frame] = next_frame_number;
+    next_frame_number = next_frame_number == UINT32_MAX ? 1
+                                                        : next_frame_number + 1;
+    pass_names[frame].clear();
+}
+
+void Breadcrumbs::BeginPass(VkCommandBuffer command_buffer, uint32_t pass,
+                            const std::string& name) {
+    if (buffer == VK_NULL_HANDLE || pass >= max_passes) {
+        return;
+    }
+
+    std::vector<std::string>& names = pass_names[recording_frame];
+    if (names.size() <= pass) {
+        names.resize(pass + 1);
+    }
+    names[pass] = name;
+
+    // Written once the previous commands have started
+    WriteMarker(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                (recording_frame * max_passes + pass) * 2);
+}
+
+void Breadcrumbs::EndPass(VkCommandBuffer command_buffer, uint32_t pass) {
+    if (buffer == VK_NULL_HANDLE || pass >= max_passes) {
+        return;
+    }
+
+    // Written once the previous commands have completed
+    WriteMarker(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                (recording_frame * max_passes + pass) * 2 + 1);
+}
+
+void Breadcrumbs::WriteMarker(VkCommandBuffer command_buffer,
+                              VkPipelineStageFlagBits stage, uint32_t index) {
+    const VkDeviceSize offset = sizeof(uint32_t) * index;
+    const uint32_t frame_number = frame_numbers[recording_frame];
+
+    if (write_buffer_marker != nullptr) {
+        write_buffer_marker(command_buffer, stage, buffer, offset,
+                            frame_number);
+        return;
+    }
+
+    // The fill waits for the commands before it. No barrier can single out
+    // the fill, so every later transfer of the command buffer waits as well,
+    // which only the fallback without VK_AMD_buffer_marker pays for.
+    if (stage == VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT) {
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                             nullptr, 0, nullptr);
+    }
+    vkCmdFillBuffer(command_buffer, buffer, offset, sizeof(uint32_t),
+                    frame_number);
+}
+
+std::string Breadcrumbs::Describe() const {
+    if (buffer == VK_NULL_HANDLE) {
+        return "no breadcrumbs";
+    }
+
+    // Slots in the order their frames were recorded
+    std::vector<uint32_t> slots(frames_in_flight);
+    std::iota(slots.begin(), slots.end(), 0U);
+    std::sort(slots.begin(), slots.end(), [this](uint32_t a, uint32_t b) {
+        return frame_numbers[a] < frame_numbers[b];
+    });
+
+    std::ostringstream text;
+    for (uint32_t slot : slots) {
+        const uint32_t frame_number = frame_numbers[slot];
+        if (frame_number == 0) {
+            continue;
+        }
+
+        std::string last_completed;
+        std::string in_flight;
+        for (size_t pass = 0; pass < pass_names[slot].size(); pass++) {
+            size_t index = (slot * max_passes + pass) * 2;
+            bool started = markers[index] == frame_number;
+            bool completed = markers[index + 1] == frame_number;
+
+            if (completed) {
+                last_completed = pass_names[slot][pass];
+            } else if (started) {
+                in_flight += (in_flight.empty() ? "" : ", ") +
+                             pass_names[slot][pass];
+            }
+        }
+
+        text << "frame " << frame_number << ": last completed pass "
+             << (last_completed.empty() ? "none" : last_completed)
+             << ", in flight " << (in_flight.empty() ? "none" : in_flight)
+             << "\n";
+    }
+    return text.str();
+}
@@ -0,0 +1,70 @@
+#ifndef BREADCRUMBS_H
+#define BREADCRUMBS_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "debug_markers.hpp"
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+#include <vector>
+
+/* Marks the progress of the GPU through the passes of a frame, so a lost
+device can be traced back to the pass it was executing. Every pass of a
+frame slot owns two markers in a host-visible buffer. The GPU writes the
+number of the frame into the first when it starts the pass and into the
+second once every command of the pass has completed. The memory is mapped
+and coherent, so it can still be read after the device is lost.
+
+With VK_AMD_buffer_marker, the pipeline stages write the markers
+themselves. Otherwise vkCmdFillBuffer writes them, the end marker behind an
+execution barrier that only holds up the fill, so the next pass still
+overlaps with it. Markers are written outside of render passes only, like
+the scopes of the profiler that places them. */
+class Breadcrumbs {
+   private:
+    VkDevice device = VK_NULL_HANDLE;
+    PFN_vkCmdWriteBufferMarkerAMD write_buffer_marker = nullptr;
+    uint32_t frames_in_flight = 0;
+    uint32_t max_passes = 0;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    const volatile uint32_t* markers = nullptr;
+
+    // Number of the frame recorded into every slot, 0 for none. The
+    // numbers start at 1, so a marker that was never written is 0.
+    uint32_t next_frame_number = 1;
+    std::vector<uint32_t> frame_numbers;
+
+    // Frame slot the passes are currently recorded into, and the names of
+    // the passes of every slot
+    uint32_t recording_frame = 0;
+    std::vector<std::vector<std::string>> pass_names;
+
+    void WriteMarker(VkCommandBuffer command_buffer,
+                     VkPipelineStageFlagBits stage, uint32_t index);
+
+   public:
+    void Init(VkPhysicalDevice physical_device, VkDevice device,
+              uint32_t frames_in_flight, uint32_t max_passes,
+              bool buffer_marker_enabled, const DebugMarkers& debug_markers);
+    void Destroy();
+
+    void BeginFrame(uint32_t frame);
+
+    // Passes are numbered from 0 in every frame, those beyond the maximum
+    // are not marked
+    void BeginPass(VkCommandBuffer command_buffer, uint32_t pass,
+                   const std::string& name);
+    void EndPass(VkCommandBuffer command_buffer, uint32_t pass);
+
+    // Progress of every frame slot, oldest frame first, with the last pass
+    // that completed and the passes that were started but did not complete
+    std::string Describe() const;
+};
+
+#endif  // BREADCRUMBS_H
@@ -0,0 +1,26 @@
+/* Local header files */
+#include "camera.hpp"
+
+/* Standard libraries */
+#include <cmath>
+
+CameraPushConstants ComputeCameraPushConstants(const Camera& camera,
+                                               VkExtent2D extent) {
+    float aspect = extent.height > 0 ? static_cast<float>(extent.width) /
+                                           static_cast<float>(extent.height)
+                                     : 1.0F;
+
+    // zoom * S^-1 * R * S, with S scaling x by the aspect ratio
+    const float radians = camera.rotation * 3.14159265F / 180.0F;
+    float cosine = std::cos(radians) * camera.zoom;
+    float sine = std::sin(radians) * camera.zoom;
+
+    CameraPushConstants push_constants;
+    push_constants.transform = {cosine, sine * aspect, -sine / aspect, cosine};
+
+    // The camera position ends up in the center of the target
+    const auto& m = push_constants.transform;
+    push_constants.offset = {-(m[0] * camera.x + m[2] * camera.y),
+                             -(m[1] * camera.x + m[3] * camera.y)};
+    return push_constants;
+}
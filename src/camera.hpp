@@ -0,0 +1,34 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <array>
+
+// 2D camera over the scene, in normalized device coordinates. The default
+// camera shows the scene exactly as the vertex shaders place it.
+struct Camera {
+    float x = 0.0F;
+    float y = 0.0F;
+    float zoom = 1.0F;
+
+    // Counterclockwise, in degrees
+    float rotation = 0.0F;
+};
+
+// Push constants of the scene vertex shaders. The shaders transform every
+// position p into transform * p + offset.
+struct CameraPushConstants {
+    // Column-major 2x2 matrix
+    std::array<float, 4> transform{};
+    std::array<float, 2> offset{};
+};
+
+// Rotation is applied in square units, so the scene is not sheared on
+// targets that are wider than they are tall
+CameraPushConstants ComputeCameraPushConstants(const Camera& camera,
+                                               VkExtent2D extent);
+
+#endif  // CAMERA_H
@@ -0,0 +1,53 @@
+/* Local header files */
+#include "debug_markers.hpp"
+
+// Release builds use the empty definitions of the header
+#ifndef NDEBUG
+
+void DebugMarkers::Init(VkInstance instance, VkDevice device) {
+    this->device = device;
+
+    // The functions of VK_EXT_debug_utils belong to the instance
+    set_object_name = reinterpret_cast<PFN_vkSetDebugUtilsObjectNameEXT>(
+        vkGetInstanceProcAddr(instance, "vkSetDebugUtilsObjectNameEXT"));
+    begin_label = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(
+        vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT"));
+    end_label = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(
+        vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT"));
+}
+
+void DebugMarkers::SetObjectName(VkObjectType type, uint64_t handle,
+                                 const char* name) const {
+    if (set_object_name == nullptr || handle == 0) {
+        return;
+    }
+
+    VkDebugUtilsObjectNameInfoEXT name_info{};
+    name_info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+    name_info.objectType = type;
+    name_info.objectHandle = handle;
+    name_info.pObjectName = name;
+    set_object_name(device, &name_info);
+}
+
+void DebugMarkers::BeginLabel(VkCommandBuffer command_buffer,
+                              const char* name) const {
+    if (begin_label == nullptr) {
+        return;
+    }
+
+    VkDebugUtilsLabelEXT label{};
+    label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+    label.pLabelName = name;
+    begin_label(command_buffer, &label);
+}
+
+void DebugMarkers::EndLabel(VkCommandBuffer command_buffer) const {
+    if (end_label == nullptr) {
+        return;
+    }
+
+    end_label(command_buffer);
+}
+
+#endif  // NDEBUG
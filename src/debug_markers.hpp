@@ -0,0 +1,150 @@
+#ifndef DEBUG_MARKERS_H
+#define DEBUG_MARKERS_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint64_t
+#include <string>
+
+// Release builds carry no object names or command buffer labels
+#ifdef NDEBUG
+const bool DEBUG_MARKERS_ENABLED = false;
+#else
+const bool DEBUG_MARKERS_ENABLED = true;
+#endif
+
+// Object type that VK_EXT_debug_utils expects for a handle type
+template <typename Handle>
+struct DebugObjectType;
+
+template <>
+struct DebugObjectType<VkQueue> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_QUEUE;
+};
+template <>
+struct DebugObjectType<VkCommandBuffer> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_COMMAND_BUFFER;
+};
+template <>
+struct DebugObjectType<VkSemaphore> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_SEMAPHORE;
+};
+template <>
+struct DebugObjectType<VkFence> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_FENCE;
+};
+template <>
+struct DebugObjectType<VkDeviceMemory> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_DEVICE_MEMORY;
+};
+template <>
+struct DebugObjectType<VkBuffer> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_BUFFER;
+};
+template <>
+struct DebugObjectType<VkImage> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_IMAGE;
+};
+template <>
+struct DebugObjectType<VkImageView> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_IMAGE_VIEW;
+};
+template <>
+struct DebugObjectType<VkShaderModule> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_SHADER_MODULE;
+};
+template <>
+struct DebugObjectType<VkPipelineLayout> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_PIPELINE_LAYOUT;
+};
+template <>
+struct DebugObjectType<VkRenderPass> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_RENDER_PASS;
+};
+template <>
+struct DebugObjectType<VkPipeline> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_PIPELINE;
+};
+template <>
+struct DebugObjectType<VkDescriptorSetLayout> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT;
+};
+template <>
+struct DebugObjectType<VkSampler> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_SAMPLER;
+};
+template <>
+struct DebugObjectType<VkDescriptorPool> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_DESCRIPTOR_POOL;
+};
+template <>
+struct DebugObjectType<VkDescriptorSet> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_DESCRIPTOR_SET;
+};
+template <>
+struct DebugObjectType<VkFramebuffer> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_FRAMEBUFFER;
+};
+template <>
+struct DebugObjectType<VkCommandPool> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_COMMAND_POOL;
+};
+template <>
+struct DebugObjectType<VkQueryPool> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_QUERY_POOL;
+};
+template <>
+struct DebugObjectType<VkSwapchainKHR> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_SWAPCHAIN_KHR;
+};
+template <>
+struct DebugObjectType<VkShaderEXT> {
+    static const VkObjectType VALUE = VK_OBJECT_TYPE_SHADER_EXT;
+};
+
+/* Names Vulkan objects and labels regions of command buffers with
+VK_EXT_debug_utils. Graphics debuggers show the names and labels in their
+captures, and the validation layers use the names in their messages.
+
+Without the extension every call does nothing, and release builds compile
+them away entirely. */
+class DebugMarkers {
+   private:
+    VkDevice device = VK_NULL_HANDLE;
+    PFN_vkSetDebugUtilsObjectNameEXT set_object_name = nullptr;
+    PFN_vkCmdBeginDebugUtilsLabelEXT begin_label = nullptr;
+    PFN_vkCmdEndDebugUtilsLabelEXT end_label = nullptr;
+
+    void SetObjectName(VkObjectType type, uint64_t handle,
+                       const char* name) const;
+
+   public:
+    // Only called if VK_EXT_debug_utils was enabled on the instance
+    void Init(VkInstance instance, VkDevice device);
+
+    template <typename Handle>
+    void SetName(Handle handle, const std::string& name) const {
+        if (DEBUG_MARKERS_ENABLED) {
+            SetObjectName(DebugObjectType<Handle>::VALUE,
+                          reinterpret_cast<uint64_t>(handle), name.c_str());
+        }
+    }
+
+    // Labels nest, every begin needs an end in the same command buffer
+    void BeginLabel(VkCommandBuffer command_buffer, const char* name) const;
+    void EndLabel(VkCommandBuffer command_buffer) const;
+};
+
+#ifdef NDEBUG
+inline void DebugMarkers::SetObjectName(VkObjectType /*type*/,
+                                        uint64_t /*handle*/,
+                                        const char* /*name*/) const {}
+inline void DebugMarkers::Init(VkInstance /*instance*/, VkDevice /*device*/) {}
+inline void DebugMarkers::BeginLabel(VkCommandBuffer /*command_buffer*/,
+                                     const char* /*name*/) const {}
+inline void DebugMarkers::EndLabel(VkCommandBuffer /*command_buffer*/) const {}
+#endif
+
+#endif  // DEBUG_MARKERS_H
@@ -0,0 +1,283 @@
+/* Local header files */
+#include "descriptor_allocator.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::min and std::find_if
+#include <array>
+#include <functional>  // Required for std::hash
+#include <stdexcept>
+#include <utility>  // Required for std::move
+
+namespace {
+
+// Sets in the first pool of a frame slot. Every further pool doubles the
+// number up to the maximum.
+const uint32_t INITIAL_SETS_PER_POOL = 16;
+const uint32_t MAX_SETS_PER_POOL = 256;
+
+// Descriptors of every type a pool holds for each of its sets
+const std::array<VkDescriptorPoolSize, 4> DESCRIPTORS_PER_SET = {{
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 4},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+}};
+
+template <typename T>
+void HashCombine(size_t& seed, const T& value) {
+    seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+}  // namespace
+
+bool DescriptorAllocator::CacheKey::operator==(const CacheKey& other) const {
+    if (layout != other.layout || bindings.size() != other.bindings.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < bindings.size(); i++) {
+        const DescriptorBinding& a = bindings[i];
+        const DescriptorBinding& b = other.bindings[i];
+        if (a.binding != b.binding || a.type != b.type ||
+            a.image.sampler != b.image.sampler ||
+            a.image.imageView != b.image.imageView ||
+            a.image.imageLayout != b.image.imageLayout ||
+            a.buffer.buffer != b.buffer.buffer ||
+            a.buffer.offset != b.buffer.offset ||
+            a.buffer.range != b.buffer.range) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t DescriptorAllocator::CacheKeyHash::operator()(
+    const CacheKey& key) const {
+    size_t seed = 0;
+    HashCombine(seed, key.layout);
+    for (const DescriptorBinding& binding : key.bindings) {
+        HashCombine(seed, binding.binding);
+        HashCombine(seed, static_cast<uint32_t>(binding.type));
+        HashCombine(seed, binding.image.sampler);
+        HashCombine(seed, binding.image.imageView);
+        HashCombine(seed, binding.buffer.buffer);
+        HashCombine(seed, binding.buffer.offset);
+    }
+    return seed;
+}
+
+void DescriptorAllocator::Init(VkDevice device, uint32_t frames_in_flight) {
+    this->device = device;
+    frames.assign(frames_in_flight, {});
+    current_frame = 0;
+}
+
+void DescriptorAllocator::Destroy() {
+    for (auto& frame : frames) {
+        for (VkDescriptorPool pool : frame.pools) {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        }
+    }
+    frames.clear();
+
+    // Destroying the pools frees the cached sets as well
+    for (const CachePool& cache_pool : cache_pools) {
+        vkDestroyDescriptorPool(device, cache_pool.pool, nullptr);
+    }
+    cache_pools.clear();
+    cached_sets.clear();
+}
+
+VkDescriptorPool DescriptorAllocator::CreatePool(
+    uint32_t max_sets, VkDescriptorPoolCreateFlags flags) {
+    std::array<VkDescriptorPoolSize, DESCRIPTORS_PER_SET.size()> pool_sizes =
+        DESCRIPTORS_PER_SET;
+    for (auto& pool_size : pool_sizes) {
+        pool_size.descriptorCount *= max_sets;
+    }
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags = flags;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
+    pool_info.maxSets = max_sets;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr, &pool) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+    return pool;
+}
+
+VkDescriptorSet DescriptorAllocator::AllocateFromPool(
+    VkDescriptorPool pool, VkDescriptorSetLayout layout, VkResult& result) {
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = pool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &layout;
+
+    VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+    result = vkAllocateDescriptorSets(device, &alloc_info, &descriptor_set);
+
+    // Running out of a pool is expected, anything else is an error
+    if (result != VK_SUCCESS && result != VK_ERROR_OUT_OF_POOL_MEMORY &&
+        result != VK_ERROR_FRAGMENTED_POOL) {
+        throw std::runtime_error("failed to allocate descriptor set!");
+    }
+    return descriptor_set;
+}
+
+void DescriptorAllocator::BeginFrame(uint32_t frame) {
+    current_frame = frame;
+
+    // The pools are kept, so a frame that needs as many sets as the last one
+    // did creates none
+    FramePools& frame_pools = frames[frame];
+    for (VkDescriptorPool pool : frame_pools.pools) {
+        vkResetDescriptorPool(device, pool, 0);
+    }
+    frame_pools.current_pool = 0;
+}
+
+VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout) {
+    FramePools& frame_pools = frames[current_frame];
+
+    while (true) {
+        // A pool that was created for this set and is still too small can
+        // never hold it
+        bool new_pool = frame_pools.current_pool == frame_pools.pools.size();
+        if (new_pool) {
+            uint32_t max_sets = INITIAL_SETS_PER_POOL;
+            for (size_t i = 0; i < frame_pools.pools.size(); i++) {
+                max_sets = std::min(max_sets * 2, MAX_SETS_PER_POOL);
+            }
+            frame_pools.pools.push_back(CreatePool(max_sets, 0));
+        }
+
+        VkResult result = VK_SUCCESS;
+        VkDescriptorSet descriptor_set = AllocateFromPool(
+            frame_pools.pools[frame_pools.current_pool], layout, result);
+        if (result == VK_SUCCESS) {
+            return descriptor_set;
+        }
+        if (new_pool) {
+            throw std::runtime_error("descriptor set exceeds a whole pool!");
+        }
+        frame_pools.current_pool++;
+    }
+}
+
+VkDescriptorSet DescriptorAllocator::GetCachedSet(
+    VkDescriptorSetLayout layout,
+    const std::vector<DescriptorBinding>& bindings) {
+    CacheKey key;
+    key.layout = layout;
+    key.bindings = bindings;
+
+    auto it = cached_sets.find(key);
+    if (it != cached_sets.end()) {
+        return it->second.set;
+    }
+
+    // Any pool with sets to spare may have room, including the space of
+    // freed sets. A fragmented pool is skipped.
+    CachedSet cached_set;
+    VkResult result = VK_ERROR_OUT_OF_POOL_MEMORY;
+    CachePool* cache_pool = nullptr;
+    for (CachePool& candidate : cache_pools) {
+        if (candidate.live_sets == MAX_SETS_PER_POOL) {
+            continue;
+        }
+        cached_set.set = AllocateFromPool(candidate.pool, layout, result);
+        if (result == VK_SUCCESS) {
+            cache_pool = &candidate;
+            break;
+        }
+    }
+    if (cache_pool == nullptr) {
+        CachePool new_pool;
+        new_pool.pool =
+            CreatePool(MAX_SETS_PER_POOL,
+                       VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+        cache_pools.push_back(new_pool);
+        cache_pool = &cache_pools.back();
+        cached_set.set = AllocateFromPool(cache_pool->pool, layout, result);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("descriptor set exceeds a whole pool!");
+        }
+    }
+    cached_set.pool = cache_pool->pool;
+    cache_pool->live_sets++;
+
+    std::vector<VkWriteDescriptorSet> writes(bindings.size());
+    for (size_t i = 0; i < bindings.size(); i++) {
+        VkWriteDescriptorSet& write = writes[i];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = cached_set.set;
+        write.dstBinding = bindings[i].binding;
+        write.dstArrayElement = 0;
+        write.descriptorType = bindings[i].type;
+        write.descriptorCount = 1;
+
+        bool is_buffer =
+            bindings[i].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+            bindings[i].type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        if (is_buffer) {
+            write.pBufferInfo = &bindings[i].buffer;
+        } else {
+            write.pImageInfo = &bindings[i].image;
+        }
+    }
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()),
+                           writes.data(), 0, nullptr);
+
+    cached_sets.emplace(std::move(key), cached_set);
+    return cached_set.set;
+}
+
+void DescriptorAllocator::ForgetImageView(VkImageView image_view) {
+    auto it = cached_sets.begin();
+    while (it != cached_sets.end()) {
+        bool uses_view = std::any_of(
+            it->first.bindings.begin(), it->first.bindings.end(),
+            [image_view](const DescriptorBinding& binding) {
+                return binding.image.imageView == image_view;
+            });
+        if (!uses_view) {
+            ++it;
+            continue;
+        }
+
+        vkFreeDescriptorSets(device, it->second.pool, 1, &it->second.set);
+        ReleaseCachedSet(it->second.pool);
+        it = cached_sets.erase(it);
+    }
+}
+
+void DescriptorAllocator::ReleaseCachedSet(VkDescriptorPool pool) {
+    auto it = std::find_if(cache_pools.begin(), cache_pools.end(),
+                           [pool](const CachePool& cache_pool) {
+                               return cache_pool.pool == pool;
+                           });
+    if (--it->live_sets > 0) {
+        return;
+    }
+
+    // One empty pool is kept for the next sets, reset so that it is no
+    // longer fragmented. Any other one is destroyed.
+    bool other_empty =
+        std::any_of(cache_pools.begin(), cache_pools.end(),
+                    [pool](const CachePool& cache_pool) {
+                        return cache_pool.pool != pool &&
+                               cache_pool.live_sets == 0;
+                    });
+    if (other_empty) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+        cache_pools.erase(it);
+    } else {
+        vkResetDescriptorPool(device, pool, 0);
+    }
+}
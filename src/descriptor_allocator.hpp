@@ -0,0 +1,104 @@
+#ifndef DESCRIPTOR_ALLOCATOR_H
+#define DESCRIPTOR_ALLOCATOR_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <cstddef>  // Required for size_t
+#include <cstdint>  // Required for uint32_t
+#include <unordered_map>
+#include <vector>
+
+// Contents of one binding of a cached descriptor set
+struct DescriptorBinding {
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    VkDescriptorImageInfo image{};
+    VkDescriptorBufferInfo buffer{};
+};
+
+/* Allocates descriptor sets from pools that grow with the demand, so no
+caller has to size a pool up front.
+
+Sets that are only used by the commands of one frame come from the pools of
+the frame slot. They are all reset at once with vkResetDescriptorPool when
+the frame slot is reused. When a pool runs out, the next one is taken, or
+created if the frame never needed that many before.
+
+Sets that outlive a frame are cached by their layout and the resources they
+point at. Asking for the same contents again returns the same set, which is
+written only once. A cached set is freed once a resource it points at is
+forgotten, which has to happen before the resource is destroyed. Freed sets
+are reused by later ones, and a pool whose sets are all freed is reset, so
+the pools only grow with the number of sets alive at once. */
+class DescriptorAllocator {
+   private:
+    // Pools of a frame slot. The pools before the current one are full.
+    struct FramePools {
+        std::vector<VkDescriptorPool> pools;
+        size_t current_pool = 0;
+    };
+
+    struct CacheKey {
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        std::vector<DescriptorBinding> bindings;
+
+        bool operator==(const CacheKey& other) const;
+    };
+
+    struct CacheKeyHash {
+        size_t operator()(const CacheKey& key) const;
+    };
+
+    struct CachedSet {
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+    };
+
+    // Pool of cached sets and the number of its sets that are not freed
+    struct CachePool {
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        uint32_t live_sets = 0;
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    std::vector<FramePools> frames;
+    uint32_t current_frame = 0;
+
+    // Cached sets can be freed one by one, so a pool is only reset once all
+    // of its sets are freed
+    std::vector<CachePool> cache_pools;
+    std::unordered_map<CacheKey, CachedSet, CacheKeyHash> cached_sets;
+
+    VkDescriptorPool CreatePool(uint32_t max_sets,
+                                VkDescriptorPoolCreateFlags flags);
+    VkDescriptorSet AllocateFromPool(VkDescriptorPool pool,
+                                     VkDescriptorSetLayout layout,
+                                     VkResult& result);
+
+    // Counts a freed set of the pool, and recycles the pool once it is empty
+    void ReleaseCachedSet(VkDescriptorPool pool);
+
+   public:
+    void Init(VkDevice device, uint32_t frames_in_flight);
+    void Destroy();
+
+    // Reset the sets allocated the last time the frame slot was used. Must be
+    // called after its fence has signaled.
+    void BeginFrame(uint32_t frame);
+
+    // Set that is valid until the current frame slot is used again
+    VkDescriptorSet Allocate(VkDescriptorSetLayout layout);
+
+    // Set with the given contents, written the first time it is asked for
+    VkDescriptorSet GetCachedSet(
+        VkDescriptorSetLayout layout,
+        const std::vector<DescriptorBinding>& bindings);
+
+    // Free the cached sets that point at the view. The GPU must no longer
+    // use them.
+    void ForgetImageView(VkImageView image_view);
+};
+
+#endif  // DESCRIPTOR_ALLOCATOR_H
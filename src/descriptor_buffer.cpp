@@ -0,0 +1,175 @@
+/* Local header files */
+#include "descriptor_buffer.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::max
+#include <stdexcept>
+
+namespace {
+
+// Usage of the buffer, which every binding of it repeats
+const VkBufferUsageFlags DESCRIPTOR_BUFFER_USAGE =
+    VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT |
+    VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+    VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR;
+
+}  // namespace
+
+void DescriptorBuffer::Init(VkPhysicalDevice physical_device, VkDevice device,
+                            VkDescriptorSetLayout set_layout,
+                            uint32_t set_count) {
+    this->device = device;
+    this->set_layout = set_layout;
+    this->set_count = set_count;
+
+    // Device level extension functions
+    get_layout_size = reinterpret_cast<PFN_vkGetDescriptorSetLayoutSizeEXT>(
+        vkGetDeviceProcAddr(device, "vkGetDescriptorSetLayoutSizeEXT"));
+    get_binding_offset =
+        reinterpret_cast<PFN_vkGetDescriptorSetLayoutBindingOffsetEXT>(
+            vkGetDeviceProcAddr(device,
+                                "vkGetDescriptorSetLayoutBindingOffsetEXT"));
+    get_descriptor = reinterpret_cast<PFN_vkGetDescriptorEXT>(
+        vkGetDeviceProcAddr(device, "vkGetDescriptorEXT"));
+    bind_buffers = reinterpret_cast<PFN_vkCmdBindDescriptorBuffersEXT>(
+        vkGetDeviceProcAddr(device, "vkCmdBindDescriptorBuffersEXT"));
+    set_offsets = reinterpret_cast<PFN_vkCmdSetDescriptorBufferOffsetsEXT>(
+        vkGetDeviceProcAddr(device, "vkCmdSetDescriptorBufferOffsetsEXT"));
+    get_buffer_address = reinterpret_cast<PFN_vkGetBufferDeviceAddressKHR>(
+        vkGetDeviceProcAddr(device, "vkGetBufferDeviceAddressKHR"));
+
+    // The size of a descriptor and the alignment of a set depend on the
+    // implementation
+    properties = {};
+    properties.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+
+    VkPhysicalDeviceProperties2 device_properties{};
+    device_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    device_properties.pNext = &properties;
+    vkGetPhysicalDeviceProperties2(physical_device, &device_properties);
+
+    VkDeviceSize layout_size = 0;
+    get_layout_size(device, set_layout, &layout_size);
+
+    VkDeviceSize alignment =
+        std::max<VkDeviceSize>(properties.descriptorBufferOffsetAlignment, 1);
+    set_stride = (layout_size + alignment - 1) / alignment * alignment;
+
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = std::max<VkDeviceSize>(set_stride * set_count, 1);
+    buffer_info.usage = DESCRIPTOR_BUFFER_USAGE;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &buffer_info, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor buffer!");
+    }
+
+    VkMemoryRequirements mem_requirements{};
+    vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
+
+    // The address of the buffer is what the command buffer binds
+    VkMemoryAllocateFlagsInfo flags_info{};
+    flags_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+    flags_info.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.pNext = &flags_info;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex =
+        FindMemoryType(physical_device, mem_requirements.memoryTypeBits);
+
+    if (vkAllocateMemory(device, &alloc_info, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to allocate descriptor buffer memory!");
+    }
+
+    vkBindBufferMemory(device, buffer, memory, 0);
+
+    void* mapped = nullptr;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    data = static_cast<uint8_t*>(mapped);
+
+    VkBufferDeviceAddressInfoKHR address_info{};
+    address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR;
+    address_info.buffer = buffer;
+    address = get_buffer_address(device, &address_info);
+}
+
+void DescriptorBuffer::Destroy() {
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkUnmapMemory(device, memory);
+    vkDestroyBuffer(device, buffer, nullptr);
+    vkFreeMemory(device, memory, nullptr);
+
+    buffer = VK_NULL_HANDLE;
+    memory = VK_NULL_HANDLE;
+    address = 0;
+    data = nullptr;
+}
+
+bool DescriptorBuffer::IsEnabled() const { return buffer != VK_NULL_HANDLE; }
+
+uint32_t DescriptorBuffer::FindMemoryType(VkPhysicalDevice physical_device,
+                                          uint32_t type_filter) {
+    VkPhysicalDeviceMemoryProperties mem_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
+
+    // The GPU reads every descriptor of a draw, so memory that is both
+    // device local and mappable comes first
+    const VkMemoryPropertyFlags host_visible =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    for (VkMemoryPropertyFlags properties :
+         {host_visible | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, host_visible}) {
+        for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++) {
+            if ((type_filter & (1U << i)) &&
+                (mem_properties.memoryTypes[i].propertyFlags & properties) ==
+                    properties) {
+                return i;
+            }
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+void DescriptorBuffer::WriteCombinedImageSampler(
+    uint32_t set, uint32_t binding, const VkDescriptorImageInfo& image_info) {
+    if (set >= set_count) {
+        throw std::out_of_range("descriptor buffer set out of range!");
+    }
+
+    VkDeviceSize binding_offset = 0;
+    get_binding_offset(device, set_layout, binding, &binding_offset);
+
+    VkDescriptorGetInfoEXT descriptor_info{};
+    descriptor_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+    descriptor_info.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptor_info.data.pCombinedImageSampler = &image_info;
+
+    get_descriptor(device, &descriptor_info,
+                   properties.combinedImageSamplerDescriptorSize,
+                   data + set * set_stride + binding_offset);
+}
+
+void DescriptorBuffer::Bind(VkCommandBuffer command_buffer,
+                            VkPipelineBindPoint bind_point,
+                            VkPipelineLayout pipeline_layout,
+                            uint32_t set_index, uint32_t set) const {
+    VkDescriptorBufferBindingInfoEXT binding_info{};
+    binding_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT;
+    binding_info.address = address;
+    binding_info.usage = DESCRIPTOR_BUFFER_USAGE;
+    bind_buffers(command_buffer, 1, &binding_info);
+
+    const uint32_t buffer_index = 0;
+    const VkDeviceSize offset = set * set_stride;
+    set_offsets(command_buffer, bind_point, pipeline_layout, set_index, 1,
+                &buffer_index, &offset);
+}
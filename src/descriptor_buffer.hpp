@@ -0,0 +1,63 @@
+#ifndef DESCRIPTOR_BUFFER_H
+#define DESCRIPTOR_BUFFER_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+
+/* Sets of one descriptor set layout, written straight into mapped memory
+with VK_EXT_descriptor_buffer. There are no pools to size and no
+VkDescriptorSet objects to allocate and update. Writing a descriptor is a
+copy of a few bytes into the slot of its set, and binding a set sets an
+offset into the buffer.
+
+The set layout has to be created with
+VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT, and the pipelines
+that use it with VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT. Like a
+descriptor set, a slot must not be rewritten while the GPU may still read
+it. */
+class DescriptorBuffer {
+   private:
+    VkDevice device = VK_NULL_HANDLE;
+    PFN_vkGetDescriptorSetLayoutSizeEXT get_layout_size = nullptr;
+    PFN_vkGetDescriptorSetLayoutBindingOffsetEXT get_binding_offset = nullptr;
+    PFN_vkGetDescriptorEXT get_descriptor = nullptr;
+    PFN_vkCmdBindDescriptorBuffersEXT bind_buffers = nullptr;
+    PFN_vkCmdSetDescriptorBufferOffsetsEXT set_offsets = nullptr;
+    PFN_vkGetBufferDeviceAddressKHR get_buffer_address = nullptr;
+
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT properties{};
+    VkDescriptorSetLayout set_layout = VK_NULL_HANDLE;
+    uint32_t set_count = 0;
+
+    // Size of a set, rounded up to the alignment of the set offsets
+    VkDeviceSize set_stride = 0;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceAddress address = 0;
+    uint8_t* data = nullptr;
+
+    uint32_t FindMemoryType(VkPhysicalDevice physical_device,
+                            uint32_t type_filter);
+
+   public:
+    // Only called if VK_EXT_descriptor_buffer was enabled on the device
+    void Init(VkPhysicalDevice physical_device, VkDevice device,
+              VkDescriptorSetLayout set_layout, uint32_t set_count);
+    void Destroy();
+    bool IsEnabled() const;
+
+    void WriteCombinedImageSampler(uint32_t set, uint32_t binding,
+                                   const VkDescriptorImageInfo& image_info);
+
+    // Binds the buffer and points the set index of the pipeline layout at
+    // the given set
+    void Bind(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point,
+              VkPipelineLayout pipeline_layout, uint32_t set_index,
+              uint32_t set) const;
+};
+
+#endif  // DESCRIPTOR_BUFFER_H
@@ -0,0 +1,55 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+void TriangleApplication::HandleDeviceLost(const std::string& call) {
+    ReportDeviceLost(call);
+
+    if (!options.recover_device_lost) {
+        throw std::runtime_error("device lost in " + call + "!");
+    }
+    if (device_recoveries >= MAX_DEVICE_RECOVERIES) {
+        throw std::runtime_error("device lost in " + call +
+                                 " after too many recoveries!");
+    }
+
+    device_recoveries++;
+    std::cerr << "recreating the device, recovery " << device_recoveries
+              << " of " << MAX_DEVICE_RECOVERIES << std::endl;
+    RecoverDevice();
+}
+
+void TriangleApplication::FailDeviceLost(const std::string& call) {
+    ReportDeviceLost(call);
+    throw std::runtime_error("device lost in " + call + "!");
+}
+
+void TriangleApplication::ReportDeviceLost(const std::string& call) {
+    // The breadcrumbs are host memory, which outlives the device
+    std::cerr << "device lost in " << call << ", progress of the frames:\n"
+              << breadcrumbs.Describe();
+    metrics.CountDeviceLost();
+}
+
+void TriangleApplication::RecoverDevice() {
+    /* Nothing created from a lost device can be used anymore, so all of it is
+    destroyed and created again on a new device. The instance, the surfaces
+    and the windows are kept. Waits on a lost device return right away, and
+    objects of a lost device can still be destroyed. */
+    vkDeviceWaitIdle(device);
+
+    for (SecondaryWindow& secondary : secondary_windows) {
+        DestroySecondaryDeviceObjects(secondary);
+    }
+    DestroyDeviceResources();
+
+    CreateDeviceResources();
+    for (SecondaryWindow& secondary : secondary_windows) {
+        CreateSecondaryDeviceObjects(secondary);
+    }
+
+    // The frame slots start over, and no frame of the old swap chain is
+    // waited for
+    frame_pacer.SetDevice(device, present_wait_supported);
+    frame_pacer.Reset();
+    current_frame = 0;
+}
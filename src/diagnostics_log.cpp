@@ -0,0 +1,190 @@
+/* Local header files */
+#include "diagnostics_log.hpp"
+
+/* Standard libraries */
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>  // Required for OutputDebugStringA
+#endif
+
+namespace {
+
+// The logger wakes up at this interval to write the queued messages
+const std::chrono::milliseconds FLUSH_INTERVAL(100);
+
+// Copies as much of the string as fits, always terminated
+template <size_t Size>
+void CopyString(const char* source, std::array<char, Size>& destination) {
+    if (source == nullptr) {
+        destination[0] = '\0';
+        return;
+    }
+    const void* end = std::memchr(source, '\0', Size - 1);
+    size_t length = end != nullptr ? static_cast<const char*>(end) - source
+                                   : Size - 1;
+    std::memcpy(destination.data(), source, length);
+    destination[length] = '\0';
+}
+
+const char* GetSeverityName(VkDebugUtilsMessageSeverityFlagBitsEXT severity) {
+    if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+        return "ERROR";
+    }
+    if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+        return "WARNING";
+    }
+    if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
+        return "info";
+    }
+    return "verbose";
+}
+
+void WriteLine(const std::string& line) {
+    std::cerr << line << std::endl;
+#ifdef _WIN32
+    // Also shown in the output window of the Visual Studio debugger
+    OutputDebugStringA((line + "\n").c_str());
+#endif
+}
+
+}  // namespace
+
+DiagnosticsLog::~DiagnosticsLog() {
+    Stop();
+}
+
+void DiagnosticsLog::Start() {
+    stopping = false;
+    logger = std::thread(&DiagnosticsLog::LoggerLoop, this);
+}
+
+void DiagnosticsLog::Stop() {
+    if (!logger.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stop_requested.notify_one();
+    logger.join();
+}
+
+void DiagnosticsLog::Report(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+                            const VkDebugUtilsMessengerCallbackDataEXT& data) {
+    if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+        error_count.fetch_add(1, std::memory_order_relaxed);
+    } else if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+        warning_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Repeats of a message only add to its count
+    if (data.messageIdNumber != 0 && !CountMessage(data.messageIdNumber)) {
+        return;
+    }
+
+    Message message;
+    message.severity = severity;
+    message.id = data.messageIdNumber;
+    CopyString(data.pMessageIdName, message.id_name);
+    CopyString(data.pMessage, message.text);
+
+    if (!messages->Push(message)) {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint32_t DiagnosticsLog::GetErrorCount() const {
+    return error_count.load(std::memory_order_relaxed);
+}
+
+bool DiagnosticsLog::CountMessage(int32_t id) {
+    // Multiplicative hash, ids of the validation layers are hashes already
+    // but the low bits of other ids may repeat
+    size_t start = (static_cast<uint32_t>(id) * 2654435761U) %
+                   DIAGNOSTICS_MAX_MESSAGE_IDS;
+
+    for (size_t i = 0; i < DIAGNOSTICS_MAX_MESSAGE_IDS; i++) {
+        SeenId& slot = seen_ids[(start + i) % DIAGNOSTICS_MAX_MESSAGE_IDS];
+
+        // Claim an empty slot. If another thread was faster, the id it
+        // stored is compared instead.
+        int32_t slot_id = slot.id.load(std::memory_order_acquire);
+        if (slot_id == 0 &&
+            slot.id.compare_exchange_strong(slot_id, id,
+                                            std::memory_order_acq_rel)) {
+            slot_id = id;
+        }
+
+        // Whichever thread counts first queues the message
+        if (slot_id == id) {
+            return slot.count.fetch_add(1, std::memory_order_relaxed) == 0;
+        }
+    }
+
+    // The table is full, so the message is not deduplicated
+    return true;
+}
+
+void DiagnosticsLog::LoggerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        lock.unlock();
+        WriteQueuedMessages();
+        lock.lock();
+
+        stop_requested.wait_for(lock, FLUSH_INTERVAL,
+                                [this] { return stopping; });
+    }
+    lock.unlock();
+
+    // Nothing calls Report any more once the log is stopped
+    WriteQueuedMessages();
+    WriteSummary();
+}
+
+void DiagnosticsLog::WriteQueuedMessages() {
+    Message message;
+    while (messages->Pop(message)) {
+        if (message.id != 0) {
+            id_names.emplace(message.id, message.id_name.data());
+        }
+
+        WriteLine(std::string("validation layer ") +
+                  GetSeverityName(message.severity) + ": " +
+                  message.text.data());
+    }
+}
+
+void DiagnosticsLog::WriteSummary() {
+    uint32_t warnings = warning_count.load(std::memory_order_relaxed);
+    uint32_t errors = error_count.load(std::memory_order_relaxed);
+    uint64_t dropped = dropped_count.load(std::memory_order_relaxed);
+    if (warnings == 0 && errors == 0 && dropped == 0) {
+        return;
+    }
+
+    WriteLine("validation summary: " + std::to_string(errors) + " errors, " +
+              std::to_string(warnings) + " warnings, " +
+              std::to_string(dropped) + " messages dropped");
+
+    for (const SeenId& slot : seen_ids) {
+        int32_t id = slot.id.load(std::memory_order_relaxed);
+        uint32_t count = slot.count.load(std::memory_order_relaxed);
+        if (id == 0 || count < 2) {
+            continue;
+        }
+
+        auto name = id_names.find(id);
+        WriteLine("    " +
+                  (name != id_names.end() && !name->second.empty()
+                       ? name->second
+                       : std::to_string(id)) +
+                  ": " + std::to_string(count) + " times");
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef DIAGNOSTICS_LOG_H
+#define DIAGNOSTICS_LOG_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "mpsc_queue.hpp"
+
+/* Standard libraries */
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>  // Required for size_t
+#include <cstdint>  // Required for int32_t
+#include <map>
+#include <memory>  // Required for std::unique_ptr
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Longer messages are cut off at this many characters
+const size_t DIAGNOSTIC_MESSAGE_SIZE = 2048;
+
+// Messages waiting for the logger. Messages arriving while it is full are
+// counted as dropped.
+const size_t DIAGNOSTICS_QUEUE_SIZE = 256;
+
+// Distinct message ids that are deduplicated. Ids beyond are logged every
+// time they occur.
+const size_t DIAGNOSTICS_MAX_MESSAGE_IDS = 512;
+
+/* Collects the messages of the validation layers without slowing down the
+threads that trigger them. The debug messenger may call from any thread
+that uses Vulkan, in the middle of recording or submitting a frame, so the
+callback only copies the message into a lock-free queue and a background
+thread writes it to the console.
+
+Messages are identified by their message id. Only the first message of an
+id is queued, later ones just increment a counter, and the counts are
+reported when the log stops. */
+class DiagnosticsLog {
+   private:
+    struct Message {
+        VkDebugUtilsMessageSeverityFlagBitsEXT severity =
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT;
+        int32_t id = 0;
+        std::array<char, 128> id_name{};
+        std::array<char, DIAGNOSTIC_MESSAGE_SIZE> text{};
+    };
+
+    // Open addressing table of the message ids seen so far. An id of 0 marks
+    // an empty slot, messages without an id are never deduplicated.
+    struct SeenId {
+        std::atomic<int32_t> id{0};
+        std::atomic<uint32_t> count{0};
+    };
+
+    // About half a megabyte, allocated on the heap, since the application
+    // that owns the log lives on the stack of main
+    std::unique_ptr<MpscQueue<Message, DIAGNOSTICS_QUEUE_SIZE>> messages =
+        std::make_unique<MpscQueue<Message, DIAGNOSTICS_QUEUE_SIZE>>();
+    std::array<SeenId, DIAGNOSTICS_MAX_MESSAGE_IDS> seen_ids;
+    std::atomic<uint64_t> dropped_count{0};
+    std::atomic<uint32_t> warning_count{0};
+    std::atomic<uint32_t> error_count{0};
+
+    std::thread logger;
+    std::mutex mutex;
+    std::condition_variable stop_requested;
+    bool stopping = false;
+
+    // Only touched by the logger, names of the ids for the summary
+    std::map<int32_t, std::string> id_names;
+
+    // Finds or inserts the id and counts the message. True for the first
+    // message of the id.
+    bool CountMessage(int32_t id);
+
+    void LoggerLoop();
+    void WriteQueuedMessages();
+    void WriteSummary();
+
+   public:
+    DiagnosticsLog() = default;
+    DiagnosticsLog(const DiagnosticsLog&) = delete;
+    DiagnosticsLog& operator=(const DiagnosticsLog&) = delete;
+    ~DiagnosticsLog();
+
+    void Start();
+
+    // Writes the queued messages and the repeat counts before the logger is
+    // joined
+    void Stop();
+
+    // Called by the debug messenger on any thread. Never blocks.
+    void Report(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+                const VkDebugUtilsMessengerCallbackDataEXT& data);
+
+    uint32_t GetErrorCount() const;
+};
+
+#endif  // DIAGNOSTICS_LOG_H
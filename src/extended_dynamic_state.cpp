@@ -0,0 +1,132 @@
+/* Local header files */
+#include "extended_dynamic_state.hpp"
+
+VkPipelineColorBlendAttachmentState BlendAttachmentState(
+    const RasterState& state) {
+    VkPipelineColorBlendAttachmentState attachment{};
+    attachment.colorWriteMask =
+        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+        VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    attachment.blendEnable = state.alpha_blend ? VK_TRUE : VK_FALSE;
+    attachment.srcColorBlendFactor =
+        state.alpha_blend ? VK_BLEND_FACTOR_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+    attachment.dstColorBlendFactor = state.alpha_blend
+                                         ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA
+                                         : VK_BLEND_FACTOR_ZERO;
+    attachment.colorBlendOp = VK_BLEND_OP_ADD;
+    attachment.srcAlphaBlendFactor =
+        state.alpha_blend ? VK_BLEND_FACTOR_ZERO : VK_BLEND_FACTOR_ONE;
+    attachment.dstAlphaBlendFactor =
+        state.alpha_blend ? VK_BLEND_FACTOR_ONE : VK_BLEND_FACTOR_ZERO;
+    attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    return attachment;
+}
+
+void ExtendedDynamicState::Init(VkDevice device, uint32_t level) {
+    *this = {};
+
+    // Device level extension functions
+    if (level >= 1) {
+        set_cull_mode = reinterpret_cast<PFN_vkCmdSetCullModeEXT>(
+            vkGetDeviceProcAddr(device, "vkCmdSetCullModeEXT"));
+        set_front_face = reinterpret_cast<PFN_vkCmdSetFrontFaceEXT>(
+            vkGetDeviceProcAddr(device, "vkCmdSetFrontFaceEXT"));
+        set_primitive_topology =
+            reinterpret_cast<PFN_vkCmdSetPrimitiveTopologyEXT>(
+                vkGetDeviceProcAddr(device, "vkCmdSetPrimitiveTopologyEXT"));
+        set_depth_test_enable =
+            reinterpret_cast<PFN_vkCmdSetDepthTestEnableEXT>(
+                vkGetDeviceProcAddr(device, "vkCmdSetDepthTestEnableEXT"));
+        set_depth_write_enable =
+            reinterpret_cast<PFN_vkCmdSetDepthWriteEnableEXT>(
+                vkGetDeviceProcAddr(device, "vkCmdSetDepthWriteEnableEXT"));
+        if (set_cull_mode == nullptr || set_front_face == nullptr ||
+            set_primitive_topology == nullptr ||
+            set_depth_test_enable == nullptr ||
+            set_depth_write_enable == nullptr) {
+            return;
+        }
+        this->level = 1;
+    }
+
+    if (level >= 2) {
+        set_primitive_restart_enable =
+            reinterpret_cast<PFN_vkCmdSetPrimitiveRestartEnableEXT>(
+                vkGetDeviceProcAddr(device,
+                                    "vkCmdSetPrimitiveRestartEnableEXT"));
+        if (set_primitive_restart_enable == nullptr) {
+            return;
+        }
+        this->level = 2;
+    }
+
+    if (level >= 3) {
+        set_color_blend_enable =
+            reinterpret_cast<PFN_vkCmdSetColorBlendEnableEXT>(
+                vkGetDeviceProcAddr(device, "vkCmdSetColorBlendEnableEXT"));
+        set_color_blend_equation =
+            reinterpret_cast<PFN_vkCmdSetColorBlendEquationEXT>(
+                vkGetDeviceProcAddr(device, "vkCmdSetColorBlendEquationEXT"));
+        set_color_write_mask = reinterpret_cast<PFN_vkCmdSetColorWriteMaskEXT>(
+            vkGetDeviceProcAddr(device, "vkCmdSetColorWriteMaskEXT"));
+        if (set_color_blend_enable == nullptr ||
+            set_color_blend_equation == nullptr ||
+            set_color_write_mask == nullptr) {
+            return;
+        }
+        this->level = 3;
+    }
+}
+
+uint32_t ExtendedDynamicState::GetLevel() const { return level; }
+
+std::vector<VkDynamicState> ExtendedDynamicState::GetDynamicStates() const {
+    std::vector<VkDynamicState> states;
+    if (level >= 1) {
+        states.insert(states.end(), {VK_DYNAMIC_STATE_CULL_MODE_EXT,
+                                     VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+                                     VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT,
+                                     VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+                                     VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT});
+    }
+    if (level >= 2) {
+        states.push_back(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT);
+    }
+    if (level >= 3) {
+        states.insert(states.end(), {VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT,
+                                     VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT,
+                                     VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT});
+    }
+    return states;
+}
+
+void ExtendedDynamicState::CmdSetState(VkCommandBuffer command_buffer,
+                                       const RasterState& state) const {
+    if (level >= 1) {
+        VkBool32 depth_test = state.depth_test ? VK_TRUE : VK_FALSE;
+        set_cull_mode(command_buffer, state.cull_mode);
+        set_front_face(command_buffer, state.front_face);
+        set_primitive_topology(command_buffer, state.topology);
+        set_depth_test_enable(command_buffer, depth_test);
+        set_depth_write_enable(command_buffer, depth_test);
+    }
+    if (level >= 2) {
+        set_primitive_restart_enable(command_buffer, VK_FALSE);
+    }
+    if (level >= 3) {
+        VkPipelineColorBlendAttachmentState attachment =
+            BlendAttachmentState(state);
+
+        VkColorBlendEquationEXT equation{};
+        equation.srcColorBlendFactor = attachment.srcColorBlendFactor;
+        equation.dstColorBlendFactor = attachment.dstColorBlendFactor;
+        equation.colorBlendOp = attachment.colorBlendOp;
+        equation.srcAlphaBlendFactor = attachment.srcAlphaBlendFactor;
+        equation.dstAlphaBlendFactor = attachment.dstAlphaBlendFactor;
+        equation.alphaBlendOp = attachment.alphaBlendOp;
+
+        set_color_blend_enable(command_buffer, 0, 1, &attachment.blendEnable);
+        set_color_blend_equation(command_buffer, 0, 1, &equation);
+        set_color_write_mask(command_buffer, 0, 1, &attachment.colorWriteMask);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef EXTENDED_DYNAMIC_STATE_H
+#define EXTENDED_DYNAMIC_STATE_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <vector>
+
+// Fixed function state that the draws of the application differ in
+struct RasterState {
+    VkCullModeFlags cull_mode = VK_CULL_MODE_NONE;
+    VkFrontFace front_face = VK_FRONT_FACE_CLOCKWISE;
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    // Only has an effect in render passes with a depth attachment
+    bool depth_test = false;
+
+    // Blends by the alpha of the fragment and keeps the alpha of the target
+    bool alpha_blend = false;
+};
+
+// Blend state of the color attachment for the raster state
+VkPipelineColorBlendAttachmentState BlendAttachmentState(
+    const RasterState& state);
+
+/* Device level functions of VK_EXT_extended_dynamic_state, 2 and 3. With
+them, the raster state is recorded into the command buffer instead of baked
+into the pipeline, so draws that only differ in it share one pipeline.
+
+The level is the number of the extensions that are enabled, in order:
+- 1: cull mode, front face, topology and depth test
+- 2: primitive restart as well
+- 3: color blend enable, equation and write mask as well
+
+Below a level, the pipelines are created with the raster state of their
+draws, and setting it in the command buffer does nothing. */
+class ExtendedDynamicState {
+   private:
+    uint32_t level = 0;
+
+    PFN_vkCmdSetCullModeEXT set_cull_mode = nullptr;
+    PFN_vkCmdSetFrontFaceEXT set_front_face = nullptr;
+    PFN_vkCmdSetPrimitiveTopologyEXT set_primitive_topology = nullptr;
+    PFN_vkCmdSetDepthTestEnableEXT set_depth_test_enable = nullptr;
+    PFN_vkCmdSetDepthWriteEnableEXT set_depth_write_enable = nullptr;
+    PFN_vkCmdSetPrimitiveRestartEnableEXT set_primitive_restart_enable =
+        nullptr;
+    PFN_vkCmdSetColorBlendEnableEXT set_color_blend_enable = nullptr;
+    PFN_vkCmdSetColorBlendEquationEXT set_color_blend_equation = nullptr;
+    PFN_vkCmdSetColorWriteMaskEXT set_color_write_mask = nullptr;
+
+   public:
+    // The level is the number of the extensions enabled on the device
+    void Init(VkDevice device, uint32_t level);
+    uint32_t GetLevel() const;
+
+    // States to add to the dynamic states of every pipeline
+    std::vector<VkDynamicState> GetDynamicStates() const;
+
+    // Must be recorded after binding a pipeline and before drawing with it
+    void CmdSetState(VkCommandBuffer command_buffer,
+                     const RasterState& state) const;
+};
+
+#endif  // EXTENDED_DYNAMIC_STATE_H
@@ -0,0 +1,203 @@
+/* Local header files */
+#include "frame_pacer.hpp"
+
+/* Standard libraries */
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+const double DEFAULT_REFRESH_RATE = 60.0;
+
+// Frames start this much earlier than predicted, which absorbs jitter of the
+// frame time and of the sleep
+const double PACING_MARGIN = 2.0;
+
+// Weight of a new sample in the smoothed times
+const double SMOOTHING = 0.1;
+
+// Without present timing, blanks are extrapolated at most this many refresh
+// intervals ahead of the last estimate, after a longer pause the estimate
+// starts over
+const double MAX_BLANK_EXTRAPOLATION = 60.0;
+
+// Presents of a swap chain that was replaced never complete, so the wait is
+// bounded. In nanoseconds.
+const uint64_t PRESENT_WAIT_TIMEOUT = 100000000;
+
+double ToMilliseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+std::chrono::steady_clock::duration FromMilliseconds(double milliseconds) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(milliseconds));
+}
+
+}  // namespace
+
+void FramePacer::Init(VkDevice device, bool present_wait_enabled,
+                      double refresh_rate, const std::string& log_path) {
+    SetDevice(device, present_wait_enabled);
+
+    refresh_interval =
+        1000.0 / (refresh_rate > 0.0 ? refresh_rate : DEFAULT_REFRESH_RATE);
+
+    if (!log_path.empty()) {
+        log.open(log_path);
+        if (!log.is_open()) {
+            throw std::runtime_error("failed to open latency log: " +
+                                     log_path + "!");
+        }
+        log << "frame,input_to_present_ms,measured\n";
+    }
+
+    frame_start = std::chrono::steady_clock::now();
+}
+
+void FramePacer::SetDevice(VkDevice device, bool present_wait_enabled) {
+    this->device = device;
+
+    // Device level extension function
+    wait_for_present = nullptr;
+    if (present_wait_enabled) {
+        wait_for_present = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+            vkGetDeviceProcAddr(device, "vkWaitForPresentKHR"));
+    }
+}
+
+bool FramePacer::IsUsingPresentWait() const {
+    return wait_for_present != nullptr;
+}
+
+void FramePacer::Reset() {
+    frame_pending = false;
+    has_last_present = false;
+    has_last_shown = false;
+    has_estimated_blank = false;
+}
+
+void FramePacer::WaitForFrameStart(VkSwapchainKHR swap_chain,
+                                   VkFence previous_fence,
+                                   double gpu_frame_time) {
+    // Start right away unless the previous frame tells otherwise
+    auto next_start = std::chrono::steady_clock::now();
+
+    if (frame_pending) {
+        frame_pending = false;
+
+        bool measured = false;
+        if (IsUsingPresentWait()) {
+            measured = wait_for_present(device, swap_chain, pending_present_id,
+                                        PRESENT_WAIT_TIMEOUT) == VK_SUCCESS;
+        } else {
+            vkWaitForFences(device, 1, &previous_fence, VK_TRUE, UINT64_MAX);
+        }
+
+        auto presented = std::chrono::steady_clock::now();
+        RecordLatency(presented, measured);
+        CountDroppedFrames(presented);
+
+        if (measured) {
+            // Consecutive frames are shown one or more vertical blanks apart,
+            // which refines the refresh interval
+            if (has_last_present) {
+                double interval = ToMilliseconds(presented - last_present);
+                double blanks = std::round(interval / refresh_interval);
+                if (blanks >= 1.0) {
+                    refresh_interval +=
+                        SMOOTHING * (interval / blanks - refresh_interval);
+                }
+            }
+            has_last_present = true;
+            last_present = presented;
+            estimated_blank = presented;
+        } else {
+            // The previous frame is taken to be shown at the first blank
+            // after its fence signaled. The blanks are extrapolated from the
+            // refresh interval, which keeps the frames one interval apart.
+            auto max_extrapolation =
+                FromMilliseconds(refresh_interval * MAX_BLANK_EXTRAPOLATION);
+            if (!has_estimated_blank ||
+                presented - estimated_blank > max_extrapolation) {
+                estimated_blank = presented;
+            }
+            while (estimated_blank < presented) {
+                estimated_blank += FromMilliseconds(refresh_interval);
+            }
+        }
+        has_estimated_blank = true;
+
+        // Leave just enough time to finish before the next blank
+        double delay = refresh_interval - cpu_frame_time - gpu_frame_time -
+                       PACING_MARGIN;
+        if (delay > 0.0) {
+            next_start = estimated_blank + FromMilliseconds(delay);
+        }
+    }
+
+    std::this_thread::sleep_until(next_start);
+    frame_start = std::chrono::steady_clock::now();
+}
+
+uint64_t FramePacer::GetDroppedFrames() const {
+    return dropped_frames;
+}
+
+uint64_t FramePacer::GetNextPresentId() const {
+    return next_present_id;
+}
+
+void FramePacer::FramePresented(
+    std::chrono::steady_clock::time_point input_time) {
+    auto now = std::chrono::steady_clock::now();
+    cpu_frame_time +=
+        SMOOTHING * (ToMilliseconds(now - frame_start) - cpu_frame_time);
+
+    frame_pending = true;
+    pending_present_id = next_present_id++;
+    pending_input_time = input_time;
+}
+
+void FramePacer::CountDroppedFrames(
+    std::chrono::steady_clock::time_point shown) {
+    // Every vertical blank beyond the first between two frames showed the
+    // previous frame again
+    if (has_last_shown) {
+        double blanks =
+            std::round(ToMilliseconds(shown - last_shown) / refresh_interval);
+        if (blanks > 1.0) {
+            dropped_frames += static_cast<uint64_t>(blanks) - 1;
+        }
+    }
+    has_last_shown = true;
+    last_shown = shown;
+}
+
+void FramePacer::RecordLatency(std::chrono::steady_clock::time_point presented,
+                               bool measured) {
+    last_latency.frame = pending_present_id;
+    last_latency.milliseconds = ToMilliseconds(presented - pending_input_time);
+    last_latency.measured = measured;
+
+    if (average_latency == 0.0) {
+        average_latency = last_latency.milliseconds;
+    } else {
+        average_latency +=
+            SMOOTHING * (last_latency.milliseconds - average_latency);
+    }
+
+    if (log.is_open()) {
+        log << last_latency.frame << "," << last_latency.milliseconds << ","
+            << (measured ? 1 : 0) << "\n";
+    }
+}
+
+const FrameLatency& FramePacer::GetLastLatency() const {
+    return last_latency;
+}
+
+double FramePacer::GetAverageLatency() const {
+    return average_latency;
+}
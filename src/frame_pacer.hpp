@@ -0,0 +1,107 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <chrono>
+#include <cstdint>  // Required for uint64_t
+#include <fstream>
+#include <string>
+
+// Time from the oldest input handled by a frame until the frame was shown
+struct FrameLatency {
+    uint64_t frame = 0;
+    double milliseconds = 0.0;
+
+    // False if the time the frame was shown is estimated from its fence
+    bool measured = false;
+};
+
+/* Decides when the CPU work of the next frame starts. The later a frame
+starts, the more recent the input it sees, as long as it still finishes
+before the display picks up the next image.
+
+With VK_KHR_present_wait, the pacer waits until the previous frame is on
+screen, which marks a vertical blank, and then sleeps until only the
+predicted CPU and GPU time of the frame is left before the next one. Without
+it, the pacer waits for the fence of the previous frame, so no more than one
+frame is queued, and the vertical blanks are estimated from the refresh rate
+of the display instead. The frame then starts just as early before the next
+estimated blank. */
+class FramePacer {
+   private:
+    VkDevice device = VK_NULL_HANDLE;
+    PFN_vkWaitForPresentKHR wait_for_present = nullptr;
+
+    // Smoothed time between two vertical blanks and smoothed CPU time of a
+    // frame, in milliseconds
+    double refresh_interval = 0.0;
+    double cpu_frame_time = 0.0;
+
+    uint64_t next_present_id = 1;
+    std::chrono::steady_clock::time_point frame_start;
+
+    // Frame that was presented last, but is not known to be on screen yet
+    bool frame_pending = false;
+    uint64_t pending_present_id = 0;
+    std::chrono::steady_clock::time_point pending_input_time;
+
+    // Time the last measured frame was shown
+    bool has_last_present = false;
+    std::chrono::steady_clock::time_point last_present;
+
+    // Vertical blank that showed the previous frame, measured or estimated
+    bool has_estimated_blank = false;
+    std::chrono::steady_clock::time_point estimated_blank;
+
+    // Time the last frame was shown, or estimated from its fence, for the
+    // count of dropped frames
+    bool has_last_shown = false;
+    std::chrono::steady_clock::time_point last_shown;
+    uint64_t dropped_frames = 0;
+
+    FrameLatency last_latency;
+    double average_latency = 0.0;
+
+    // One line per frame, if a log was requested
+    std::ofstream log;
+
+    void CountDroppedFrames(std::chrono::steady_clock::time_point shown);
+    void RecordLatency(std::chrono::steady_clock::time_point presented,
+                       bool measured);
+
+   public:
+    // Without a refresh rate of the display, 60 Hz is assumed until present
+    // timing tells otherwise
+    void Init(VkDevice device, bool present_wait_enabled, double refresh_rate,
+              const std::string& log_path);
+
+    // Takes over a device that replaced a lost one, keeping the timings
+    void SetDevice(VkDevice device, bool present_wait_enabled);
+    bool IsUsingPresentWait() const;
+
+    // Forgets the pending frame, after its swap chain has been replaced
+    void Reset();
+
+    // Blocks until the work of the next frame should start. The GPU time of
+    // a frame is taken from the profiler, 0 if it is unknown.
+    void WaitForFrameStart(VkSwapchainKHR swap_chain, VkFence previous_fence,
+                           double gpu_frame_time);
+
+    // Refreshes of the display that showed a frame again because the next
+    // one was late, since the start
+    uint64_t GetDroppedFrames() const;
+
+    // Id to chain to the next vkQueuePresentKHR with VkPresentIdKHR
+    uint64_t GetNextPresentId() const;
+
+    // Called after the frame was queued for presentation
+    void FramePresented(std::chrono::steady_clock::time_point input_time);
+
+    const FrameLatency& GetLastLatency() const;
+    double GetAverageLatency() const;
+};
+
+#endif  // FRAME_PACER_H
@@ -0,0 +1,260 @@
+/* Local header files */
+#include "frame_readback.hpp"
+
+/* Standard libraries */
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <utility>  // Required for std::move
+
+void ReadbackBuffer::Allocate(VkPhysicalDevice physical_device,
+                              VkDevice device, VkDeviceSize size,
+                              VkBufferUsageFlags usage) {
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = usage;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &buffer_info, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create readback buffer!");
+    }
+
+    VkMemoryRequirements mem_requirements{};
+    vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
+
+    VkPhysicalDeviceMemoryProperties mem_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
+
+    // Reading uncached memory from the CPU is slow, so cached memory is
+    // preferred over coherent memory
+    const std::array<VkMemoryPropertyFlags, 2> candidates = {
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+
+    uint32_t memory_type = UINT32_MAX;
+    for (VkMemoryPropertyFlags properties : candidates) {
+        for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++) {
+            if ((mem_requirements.memoryTypeBits & (1U << i)) &&
+                (mem_properties.memoryTypes[i].propertyFlags & properties) ==
+                    properties) {
+                memory_type = i;
+                break;
+            }
+        }
+
+        if (memory_type != UINT32_MAX) {
+            break;
+        }
+    }
+
+    if (memory_type == UINT32_MAX) {
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex = memory_type;
+
+    if (vkAllocateMemory(device, &alloc_info, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate readback memory!");
+    }
+
+    vkBindBufferMemory(device, buffer, memory, 0);
+
+    void* data = nullptr;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+
+    this->size = size;
+    mapped_data = static_cast<uint8_t*>(data);
+    coherent = (mem_properties.memoryTypes[memory_type].propertyFlags &
+                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+void ReadbackBuffer::Free(VkDevice device) {
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkUnmapMemory(device, memory);
+    vkDestroyBuffer(device, buffer, nullptr);
+    vkFreeMemory(device, memory, nullptr);
+
+    buffer = VK_NULL_HANDLE;
+    memory = VK_NULL_HANDLE;
+    size = 0;
+    mapped_data = nullptr;
+}
+
+void ReadbackBuffer::Invalidate(VkDevice device) const {
+    // Cached memory is not coherent, its stale cache lines have to be
+    // discarded first
+    if (coherent) {
+        return;
+    }
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = memory;
+    range.offset = 0;
+    range.size = VK_WHOLE_SIZE;
+    vkInvalidateMappedMemoryRanges(device, 1, &range);
+}
+
+void FrameReadback::Init(VkPhysicalDevice physical_device, VkDevice device,
+                         uint32_t frames_in_flight) {
+    this->physical_device = physical_device;
+    this->device = device;
+
+    // Buffers are only allocated once the first capture is requested
+    slots.resize(frames_in_flight);
+}
+
+void FrameReadback::Destroy() {
+    for (auto& slot : slots) {
+        slot.readback_buffer.Free(device);
+    }
+    slots.clear();
+    requested_paths.clear();
+}
+
+bool FrameReadback::IsFormatSupported(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void FrameReadback::RequestCapture(const std::string& path) {
+    requested_paths.push_back(path);
+}
+
+bool FrameReadback::IsCapturePending() const {
+    if (!requested_paths.empty()) {
+        return true;
+    }
+
+    for (const auto& slot : slots) {
+        if (slot.recorded) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameReadback::Record(VkCommandBuffer command_buffer, uint32_t frame,
+                           VkImage image, VkFormat format, VkExtent2D extent,
+                           VkImageLayout layout) {
+    Slot& slot = slots[frame];
+    if (requested_paths.empty() || slot.recorded) {
+        return;
+    }
+
+    if (!IsFormatSupported(format)) {
+        throw std::runtime_error("image format cannot be captured!");
+    }
+
+    // The buffer of the slot is no longer in use, so it can be replaced if
+    // the image has grown
+    VkDeviceSize size = VkDeviceSize{extent.width} * extent.height * 4;
+    if (slot.readback_buffer.size < size) {
+        slot.readback_buffer.Free(device);
+        slot.readback_buffer.Allocate(physical_device, device, size,
+                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask =
+        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+
+    // Tightly packed rows
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+
+    vkCmdCopyImageToBuffer(command_buffer, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           slot.readback_buffer.buffer, 1, &region);
+
+    // Restore the layout for whatever follows, e.g. the presentation engine,
+    // and make the copy visible to the host once the fence has signaled
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = layout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+
+    VkBufferMemoryBarrier buffer_barrier{};
+    buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    buffer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    buffer_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.buffer = slot.readback_buffer.buffer;
+    buffer_barrier.offset = 0;
+    buffer_barrier.size = size;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT |
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &buffer_barrier, 1, &barrier);
+
+    slot.recorded = true;
+    slot.path = requested_paths.front();
+    slot.extent = extent;
+    slot.format = format;
+    requested_paths.erase(requested_paths.begin());
+}
+
+void FrameReadback::Collect(uint32_t frame, ImageWriter& writer) {
+    Slot& slot = slots[frame];
+    if (!slot.recorded) {
+        return;
+    }
+
+    slot.readback_buffer.Invalidate(device);
+
+    ReadbackImage image;
+    image.width = slot.extent.width;
+    image.height = slot.extent.height;
+    image.format = slot.format;
+    image.pixels.resize(size_t{image.width} * image.height * 4);
+    std::memcpy(image.pixels.data(), slot.readback_buffer.mapped_data,
+                image.pixels.size());
+
+    writer.Submit(slot.path, std::move(image));
+    slot.recorded = false;
+    slot.path.clear();
+}
@@ -0,0 +1,81 @@
+#ifndef FRAME_READBACK_H
+#define FRAME_READBACK_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "image_writer.hpp"
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+#include <vector>
+
+// Persistently mapped host visible buffer the GPU copies results into
+struct ReadbackBuffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    uint8_t* mapped_data = nullptr;
+    bool coherent = false;
+
+    void Allocate(VkPhysicalDevice physical_device, VkDevice device,
+                  VkDeviceSize size, VkBufferUsageFlags usage);
+    void Free(VkDevice device);
+
+    // Makes the writes of the GPU visible to the host. Must be called after
+    // the commands writing the buffer have completed.
+    void Invalidate(VkDevice device) const;
+};
+
+/* Copies rendered images into host visible buffers without stalling the
+render loop.
+
+A requested capture is recorded at the end of the command buffer of a frame
+slot. Its pixels are only read once the fence of that slot has signaled,
+which the render loop waits for anyway before it reuses the slot. Encoding
+and writing the file happens on the threads of an ImageWriter. */
+class FrameReadback {
+   private:
+    struct Slot {
+        ReadbackBuffer readback_buffer;
+
+        // Capture recorded into the command buffer of the slot
+        bool recorded = false;
+        std::string path;
+        VkExtent2D extent{};
+        VkFormat format = VK_FORMAT_UNDEFINED;
+    };
+
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    std::vector<Slot> slots;
+
+    // Paths of the captures that have not been recorded yet
+    std::vector<std::string> requested_paths;
+
+   public:
+    void Init(VkPhysicalDevice physical_device, VkDevice device,
+              uint32_t frames_in_flight);
+    void Destroy();
+
+    // Formats whose pixels can be written by the ImageWriter
+    static bool IsFormatSupported(VkFormat format);
+
+    void RequestCapture(const std::string& path);
+    bool IsCapturePending() const;
+
+    // Copy the image into the buffer of the frame slot if a capture was
+    // requested. The image is expected in the given layout after it has been
+    // written as a color attachment or storage image, and it is left in that
+    // layout.
+    void Record(VkCommandBuffer command_buffer, uint32_t frame, VkImage image,
+                VkFormat format, VkExtent2D extent, VkImageLayout layout);
+
+    // Hand the capture of the frame slot to the writer. Must be called after
+    // the fence of the slot has signaled.
+    void Collect(uint32_t frame, ImageWriter& writer);
+};
+
+#endif  // FRAME_READBACK_H
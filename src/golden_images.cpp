@@ -0,0 +1,115 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+namespace {
+
+// Post-processing configurations rendered as golden images. Each one covers
+// a different path through RecordCommandBuffer and the composite pass. Every
+// scene samples a streamed KTX2 texture from textures/, the scene texture
+// unless another one is named.
+struct GoldenScene {
+    const char* name;
+    std::array<bool, POST_STAGE_COUNT> post_stages;
+    const char* texture;
+    Camera camera;
+};
+
+const std::array<GoldenScene, 5> GOLDEN_SCENES = {{
+    {"full_chain", {true, true, true, true}, nullptr, {}},
+    {"bloom_tone_map", {true, true, true, false}, nullptr, {}},
+    {"tone_map_only", {false, false, true, false}, nullptr, {}},
+    {"no_post_processing", {false, false, false, false}, nullptr, {}},
+    // A texture without a mip chain, seen from afar so that the generated
+    // levels are sampled
+    {"generated_mips",
+     {false, false, false, false},
+     "textures/generated_mips.ktx2",
+     {0.0F, 0.0F, 0.2F, 30.0F}},
+}};
+
+}  // namespace
+
+bool TriangleApplication::RunGoldenImages() {
+    /* Render every golden scene headlessly, read back the final image and
+    compare it against the stored reference. Running this on a software
+    rasterizer such as lavapipe gives results that do not depend on the GPU
+    of the machine. The rendered images are written to the working
+    directory, with a diff image next to those that do not match. */
+    bool passed = true;
+    std::optional<uint32_t> scene_texture = streamed_texture;
+
+    for (const GoldenScene& scene : GOLDEN_SCENES) {
+        post_stage_enabled = scene.post_stages;
+        camera = scene.camera;
+        streamed_texture = scene.texture != nullptr
+                               ? texture_streamer.LoadTexture(scene.texture)
+                               : scene_texture;
+
+        // The texture is captured at full detail
+        WarmUpStreaming();
+
+        std::string name = scene.name;
+        std::string golden_path = options.golden_dir + "/" + name + ".ppm";
+        std::string actual_path = name + ".ppm";
+
+        // The capture is recorded into the next frame and written once the
+        // frame slot comes around again
+        frame_readback.RequestCapture(options.update_golden ? golden_path
+                                                            : actual_path);
+        while (frame_readback.IsCapturePending()) {
+            DrawOffscreenFrame();
+        }
+        image_writer.WaitIdle();
+
+        if (options.update_golden) {
+            std::cout << "updated " << golden_path << std::endl;
+        } else if (!CheckGoldenImage(name, golden_path, actual_path)) {
+            passed = false;
+        }
+    }
+
+    vkDeviceWaitIdle(device);
+    return passed;
+}
+
+bool TriangleApplication::CheckGoldenImage(const std::string& name,
+                                           const std::string& golden_path,
+                                           const std::string& actual_path) {
+    // A missing or unreadable image is a failure of this scene only
+    ReadbackImage expected;
+    ReadbackImage actual;
+    try {
+        expected = ReadPpm(golden_path);
+        actual = ReadPpm(actual_path);
+    } catch (const std::exception& e) {
+        std::cout << "FAIL " << name << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    ReadbackImage diff_image;
+    ImageDifference difference = CompareImages(
+        expected, actual, GOLDEN_PIXEL_TOLERANCE, &diff_image);
+
+    if (!difference.size_matches) {
+        std::cout << "FAIL " << name << ": expected " << expected.width << "x"
+                  << expected.height << ", rendered " << actual.width << "x"
+                  << actual.height << std::endl;
+        return false;
+    }
+
+    double differing_fraction =
+        static_cast<double>(difference.differing_pixels) /
+        difference.total_pixels;
+    bool passed = differing_fraction <= GOLDEN_MAX_DIFFERING_FRACTION;
+
+    std::cout << (passed ? "PASS " : "FAIL ") << name << ": "
+              << difference.differing_pixels << " of "
+              << difference.total_pixels << " pixels differ, max difference "
+              << std::fixed << std::setprecision(1)
+              << difference.max_difference << std::endl;
+
+    if (!passed) {
+        ImageWriter::WritePpm(name + "_diff.ppm", diff_image);
+    }
+    return passed;
+}
@@ -0,0 +1,339 @@
+/* Local header files */
+#include "gpu_profiler.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::find_if
+#include <array>
+#include <limits>  // Required for std::numeric_limits
+#include <stdexcept>
+#include <utility>  // Required for std::pair
+
+namespace {
+
+// Counters of a pipeline statistics query. The results are written in the
+// order of the bits, which is the order of GpuScopeStatistics.
+const VkQueryPipelineStatisticFlags PIPELINE_STATISTICS =
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+const size_t PIPELINE_STATISTICS_COUNT = 4;
+
+// Counts with a K or M suffix, so they stay short in the window title
+std::string FormatCount(uint64_t count) {
+    if (count >= 10000000) {
+        return std::to_string(count / 1000000) + "M";
+    }
+    if (count >= 10000) {
+        return std::to_string(count / 1000) + "K";
+    }
+    return std::to_string(count);
+}
+
+}  // namespace
+
+std::string FormatStatistics(const GpuScopeStatistics& statistics) {
+    const std::array<std::pair<const char*, uint64_t>, 4> counters = {{
+        {"vs", statistics.vertex_invocations},
+        {"prims", statistics.clipping_primitives},
+        {"fs", statistics.fragment_invocations},
+        {"cs", statistics.compute_invocations},
+    }};
+
+    std::string text;
+    for (const auto& counter : counters) {
+        if (counter.second == 0) {
+            continue;
+        }
+        if (!text.empty()) {
+            text += " ";
+        }
+        text += std::string(counter.first) + " " + FormatCount(counter.second);
+    }
+    return text;
+}
+
+void GpuProfiler::Init(VkPhysicalDevice physical_device, VkDevice device,
+                       uint32_t queue_family_index, uint32_t frames_in_flight,
+                       uint32_t max_scopes, bool pipeline_statistics_enabled,
+                       const DebugMarkers& debug_markers,
+                       Breadcrumbs& breadcrumbs) {
+    this->device = device;
+    this->debug_markers = &debug_markers;
+    this->breadcrumbs = &breadcrumbs;
+    this->frames_in_flight = frames_in_flight;
+    this->max_scopes = max_scopes;
+
+    // Scopes are numbered for the breadcrumbs even without timestamps
+    scope_names.resize(frames_in_flight);
+
+    // Timestamps are only supported if the queue family reports a non-zero
+    // number of valid bits
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device,
+                                             &queue_family_count, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(
+        physical_device, &queue_family_count, queue_families.data());
+
+    uint32_t valid_bits = queue_families[queue_family_index].timestampValidBits;
+    if (valid_bits == 0) {
+        return;
+    }
+
+    timestamp_mask = valid_bits >= 64 ? std::numeric_limits<uint64_t>::max()
+                                      : (uint64_t{1} << valid_bits) - 1;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    timestamp_period = static_cast<double>(properties.limits.timestampPeriod);
+
+    // Every scope writes a timestamp at its beginning and at its end
+    VkQueryPoolCreateInfo query_pool_info{};
+    query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = frames_in_flight * max_scopes * 2;
+
+    if (vkCreateQueryPool(device, &query_pool_info, nullptr, &query_pool) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+    debug_markers.SetName(query_pool, "gpu profiler timestamps");
+
+    // The pipelineStatisticsQuery feature has to be enabled on the device
+    if (pipeline_statistics_enabled) {
+        VkQueryPoolCreateInfo statistics_pool_info{};
+        statistics_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statistics_pool_info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statistics_pool_info.queryCount = frames_in_flight * max_scopes;
+        statistics_pool_info.pipelineStatistics = PIPELINE_STATISTICS;
+
+        if (vkCreateQueryPool(device, &statistics_pool_info, nullptr,
+                              &statistics_pool) != VK_SUCCESS) {
+            throw std::runtime_error(
+                "failed to create pipeline statistics query pool!");
+        }
+        debug_markers.SetName(statistics_pool, "gpu profiler statistics");
+    }
+}
+
+void GpuProfiler::Destroy() {
+    if (query_pool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, query_pool, nullptr);
+        query_pool = VK_NULL_HANDLE;
+    }
+    if (statistics_pool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, statistics_pool, nullptr);
+        statistics_pool = VK_NULL_HANDLE;
+    }
+
+    scope_names.clear();
+    results.clear();
+    totals.clear();
+}
+
+bool GpuProfiler::IsEnabled() const { return query_pool != VK_NULL_HANDLE; }
+
+bool GpuProfiler::HasStatistics() const {
+    return statistics_pool != VK_NULL_HANDLE;
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer command_buffer, uint32_t frame) {
+    if (scope_names.empty()) {
+        return;
+    }
+
+    recording_frame = frame;
+    scope_names[frame].clear();
+    breadcrumbs->BeginFrame(frame);
+
+    if (!IsEnabled()) {
+        return;
+    }
+
+    // Queries must be reset before they are used again. The reset has to be
+    // recorded outside of a render pass.
+    vkCmdResetQueryPool(command_buffer, query_pool, frame * max_scopes * 2,
+                        max_scopes * 2);
+    if (HasStatistics()) {
+        vkCmdResetQueryPool(command_buffer, statistics_pool, frame * max_scopes,
+                            max_scopes);
+    }
+}
+
+uint32_t GpuProfiler::BeginScope(VkCommandBuffer command_buffer,
+                                 const std::string& name) {
+    // Labels do not depend on timestamp support
+    debug_markers->BeginLabel(command_buffer, name.c_str());
+
+    if (scope_names.empty() ||
+        scope_names[recording_frame].size() >= max_scopes) {
+        return std::numeric_limits<uint32_t>::max();
+    }
+
+    auto scope = static_cast<uint32_t>(scope_names[recording_frame].size());
+    scope_names[recording_frame].push_back(name);
+    breadcrumbs->BeginPass(command_buffer, scope, name);
+
+    if (!IsEnabled()) {
+        return scope;
+    }
+
+    // The timestamp is written once all previously submitted commands have
+    // reached the top of the pipe
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        query_pool,
+                        (recording_frame * max_scopes + scope) * 2);
+
+    // Scopes never nest, so only one statistics query is active at a time
+    if (HasStatistics()) {
+        vkCmdBeginQuery(command_buffer, statistics_pool,
+                        recording_frame * max_scopes + scope, 0);
+    }
+
+    return scope;
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer command_buffer, uint32_t scope) {
+    debug_markers->EndLabel(command_buffer);
+
+    if (scope >= max_scopes) {
+        return;
+    }
+
+    // The timestamp is written once all previous commands have completed
+    if (IsEnabled()) {
+        if (HasStatistics()) {
+            vkCmdEndQuery(command_buffer, statistics_pool,
+                          recording_frame * max_scopes + scope);
+        }
+
+        vkCmdWriteTimestamp(command_buffer,
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query_pool,
+                            (recording_frame * max_scopes + scope) * 2 + 1);
+    }
+
+    breadcrumbs->EndPass(command_buffer, scope);
+}
+
+bool GpuProfiler::Collect(uint32_t frame) {
+    /* Read back the timestamps of a frame slot. This is called after the
+    fence of the frame has signaled, so the results are available and the
+    call does not stall. */
+    if (!IsEnabled() || scope_names[frame].empty()) {
+        return false;
+    }
+
+    const auto scope_count = static_cast<uint32_t>(scope_names[frame].size());
+    std::vector<uint64_t> timestamps(static_cast<size_t>(scope_count) * 2);
+
+    VkResult result = vkGetQueryPoolResults(
+        device, query_pool, frame * max_scopes * 2, scope_count * 2,
+        timestamps.size() * sizeof(uint64_t), timestamps.data(),
+        sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+    // VK_NOT_READY is returned if any of the queries is not available yet
+    if (result != VK_SUCCESS) {
+        return false;
+    }
+
+    results.resize(scope_count);
+    for (uint32_t i = 0; i < scope_count; i++) {
+        uint64_t begin = timestamps[static_cast<size_t>(i) * 2];
+        uint64_t end = timestamps[static_cast<size_t>(i) * 2 + 1];
+        uint64_t ticks = (end - begin) & timestamp_mask;
+
+        results[i].name = scope_names[frame][i];
+        results[i].milliseconds =
+            static_cast<double>(ticks) * timestamp_period / 1000000.0;
+        results[i].has_statistics = false;
+    }
+
+    if (HasStatistics()) {
+        ReadStatistics(frame, scope_count);
+    }
+
+    // The slot is consumed, so it is counted once even if the next frame
+    // returns before it records into the slot again, e.g. on a resize
+    scope_names[frame].clear();
+
+    AddToTotals();
+    return true;
+}
+
+void GpuProfiler::ReadStatistics(uint32_t frame, uint32_t scope_count) {
+    std::vector<uint64_t> counters(static_cast<size_t>(scope_count) *
+                                   PIPELINE_STATISTICS_COUNT);
+
+    // Queries of the same submission as the timestamps, so they are
+    // normally available as well
+    VkResult result = vkGetQueryPoolResults(
+        device, statistics_pool, frame * max_scopes, scope_count,
+        counters.size() * sizeof(uint64_t), counters.data(),
+        PIPELINE_STATISTICS_COUNT * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < scope_count; i++) {
+        const uint64_t* scope_counters =
+            &counters[static_cast<size_t>(i) * PIPELINE_STATISTICS_COUNT];
+        results[i].has_statistics = true;
+        results[i].statistics.vertex_invocations = scope_counters[0];
+        results[i].statistics.clipping_primitives = scope_counters[1];
+        results[i].statistics.fragment_invocations = scope_counters[2];
+        results[i].statistics.compute_invocations = scope_counters[3];
+    }
+}
+
+void GpuProfiler::AddToTotals() {
+    for (const GpuScopeTiming& result : results) {
+        auto total = std::find_if(totals.begin(), totals.end(),
+                                  [&result](const ScopeTotal& entry) {
+                                      return entry.sum.name == result.name;
+                                  });
+        if (total == totals.end()) {
+            totals.emplace_back();
+            total = totals.end() - 1;
+            total->sum.name = result.name;
+            total->sum.has_statistics = result.has_statistics;
+        }
+
+        total->frame_count++;
+        total->sum.milliseconds += result.milliseconds;
+        total->sum.has_statistics =
+            total->sum.has_statistics && result.has_statistics;
+
+        GpuScopeStatistics& sum = total->sum.statistics;
+        sum.vertex_invocations += result.statistics.vertex_invocations;
+        sum.clipping_primitives += result.statistics.clipping_primitives;
+        sum.fragment_invocations += result.statistics.fragment_invocations;
+        sum.compute_invocations += result.statistics.compute_invocations;
+    }
+}
+
+const std::vector<GpuScopeTiming>& GpuProfiler::GetResults() const {
+    return results;
+}
+
+std::vector<GpuScopeTiming> GpuProfiler::GetAverages() const {
+    std::vector<GpuScopeTiming> averages;
+    for (const ScopeTotal& total : totals) {
+        GpuScopeTiming average = total.sum;
+        average.milliseconds /= total.frame_count;
+
+        GpuScopeStatistics& statistics = average.statistics;
+        statistics.vertex_invocations /= total.frame_count;
+        statistics.clipping_primitives /= total.frame_count;
+        statistics.fragment_invocations /= total.frame_count;
+        statistics.compute_invocations /= total.frame_count;
+
+        averages.push_back(average);
+    }
+    return averages;
+}
+
+void GpuProfiler::ResetAverages() {
+    totals.clear();
+}
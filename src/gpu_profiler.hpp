@@ -0,0 +1,107 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "breadcrumbs.hpp"
+#include "debug_markers.hpp"
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+#include <vector>
+
+// Invocation counts between the begin and end of a profiler scope. Many
+// vertex invocations and primitives for few fragments point at a vertex
+// bound pass, and the other way around.
+struct GpuScopeStatistics {
+    uint64_t vertex_invocations = 0;
+    uint64_t clipping_primitives = 0;
+    uint64_t fragment_invocations = 0;
+    uint64_t compute_invocations = 0;
+};
+
+// GPU time spent between the begin and end of a profiler scope
+struct GpuScopeTiming {
+    std::string name;
+    double milliseconds = 0.0;
+
+    // Only set if the device supports pipeline statistics queries
+    bool has_statistics = false;
+    GpuScopeStatistics statistics;
+};
+
+// Short form of the nonzero counters, such as "vs 3 prims 1 fs 480K"
+std::string FormatStatistics(const GpuScopeStatistics& statistics);
+
+/* Measures GPU execution time of named scopes within a frame using timestamp
+queries. Every frame in flight owns its own range of queries, so the results
+of a frame can be read back without waiting once its fence has signaled.
+Every scope is also a debug label, so captures show the same regions, and
+a breadcrumb, so a lost device can be traced back to a scope. Both work
+without timestamp support.
+
+If the device supports pipeline statistics queries, every scope also counts
+the shader invocations and primitives of its commands. They are read back
+in the same way as the timestamps. */
+class GpuProfiler {
+   private:
+    VkDevice device = VK_NULL_HANDLE;
+    const DebugMarkers* debug_markers = nullptr;
+    Breadcrumbs* breadcrumbs = nullptr;
+    VkQueryPool query_pool = VK_NULL_HANDLE;
+
+    // One pipeline statistics query per scope, null if not supported
+    VkQueryPool statistics_pool = VK_NULL_HANDLE;
+    uint32_t frames_in_flight = 0;
+    uint32_t max_scopes = 0;
+
+    // Number of nanoseconds it takes for a timestamp to be incremented by 1
+    double timestamp_period = 0.0;
+    uint64_t timestamp_mask = 0;
+
+    // Frame slot the scopes are currently recorded into
+    uint32_t recording_frame = 0;
+
+    // Names of the scopes recorded into each frame slot
+    std::vector<std::vector<std::string>> scope_names;
+    std::vector<GpuScopeTiming> results;
+
+    // Sums of the collected results by scope name, for averages over many
+    // frames
+    struct ScopeTotal {
+        GpuScopeTiming sum;
+        uint32_t frame_count = 0;
+    };
+    std::vector<ScopeTotal> totals;
+
+    void ReadStatistics(uint32_t frame, uint32_t scope_count);
+    void AddToTotals();
+
+   public:
+    void Init(VkPhysicalDevice physical_device, VkDevice device,
+              uint32_t queue_family_index, uint32_t frames_in_flight,
+              uint32_t max_scopes, bool pipeline_statistics_enabled,
+              const DebugMarkers& debug_markers, Breadcrumbs& breadcrumbs);
+    void Destroy();
+    bool IsEnabled() const;
+    bool HasStatistics() const;
+    void BeginFrame(VkCommandBuffer command_buffer, uint32_t frame);
+    uint32_t BeginScope(VkCommandBuffer command_buffer,
+                        const std::string& name);
+    void EndScope(VkCommandBuffer command_buffer, uint32_t scope);
+
+    // False if the frame slot has no new results, which leaves the previous
+    // ones in place
+    bool Collect(uint32_t frame);
+    const std::vector<GpuScopeTiming>& GetResults() const;
+
+    // Average time and counts of every scope per frame, since the last
+    // reset. Scopes recorded several times a frame are averaged per record.
+    std::vector<GpuScopeTiming> GetAverages() const;
+    void ResetAverages();
+};
+
+#endif  // GPU_PROFILER_H
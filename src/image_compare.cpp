@@ -0,0 +1,149 @@
+/* Local header files */
+#include "image_compare.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::max
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <limits>  // Required for std::numeric_limits
+#include <stdexcept>
+
+namespace {
+
+// BT.709 luma coefficients
+const float KR = 0.2126F;
+const float KB = 0.0722F;
+const float KG = 1.0F - KR - KB;
+
+// Squared chroma differences are scaled down, halving their weight
+const float CHROMA_WEIGHT = 0.25F;
+
+bool IsBgr(VkFormat format) {
+    return format == VK_FORMAT_B8G8R8A8_UNORM ||
+           format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+std::array<float, 3> ToYCbCr(const ReadbackImage& image, size_t index) {
+    const uint8_t* pixel = image.pixels.data() + index * 4;
+    bool bgr = IsBgr(image.format);
+    float r = bgr ? pixel[2] : pixel[0];
+    float g = pixel[1];
+    float b = bgr ? pixel[0] : pixel[2];
+
+    float y = KR * r + KG * g + KB * b;
+    return {y, (b - y) / (2.0F * (1.0F - KB)), (r - y) / (2.0F * (1.0F - KR))};
+}
+
+// Skips whitespace and comments before the next value of a PPM header
+uint32_t ReadHeaderValue(std::ifstream& file) {
+    while (true) {
+        int next = file.peek();
+        if (next == '#') {
+            file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        } else if (next == ' ' || next == '\t' || next == '\r' ||
+                   next == '\n') {
+            file.get();
+        } else {
+            break;
+        }
+    }
+
+    uint32_t value = 0;
+    file >> value;
+    return value;
+}
+
+}  // namespace
+
+ReadbackImage ReadPpm(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + path + "!");
+    }
+
+    std::string magic;
+    file >> magic;
+
+    ReadbackImage image;
+    image.width = ReadHeaderValue(file);
+    image.height = ReadHeaderValue(file);
+    uint32_t max_value = ReadHeaderValue(file);
+
+    // A single whitespace character separates the header from the pixels
+    file.get();
+
+    if (!file || magic != "P6" || max_value != 255 || image.width == 0 ||
+        image.height == 0) {
+        throw std::runtime_error("unsupported PPM file: " + path + "!");
+    }
+
+    size_t pixel_count = size_t{image.width} * image.height;
+    std::vector<uint8_t> rgb(pixel_count * 3);
+    file.read(reinterpret_cast<char*>(rgb.data()),
+              static_cast<std::streamsize>(rgb.size()));
+    if (!file) {
+        throw std::runtime_error("failed to read file: " + path + "!");
+    }
+
+    image.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image.pixels.resize(pixel_count * 4);
+    for (size_t i = 0; i < pixel_count; i++) {
+        image.pixels[i * 4 + 0] = rgb[i * 3 + 0];
+        image.pixels[i * 4 + 1] = rgb[i * 3 + 1];
+        image.pixels[i * 4 + 2] = rgb[i * 3 + 2];
+        image.pixels[i * 4 + 3] = 255;
+    }
+
+    return image;
+}
+
+ImageDifference CompareImages(const ReadbackImage& expected,
+                              const ReadbackImage& actual, float tolerance,
+                              ReadbackImage* diff_image) {
+    ImageDifference difference;
+    difference.size_matches = expected.width == actual.width &&
+                              expected.height == actual.height;
+    if (!difference.size_matches) {
+        return difference;
+    }
+
+    size_t pixel_count = size_t{actual.width} * actual.height;
+    difference.total_pixels = static_cast<uint32_t>(pixel_count);
+
+    if (diff_image != nullptr) {
+        diff_image->width = actual.width;
+        diff_image->height = actual.height;
+        diff_image->format = VK_FORMAT_R8G8B8A8_UNORM;
+        diff_image->pixels.resize(pixel_count * 4);
+    }
+
+    for (size_t i = 0; i < pixel_count; i++) {
+        std::array<float, 3> a = ToYCbCr(expected, i);
+        std::array<float, 3> b = ToYCbCr(actual, i);
+
+        float luma = a[0] - b[0];
+        float blue = a[1] - b[1];
+        float red = a[2] - b[2];
+        float pixel_difference = std::sqrt(
+            luma * luma + CHROMA_WEIGHT * (blue * blue + red * red));
+
+        difference.max_difference =
+            std::max(difference.max_difference, pixel_difference);
+        bool differs = pixel_difference > tolerance;
+        if (differs) {
+            difference.differing_pixels++;
+        }
+
+        if (diff_image != nullptr) {
+            uint8_t* pixel = diff_image->pixels.data() + i * 4;
+            auto dimmed = static_cast<uint8_t>(b[0] * 0.25F);
+            pixel[0] = differs ? 255 : dimmed;
+            pixel[1] = differs ? 0 : dimmed;
+            pixel[2] = differs ? 0 : dimmed;
+            pixel[3] = 255;
+        }
+    }
+
+    return difference;
+}
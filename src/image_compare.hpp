@@ -0,0 +1,34 @@
+#ifndef IMAGE_COMPARE_H
+#define IMAGE_COMPARE_H
+
+/* Local header files */
+#include "image_writer.hpp"
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+
+// Result of comparing a rendered image against its reference
+struct ImageDifference {
+    bool size_matches = false;
+    uint32_t differing_pixels = 0;
+    uint32_t total_pixels = 0;
+
+    // Largest perceptual difference of any pixel, on a scale of 0 to 255
+    float max_difference = 0.0F;
+};
+
+// Reads a binary 8 bit PPM as written by ImageWriter::WritePpm. The pixels
+// are returned as R8G8B8A8_UNORM with an opaque alpha channel.
+ReadbackImage ReadPpm(const std::string& path);
+
+/* Compares two images pixel by pixel. The difference of a pixel is measured
+in Y'CbCr, where changes in brightness weigh more than changes in hue, so
+small color shifts along edges tolerated by the eye are not flagged. Pixels
+whose difference exceeds the tolerance are counted and, if a diff image is
+given, painted red over a dimmed copy of the actual image. */
+ImageDifference CompareImages(const ReadbackImage& expected,
+                              const ReadbackImage& actual, float tolerance,
+                              ReadbackImage* diff_image = nullptr);
+
+#endif  // IMAGE_COMPARE_H
@@ -0,0 +1,275 @@
+/* Local header files */
+#include "image_writer.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::min
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utility>  // Required for std::move
+
+namespace {
+
+// Largest payload of a stored deflate block
+const size_t MAX_STORED_BLOCK_SIZE = 65535;
+
+// Number of bytes the sums of Adler-32 can take before they overflow
+const size_t ADLER_BLOCK_SIZE = 5552;
+
+bool HasExtension(const std::string& path, const std::string& extension) {
+    return path.size() >= extension.size() &&
+           path.compare(path.size() - extension.size(), extension.size(),
+                        extension) == 0;
+}
+
+bool IsBgr(VkFormat format) {
+    return format == VK_FORMAT_B8G8R8A8_UNORM ||
+           format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+// Converts a row of four channel pixels into RGB
+void ConvertRow(const ReadbackImage& image, uint32_t y, uint8_t* rgb) {
+    const uint8_t* row = image.pixels.data() + size_t{y} * image.width * 4;
+    bool bgr = IsBgr(image.format);
+
+    for (uint32_t x = 0; x < image.width; x++) {
+        const uint8_t* pixel = row + size_t{x} * 4;
+        rgb[x * 3 + 0] = bgr ? pixel[2] : pixel[0];
+        rgb[x * 3 + 1] = pixel[1];
+        rgb[x * 3 + 2] = bgr ? pixel[0] : pixel[2];
+    }
+}
+
+std::ofstream OpenOutput(const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + path + "!");
+    }
+    return file;
+}
+
+uint32_t Crc32(const uint8_t* data, size_t size) {
+    // Table of the polynomial used by PNG, built on first use
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> entries{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value & 1U) ? 0xEDB88320U ^ (value >> 1) : value >> 1;
+            }
+            entries[i] = value;
+        }
+        return entries;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFU;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void AppendBigEndian(std::vector<uint8_t>& data, uint32_t value) {
+    data.push_back(static_cast<uint8_t>(value >> 24));
+    data.push_back(static_cast<uint8_t>(value >> 16));
+    data.push_back(static_cast<uint8_t>(value >> 8));
+    data.push_back(static_cast<uint8_t>(value));
+}
+
+void WriteChunk(std::ofstream& file, const char* type,
+                const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    AppendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+
+    // The CRC covers the type and the data, but not the length
+    AppendBigEndian(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+
+    file.write(reinterpret_cast<const char*>(chunk.data()),
+               static_cast<std::streamsize>(chunk.size()));
+}
+
+}  // namespace
+
+ImageWriter::~ImageWriter() { Stop(); }
+
+void ImageWriter::Start(uint32_t thread_count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = false;
+
+    for (uint32_t i = 0; i < std::max(thread_count, 1U); i++) {
+        workers.emplace_back(&ImageWriter::WorkerLoop, this);
+    }
+}
+
+void ImageWriter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_available.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void ImageWriter::Submit(const std::string& path, ReadbackImage image) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back({path, std::move(image)});
+    }
+    job_available.notify_one();
+}
+
+void ImageWriter::WaitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobs_done.wait(lock, [this] { return jobs.empty() && active_jobs == 0; });
+}
+
+void ImageWriter::WaitForPendingBelow(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobs_done.wait(
+        lock, [this, count] { return jobs.size() + active_jobs < count; });
+}
+
+size_t ImageWriter::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size() + active_jobs;
+}
+
+uint64_t ImageWriter::GetWrittenCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written_count;
+}
+
+void ImageWriter::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        job_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+        // Queued images are still written when the writer is stopped
+        if (jobs.empty()) {
+            return;
+        }
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        active_jobs++;
+        lock.unlock();
+
+        // An image that cannot be written must not take the worker down
+        bool written = false;
+        try {
+            if (HasExtension(job.path, ".ppm")) {
+                WritePpm(job.path, job.image);
+            } else {
+                WritePng(job.path, job.image);
+            }
+            written = true;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+
+        lock.lock();
+        active_jobs--;
+        if (written) {
+            written_count++;
+        }
+        jobs_done.notify_all();
+    }
+}
+
+void ImageWriter::WritePpm(const std::string& path,
+                           const ReadbackImage& image) {
+    std::ofstream file = OpenOutput(path);
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+
+    std::vector<uint8_t> row(size_t{image.width} * 3);
+    for (uint32_t y = 0; y < image.height; y++) {
+        ConvertRow(image, y, row.data());
+        file.write(reinterpret_cast<const char*>(row.data()),
+                   static_cast<std::streamsize>(row.size()));
+    }
+
+    if (!file) {
+        throw std::runtime_error("failed to write file: " + path + "!");
+    }
+}
+
+void ImageWriter::WritePng(const std::string& path,
+                           const ReadbackImage& image) {
+    /* The image data is stored in uncompressed deflate blocks. The files are
+    larger than those of a real encoder, but writing them costs little more
+    than the copy itself, which matters when every frame is captured. */
+    std::ofstream file = OpenOutput(path);
+
+    const std::array<uint8_t, 8> signature = {0x89, 'P',  'N',  'G',
+                                              '\r', '\n', 0x1A, '\n'};
+    file.write(reinterpret_cast<const char*>(signature.data()),
+               signature.size());
+
+    // 8 bit RGB, no interlacing
+    std::vector<uint8_t> header;
+    AppendBigEndian(header, image.width);
+    AppendBigEndian(header, image.height);
+    header.insert(header.end(), {8, 2, 0, 0, 0});
+    WriteChunk(file, "IHDR", header);
+
+    // Every row starts with the filter type, 0 means no filter
+    size_t row_size = size_t{image.width} * 3 + 1;
+    std::vector<uint8_t> raw(row_size * image.height);
+    for (uint32_t y = 0; y < image.height; y++) {
+        raw[y * row_size] = 0;
+        ConvertRow(image, y, raw.data() + y * row_size + 1);
+    }
+
+    // zlib stream: header, stored blocks and the Adler-32 of the raw data
+    std::vector<uint8_t> compressed = {0x78, 0x01};
+    compressed.reserve(raw.size() + raw.size() / MAX_STORED_BLOCK_SIZE * 5 +
+                       16);
+
+    uint32_t adler_a = 1;
+    uint32_t adler_b = 0;
+    for (size_t begin = 0; begin < raw.size(); begin += ADLER_BLOCK_SIZE) {
+        size_t end = std::min(raw.size(), begin + ADLER_BLOCK_SIZE);
+        for (size_t i = begin; i < end; i++) {
+            adler_a += raw[i];
+            adler_b += adler_a;
+        }
+        adler_a %= 65521U;
+        adler_b %= 65521U;
+    }
+
+    size_t offset = 0;
+    do {
+        size_t block_size =
+            std::min(raw.size() - offset, MAX_STORED_BLOCK_SIZE);
+        bool last = offset + block_size == raw.size();
+        auto length = static_cast<uint16_t>(block_size);
+        auto inverted_length = static_cast<uint16_t>(~length);
+
+        // Block header followed by the length and its one's complement
+        compressed.push_back(last ? 1 : 0);
+        compressed.push_back(static_cast<uint8_t>(length));
+        compressed.push_back(static_cast<uint8_t>(length >> 8));
+        compressed.push_back(static_cast<uint8_t>(inverted_length));
+        compressed.push_back(static_cast<uint8_t>(inverted_length >> 8));
+        compressed.insert(compressed.end(), raw.begin() + offset,
+                          raw.begin() + offset + block_size);
+        offset += block_size;
+    } while (offset < raw.size());
+
+    AppendBigEndian(compressed, (adler_b << 16) | adler_a);
+    WriteChunk(file, "IDAT", compressed);
+    WriteChunk(file, "IEND", {});
+
+    if (!file) {
+        throw std::runtime_error("failed to write file: " + path + "!");
+    }
+}
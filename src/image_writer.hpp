@@ -0,0 +1,72 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <condition_variable>
+#include <cstdint>  // Required for uint32_t
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Tightly packed 8 bit pixels with four channels, as read back from the GPU
+struct ReadbackImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    // One of the formats accepted by FrameReadback
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    std::vector<uint8_t> pixels;
+};
+
+/* Encodes images and writes them to disk on worker threads, so the render
+loop never waits for the file system. The format is picked from the file
+extension: ".ppm" writes a binary PPM, anything else a PNG. Alpha is
+dropped in both cases. */
+class ImageWriter {
+   private:
+    struct Job {
+        std::string path;
+        ReadbackImage image;
+    };
+
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable job_available;
+    std::condition_variable jobs_done;
+    std::deque<Job> jobs;
+    uint32_t active_jobs = 0;
+    uint64_t written_count = 0;
+    bool stopping = false;
+
+    void WorkerLoop();
+
+   public:
+    ImageWriter() = default;
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+    ~ImageWriter();
+
+    void Start(uint32_t thread_count);
+
+    // Finishes the queued images before the workers are joined
+    void Stop();
+
+    void Submit(const std::string& path, ReadbackImage image);
+    void WaitIdle();
+
+    // Blocks until fewer than the given number of images are queued or being
+    // written, so a producer cannot run arbitrarily far ahead
+    void WaitForPendingBelow(size_t count);
+    size_t GetPendingCount() const;
+    uint64_t GetWrittenCount() const;
+
+    static void WritePpm(const std::string& path, const ReadbackImage& image);
+    static void WritePng(const std::string& path, const ReadbackImage& image);
+};
+
+#endif  // IMAGE_WRITER_H
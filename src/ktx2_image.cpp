@@ -0,0 +1,424 @@
+/* Local header files */
+#include "ktx2_image.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::max
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>  // Required for std::move
+
+namespace {
+
+// Every KTX2 file starts with this identifier
+const std::array<uint8_t, 12> KTX2_IDENTIFIER = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+// Size of the identifier, the header and the index preceding the level index
+const size_t KTX2_LEVEL_INDEX_OFFSET = 80;
+
+// Size of a single entry of the level index
+const size_t KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;
+
+// Supercompression schemes other than none require an external decoder
+const uint32_t KTX2_SUPERCOMPRESSION_NONE = 0;
+
+// Larger images are not sampled by any device, and bounding the size keeps
+// the level sizes from overflowing
+const uint32_t KTX2_MAX_DIMENSION = 16384;
+
+/* KTX2 stores its header fields in little endian byte order, which is the
+native byte order of every platform the application runs on */
+uint32_t ReadUint32(const std::vector<uint8_t>& data, size_t offset) {
+    uint32_t value = 0;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+uint64_t ReadUint64(const std::vector<uint8_t>& data, size_t offset) {
+    uint64_t value = 0;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+using Rgba8 = std::array<uint8_t, 4>;
+
+Rgba8 DecodeRgb565(uint16_t color) {
+    // Expand the 5 and 6 bit channels to 8 bits by replicating the high bits
+    auto r = static_cast<uint8_t>((color >> 11) & 0x1F);
+    auto g = static_cast<uint8_t>((color >> 5) & 0x3F);
+    auto b = static_cast<uint8_t>(color & 0x1F);
+    return {static_cast<uint8_t>((r << 3) | (r >> 2)),
+            static_cast<uint8_t>((g << 2) | (g >> 4)),
+            static_cast<uint8_t>((b << 3) | (b >> 2)), 255};
+}
+
+uint8_t Interpolate(uint32_t a, uint32_t b, uint32_t weight_a,
+                    uint32_t weight_b) {
+    return static_cast<uint8_t>((a * weight_a + b * weight_b) /
+                                (weight_a + weight_b));
+}
+
+void DecodeColorBlock(const uint8_t* block, bool allow_transparency,
+                      std::array<Rgba8, 16>& texels) {
+    /* BC1 color block: two RGB565 endpoints followed by a 2 bit palette index
+    for every texel. If the first endpoint is not greater than the second, the
+    palette holds a single midpoint and transparent black instead of two
+    interpolated colors. */
+    uint16_t color0 = 0;
+    uint16_t color1 = 0;
+    uint32_t indices = 0;
+    std::memcpy(&color0, block, sizeof(color0));
+    std::memcpy(&color1, block + 2, sizeof(color1));
+    std::memcpy(&indices, block + 4, sizeof(indices));
+
+    std::array<Rgba8, 4> palette{};
+    palette[0] = DecodeRgb565(color0);
+    palette[1] = DecodeRgb565(color1);
+
+    bool four_colors = color0 > color1 || !allow_transparency;
+    for (size_t c = 0; c < 3; c++) {
+        if (four_colors) {
+            palette[2][c] = Interpolate(palette[0][c], palette[1][c], 2, 1);
+            palette[3][c] = Interpolate(palette[0][c], palette[1][c], 1, 2);
+        } else {
+            palette[2][c] = Interpolate(palette[0][c], palette[1][c], 1, 1);
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = four_colors ? 255 : 0;
+
+    for (size_t i = 0; i < texels.size(); i++) {
+        texels[i] = palette[(indices >> (i * 2)) & 0x3];
+    }
+}
+
+void DecodeChannelBlock(const uint8_t* block, size_t channel,
+                        std::array<Rgba8, 16>& texels) {
+    /* BC4 channel block: two 8 bit endpoints followed by a 3 bit palette index
+    for every texel. BC3 stores its alpha and BC5 both of its channels in the
+    same way. */
+    std::array<uint8_t, 8> palette{};
+    palette[0] = block[0];
+    palette[1] = block[1];
+
+    if (palette[0] > palette[1]) {
+        for (uint32_t i = 1; i < 7; i++) {
+            palette[i + 1] = Interpolate(palette[0], palette[1], 7 - i, i);
+        }
+    } else {
+        for (uint32_t i = 1; i < 5; i++) {
+            palette[i + 1] = Interpolate(palette[0], palette[1], 5 - i, i);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    std::memcpy(&indices, block + 2, 6);
+
+    for (size_t i = 0; i < texels.size(); i++) {
+        texels[i][channel] = palette[(indices >> (i * 3)) & 0x7];
+    }
+}
+
+void DecodeExplicitAlphaBlock(const uint8_t* block,
+                              std::array<Rgba8, 16>& texels) {
+    // BC2 alpha block: a 4 bit alpha value for every texel
+    uint64_t alphas = 0;
+    std::memcpy(&alphas, block, sizeof(alphas));
+
+    for (size_t i = 0; i < texels.size(); i++) {
+        auto alpha = static_cast<uint8_t>((alphas >> (i * 4)) & 0xF);
+        texels[i][3] = static_cast<uint8_t>(alpha * 17);
+    }
+}
+
+}  // namespace
+
+Ktx2Image Ktx2Image::Load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + filename + "!");
+    }
+
+    auto file_size = static_cast<size_t>(file.tellg());
+    std::vector<uint8_t> file_data(file_size);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(file_data.data()),
+              static_cast<std::streamsize>(file_size));
+    file.close();
+
+    if (file_size < KTX2_LEVEL_INDEX_OFFSET ||
+        !std::equal(KTX2_IDENTIFIER.begin(), KTX2_IDENTIFIER.end(),
+                    file_data.begin())) {
+        throw std::runtime_error("not a KTX2 file: " + filename + "!");
+    }
+
+    /* Header layout following the 12 byte identifier:
+    vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth, layerCount,
+    faceCount, levelCount, supercompressionScheme */
+    Ktx2Image image;
+    image.format = static_cast<VkFormat>(ReadUint32(file_data, 12));
+    image.width = ReadUint32(file_data, 20);
+    image.height = ReadUint32(file_data, 24);
+    uint32_t depth = ReadUint32(file_data, 28);
+    uint32_t layer_count = ReadUint32(file_data, 32);
+    uint32_t face_count = ReadUint32(file_data, 36);
+    uint32_t level_count = std::max(ReadUint32(file_data, 40), 1U);
+    uint32_t supercompression = ReadUint32(file_data, 44);
+
+    // Only plain 2D textures are streamed
+    if (image.width == 0 || image.height == 0 || depth > 1 ||
+        layer_count > 1 || face_count != 1) {
+        throw std::runtime_error("unsupported KTX2 image type: " + filename +
+                                 "!");
+    }
+
+    if (image.width > KTX2_MAX_DIMENSION || image.height > KTX2_MAX_DIMENSION) {
+        throw std::runtime_error("KTX2 image is too large: " + filename + "!");
+    }
+
+    // A mip chain ends at a single texel
+    uint32_t full_level_count = 1;
+    while ((std::max(image.width, image.height) >> full_level_count) > 0) {
+        full_level_count++;
+    }
+    if (level_count > full_level_count) {
+        throw std::runtime_error("corrupt KTX2 level count: " + filename +
+                                 "!");
+    }
+
+    // Basis Universal and zstd payloads need an external decoder
+    if (image.format == VK_FORMAT_UNDEFINED ||
+        supercompression != KTX2_SUPERCOMPRESSION_NONE) {
+        throw std::runtime_error("supercompressed KTX2 files are not "
+                                 "supported: " +
+                                 filename + "!");
+    }
+
+    if (GetBlockFormatInfo(image.format).block_bytes == 0) {
+        throw std::runtime_error("unsupported KTX2 format: " + filename + "!");
+    }
+
+    if (file_size <
+        KTX2_LEVEL_INDEX_OFFSET + level_count * KTX2_LEVEL_INDEX_ENTRY_SIZE) {
+        throw std::runtime_error("truncated KTX2 file: " + filename + "!");
+    }
+
+    // The payload of every level is copied out of the file, so the rest of
+    // the file contents can be released
+    image.levels.resize(level_count);
+    for (uint32_t level = 0; level < level_count; level++) {
+        size_t entry =
+            KTX2_LEVEL_INDEX_OFFSET + level * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+        auto offset = static_cast<size_t>(ReadUint64(file_data, entry));
+        auto size = static_cast<size_t>(ReadUint64(file_data, entry + 8));
+
+        // Written so that a hostile offset cannot wrap the sum around
+        if (offset > file_size || size > file_size - offset ||
+            size != image.GetLevelSize(level)) {
+            throw std::runtime_error("corrupt KTX2 level index: " + filename +
+                                     "!");
+        }
+
+        image.levels[level].offset = image.data.size();
+        image.levels[level].size = size;
+        image.data.insert(image.data.end(), file_data.begin() + offset,
+                          file_data.begin() + offset + size);
+    }
+
+    return image;
+}
+
+BlockFormatInfo Ktx2Image::GetBlockFormatInfo(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            return {1, 1, 4};
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+            return {4, 4, 8};
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+            return {4, 4, 16};
+        case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+            return {6, 6, 16};
+        case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+            return {8, 8, 16};
+        default:
+            return {};
+    }
+}
+
+VkFormat Ktx2Image::GetFormat() const { return format; }
+
+uint32_t Ktx2Image::GetWidth() const { return width; }
+
+uint32_t Ktx2Image::GetHeight() const { return height; }
+
+uint32_t Ktx2Image::GetLevelCount() const {
+    return static_cast<uint32_t>(levels.size());
+}
+
+VkExtent2D Ktx2Image::GetLevelExtent(uint32_t level) const {
+    return {std::max(width >> level, 1U), std::max(height >> level, 1U)};
+}
+
+uint32_t Ktx2Image::GetLevelBlockRows(uint32_t level) const {
+    BlockFormatInfo info = GetBlockFormatInfo(format);
+    return (GetLevelExtent(level).height + info.block_height - 1) /
+           info.block_height;
+}
+
+size_t Ktx2Image::GetLevelRowPitch(uint32_t level) const {
+    // Size of a single row of blocks
+    BlockFormatInfo info = GetBlockFormatInfo(format);
+    uint32_t block_columns =
+        (GetLevelExtent(level).width + info.block_width - 1) /
+        info.block_width;
+    return static_cast<size_t>(block_columns) * info.block_bytes;
+}
+
+const uint8_t* Ktx2Image::GetLevelData(uint32_t level) const {
+    return data.data() + levels[level].offset;
+}
+
+size_t Ktx2Image::GetLevelSize(uint32_t level) const {
+    return GetLevelRowPitch(level) * GetLevelBlockRows(level);
+}
+
+bool Ktx2Image::CanTranscodeToRgba8() const {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Ktx2Image::TranscodeToRgba8() {
+    /* Decode every block of every level into RGBA8 texels. Single and two
+    channel formats leave the missing color channels at 0 and alpha at 1,
+    which matches how the GPU samples them. */
+    if (!CanTranscodeToRgba8()) {
+        throw std::runtime_error("no CPU decoder for the texture format!");
+    }
+
+    bool srgb = format == VK_FORMAT_BC1_RGB_SRGB_BLOCK ||
+                format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK ||
+                format == VK_FORMAT_BC2_SRGB_BLOCK ||
+                format == VK_FORMAT_BC3_SRGB_BLOCK;
+    bool bc1_alpha = format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK ||
+                     format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+
+    BlockFormatInfo info = GetBlockFormatInfo(format);
+    std::vector<Ktx2Level> decoded_levels(levels.size());
+    std::vector<uint8_t> decoded_data;
+
+    for (uint32_t level = 0; level < GetLevelCount(); level++) {
+        VkExtent2D extent = GetLevelExtent(level);
+        uint32_t block_columns = (extent.width + 3) / 4;
+        uint32_t block_rows = (extent.height + 3) / 4;
+
+        decoded_levels[level].offset = decoded_data.size();
+        decoded_levels[level].size =
+            static_cast<size_t>(extent.width) * extent.height * 4;
+        decoded_data.resize(decoded_data.size() + decoded_levels[level].size);
+
+        uint8_t* output = decoded_data.data() + decoded_levels[level].offset;
+        const uint8_t* block = GetLevelData(level);
+
+        for (uint32_t by = 0; by < block_rows; by++) {
+            for (uint32_t bx = 0; bx < block_columns; bx++) {
+                std::array<Rgba8, 16> texels{};
+                for (auto& texel : texels) {
+                    texel = {0, 0, 0, 255};
+                }
+
+                switch (format) {
+                    case VK_FORMAT_BC2_UNORM_BLOCK:
+                    case VK_FORMAT_BC2_SRGB_BLOCK:
+                        DecodeColorBlock(block + 8, false, texels);
+                        DecodeExplicitAlphaBlock(block, texels);
+                        break;
+                    case VK_FORMAT_BC3_UNORM_BLOCK:
+                    case VK_FORMAT_BC3_SRGB_BLOCK:
+                        DecodeColorBlock(block + 8, false, texels);
+                        DecodeChannelBlock(block, 3, texels);
+                        break;
+                    case VK_FORMAT_BC4_UNORM_BLOCK:
+                        DecodeChannelBlock(block, 0, texels);
+                        break;
+                    case VK_FORMAT_BC5_UNORM_BLOCK:
+                        DecodeChannelBlock(block, 0, texels);
+                        DecodeChannelBlock(block + 8, 1, texels);
+                        break;
+                    default:
+                        DecodeColorBlock(block, bc1_alpha, texels);
+                        break;
+                }
+                block += info.block_bytes;
+
+                // Blocks on the right and bottom edge may cover texels
+                // outside of the level
+                for (uint32_t y = 0; y < 4; y++) {
+                    for (uint32_t x = 0; x < 4; x++) {
+                        uint32_t px = bx * 4 + x;
+                        uint32_t py = by * 4 + y;
+                        if (px >= extent.width || py >= extent.height) {
+                            continue;
+                        }
+
+                        size_t index =
+                            (static_cast<size_t>(py) * extent.width + px) * 4;
+                        std::memcpy(output + index, texels[y * 4 + x].data(),
+                                    4);
+                    }
+                }
+            }
+        }
+    }
+
+    format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    levels = std::move(decoded_levels);
+    data = std::move(decoded_data);
+}
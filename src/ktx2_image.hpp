@@ -0,0 +1,57 @@
+#ifndef KTX2_IMAGE_H
+#define KTX2_IMAGE_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+#include <vector>
+
+// Size of the blocks a format is stored in. Uncompressed formats use blocks
+// of a single texel.
+struct BlockFormatInfo {
+    uint32_t block_width = 1;
+    uint32_t block_height = 1;
+    uint32_t block_bytes = 0;
+};
+
+// Location of a mip level inside the texel data of the image
+struct Ktx2Level {
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+/* 2D image loaded from a KTX2 container. The payload is kept exactly as it is
+stored in the file, so block compressed formats (BC, ETC2, ASTC) can be copied
+to the GPU without any processing. Level 0 is the most detailed mip level. */
+class Ktx2Image {
+   private:
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<Ktx2Level> levels;
+    std::vector<uint8_t> data;
+
+   public:
+    static Ktx2Image Load(const std::string& filename);
+    static BlockFormatInfo GetBlockFormatInfo(VkFormat format);
+
+    VkFormat GetFormat() const;
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+    uint32_t GetLevelCount() const;
+    VkExtent2D GetLevelExtent(uint32_t level) const;
+    uint32_t GetLevelBlockRows(uint32_t level) const;
+    size_t GetLevelRowPitch(uint32_t level) const;
+    const uint8_t* GetLevelData(uint32_t level) const;
+    size_t GetLevelSize(uint32_t level) const;
+
+    // Decode the block compressed payload into RGBA8 texels on the CPU. Used
+    // when the device cannot sample the format of the file.
+    bool CanTranscodeToRgba8() const;
+    void TranscodeToRgba8();
+};
+
+#endif  // KTX2_IMAGE_H
@@ -0,0 +1,56 @@
+/* Local header files */
+#include "ktx2_validation.hpp"
+#include "ktx2_image.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::sort
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+bool ValidateKtx2Files(const std::string& directory) {
+    // Sorted, so that the output is the same on every run
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".ktx2") {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    if (paths.empty()) {
+        std::cout << "FAIL no KTX2 files in " << directory << std::endl;
+        return false;
+    }
+
+    bool passed = true;
+    for (const std::filesystem::path& path : paths) {
+        std::string name = path.filename().string();
+        bool expect_invalid = name.rfind("invalid_", 0) == 0;
+
+        std::string error;
+        try {
+            Ktx2Image image = Ktx2Image::Load(path.string());
+            if (image.CanTranscodeToRgba8()) {
+                image.TranscodeToRgba8();
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        bool rejected = !error.empty();
+        if (rejected == expect_invalid) {
+            std::cout << "PASS " << name
+                      << (rejected ? ": rejected, " + error : ": loaded")
+                      << std::endl;
+        } else {
+            std::cout << "FAIL " << name
+                      << (rejected ? ": rejected, " + error
+                                   : ": loaded, but is invalid")
+                      << std::endl;
+            passed = false;
+        }
+    }
+    return passed;
+}
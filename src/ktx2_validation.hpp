@@ -0,0 +1,13 @@
+#ifndef KTX2_VALIDATION_H
+#define KTX2_VALIDATION_H
+
+/* Standard libraries */
+#include <string>
+
+/* Loads every KTX2 file in a directory, without a device. Files named
+"invalid_*.ktx2" must be rejected by Ktx2Image::Load, every other file must
+load and, if its format can be, transcode to RGBA8. Prints a line per file
+and returns whether all of them behaved as expected. */
+bool ValidateKtx2Files(const std::string& directory);
+
+#endif  // KTX2_VALIDATION_H
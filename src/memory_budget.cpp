@@ -0,0 +1,68 @@
+/* Local header files */
+#include "memory_budget.hpp"
+
+namespace {
+
+// Fills both structures, the budget only if the extension is enabled
+void QueryMemoryProperties(
+    VkPhysicalDevice physical_device, bool memory_budget_enabled,
+    VkPhysicalDeviceMemoryProperties2& properties,
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT& budget_properties) {
+    budget_properties = {};
+    budget_properties.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    if (memory_budget_enabled) {
+        properties.pNext = &budget_properties;
+    }
+    vkGetPhysicalDeviceMemoryProperties2(physical_device, &properties);
+}
+
+}  // namespace
+
+std::vector<MemoryHeapBudget> QueryMemoryBudget(
+    VkPhysicalDevice physical_device, bool memory_budget_enabled) {
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties{};
+    QueryMemoryProperties(physical_device, memory_budget_enabled, properties,
+                          budget_properties);
+
+    const VkPhysicalDeviceMemoryProperties& memory =
+        properties.memoryProperties;
+    std::vector<MemoryHeapBudget> heaps(memory.memoryHeapCount);
+    for (uint32_t i = 0; i < memory.memoryHeapCount; i++) {
+        heaps[i].size = memory.memoryHeaps[i].size;
+        heaps[i].device_local =
+            (memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) !=
+            0;
+
+        if (memory_budget_enabled) {
+            heaps[i].budget = budget_properties.heapBudget[i];
+            heaps[i].usage = budget_properties.heapUsage[i];
+        } else {
+            heaps[i].budget = heaps[i].size;
+        }
+    }
+    return heaps;
+}
+
+DeviceMemoryBudget QueryDeviceLocalBudget(VkPhysicalDevice physical_device) {
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties{};
+    QueryMemoryProperties(physical_device, true, properties,
+                          budget_properties);
+
+    DeviceMemoryBudget total;
+    const VkPhysicalDeviceMemoryProperties& memory =
+        properties.memoryProperties;
+    for (uint32_t i = 0; i < memory.memoryHeapCount; i++) {
+        if ((memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) !=
+            0) {
+            total.budget += budget_properties.heapBudget[i];
+            total.usage += budget_properties.heapUsage[i];
+        }
+    }
+    return total;
+}
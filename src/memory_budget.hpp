@@ -0,0 +1,38 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Standard libraries */
+#include <vector>
+
+// Size, budget and current usage of a memory heap in bytes
+struct MemoryHeapBudget {
+    VkDeviceSize size = 0;
+    VkDeviceSize budget = 0;
+    VkDeviceSize usage = 0;
+    bool device_local = false;
+};
+
+/* Reads the budget of every heap from VK_EXT_memory_budget. The budget is
+what the process can allocate without the driver paging memory out, and
+the usage includes the memory of every object of the process. Without the
+extension, the budget is the size of the heap and the usage is 0.
+
+Physical device queries need no synchronization, so any thread may call
+this. */
+std::vector<MemoryHeapBudget> QueryMemoryBudget(
+    VkPhysicalDevice physical_device, bool memory_budget_enabled);
+
+// Budget and usage summed over the device local heaps, in bytes
+struct DeviceMemoryBudget {
+    VkDeviceSize budget = 0;
+    VkDeviceSize usage = 0;
+};
+
+// Requires VK_EXT_memory_budget. Allocates nothing, so the render thread
+// can call it every frame.
+DeviceMemoryBudget QueryDeviceLocalBudget(VkPhysicalDevice physical_device);
+
+#endif  // MEMORY_BUDGET_H
@@ -0,0 +1,84 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+void TriangleApplication::UpdateMemoryPressure() {
+    // Without the extension, the usage of the device is unknown
+    if (!memory_budget_supported) {
+        return;
+    }
+
+    device_memory = QueryDeviceLocalBudget(physical_device);
+    if (device_memory.budget == 0) {
+        return;
+    }
+
+    auto budget = static_cast<double>(device_memory.budget);
+    auto usage = static_cast<double>(device_memory.usage);
+
+    /* Everything but the textures is taken as given, and the textures get
+    what is left below the target share. Their budget does not depend on
+    their own usage, so it settles instead of oscillating. While the
+    resolution is reduced, the textures leave room down to the relaxed
+    share, or they would take up the memory the resolution needs to come
+    back. */
+    auto texture_bytes =
+        static_cast<double>(texture_streamer.GetStats().allocated_bytes);
+    double other_bytes = std::max(usage - texture_bytes, 0.0);
+    double target_usage =
+        render_scale_index == 0 ? MEMORY_TARGET_USAGE : MEMORY_RELAXED_USAGE;
+    double texture_budget =
+        std::clamp(budget * target_usage - other_bytes, 0.0,
+                   static_cast<double>(TEXTURE_MEMORY_BUDGET));
+    texture_streamer.SetMemoryBudget(static_cast<VkDeviceSize>(texture_budget));
+
+    // Evicted mips are freed a few frames later, which the hysteresis waits
+    // out before the resolution drops
+    double usage_share = usage / budget;
+    memory_pressure_frames =
+        usage_share > MEMORY_CRITICAL_USAGE ? memory_pressure_frames + 1 : 0;
+    memory_headroom_frames =
+        usage_share < MEMORY_RELAXED_USAGE ? memory_headroom_frames + 1 : 0;
+
+    uint32_t scale_index = render_scale_index;
+    if (memory_pressure_frames >= RENDER_SCALE_HYSTERESIS_FRAMES &&
+        scale_index + 1 < RENDER_SCALES.size()) {
+        scale_index++;
+    } else if (memory_headroom_frames >= RENDER_SCALE_HYSTERESIS_FRAMES &&
+               scale_index > 0) {
+        scale_index--;
+    }
+
+    if (scale_index == render_scale_index) {
+        return;
+    }
+    render_scale_index = scale_index;
+    memory_pressure_frames = 0;
+    memory_headroom_frames = 0;
+
+    // The other frame in flight may still use the render targets. The
+    // composite pass scales the smaller image up to the swap chain.
+    vkDeviceWaitIdle(device);
+    DestroyPostProcessTarget(post_target);
+    CreatePostProcessTarget(post_target, GetRenderExtent(swap_chain_extent),
+                            "main");
+
+    // Windows are numbered from 1, the main window being the first
+    for (size_t i = 0; i < secondary_windows.size(); i++) {
+        SecondaryWindow& secondary = secondary_windows[i];
+        DestroyPostProcessTarget(secondary.post_target);
+        CreatePostProcessTarget(secondary.post_target,
+                                GetRenderExtent(secondary.extent),
+                                "window " + std::to_string(i + 2));
+    }
+}
+
+VkExtent2D TriangleApplication::GetRenderExtent(
+    VkExtent2D window_extent) const {
+    float scale = RENDER_SCALES[render_scale_index];
+    return {std::max(static_cast<uint32_t>(
+                         static_cast<float>(window_extent.width) * scale),
+                     1U),
+            std::max(static_cast<uint32_t>(
+                         static_cast<float>(window_extent.height) * scale),
+                     1U)};
+}
@@ -0,0 +1,426 @@
+/* Local header files */
+#include "metrics_exporter.hpp"
+#include "memory_budget.hpp"
+
+/* Standard libraries */
+#include <array>
+#include <cstdio>  // Required for std::rename
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>  // Required for std::move
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>  // Required for timeval
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Upper bounds of the histogram buckets in seconds. The frame times cover
+// refresh rates from 240 Hz down to long stalls.
+const std::vector<double> FRAME_TIME_BUCKETS = {
+    0.004, 0.008, 0.0125, 0.0167, 0.025, 0.0333, 0.05, 0.1, 0.25};
+const std::vector<double> GPU_TIME_BUCKETS = {
+    0.0005, 0.001, 0.002, 0.004, 0.008, 0.0125, 0.0167, 0.0333};
+
+// The exporter checks for connections and for Stop at this interval
+const std::chrono::milliseconds SOCKET_POLL_INTERVAL(100);
+
+// Time a connection has to send its request before it gets plain text
+const int REQUEST_TIMEOUT_MS = 100;
+
+// A reader that stops reading is dropped after this long, so it cannot hold
+// up the exporter thread and with it the file export
+const int SEND_TIMEOUT_MS = 1000;
+const int SOCKET_BACKLOG = 4;
+
+#ifdef MSG_NOSIGNAL
+// A reader that hangs up early must not kill the process with SIGPIPE
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+void WriteHeader(std::ostream& text, const std::string& name,
+                 const char* type, const char* help) {
+    text << "# HELP " << name << " " << help << "\n";
+    text << "# TYPE " << name << " " << type << "\n";
+}
+
+// Label values escape backslashes, quotes and line breaks
+std::string EscapeLabel(const std::string& value) {
+    std::string escaped;
+    for (char character : value) {
+        if (character == '\\' || character == '"') {
+            escaped += '\\';
+            escaped += character;
+        } else if (character == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += character;
+        }
+    }
+    return escaped;
+}
+
+}  // namespace
+
+MetricsExporter::Histogram::Histogram(std::vector<double> bounds)
+    : bounds(std::move(bounds)), counts(this->bounds.size() + 1, 0) {}
+
+void MetricsExporter::Histogram::Observe(double value) {
+    size_t bucket = 0;
+    while (bucket < bounds.size() && value > bounds[bucket]) {
+        bucket++;
+    }
+    counts[bucket]++;
+    sum += value;
+    count++;
+}
+
+MetricsExporter::MetricsExporter()
+    : frame_times(FRAME_TIME_BUCKETS), gpu_frame_times(GPU_TIME_BUCKETS) {}
+
+MetricsExporter::~MetricsExporter() {
+    Stop();
+}
+
+void MetricsExporter::Start(VkPhysicalDevice physical_device,
+                            bool memory_budget_enabled,
+                            const std::string& file_path,
+                            const std::string& socket_path,
+                            std::chrono::seconds interval) {
+    this->physical_device = physical_device;
+    this->memory_budget_enabled = memory_budget_enabled;
+    this->file_path = file_path;
+    this->socket_path = socket_path;
+    this->interval = interval;
+    start_time = std::chrono::duration<double>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+
+    if (!socket_path.empty()) {
+        OpenSocket();
+    }
+
+    stopping = false;
+    exporter = std::thread(&MetricsExporter::ExportLoop, this);
+}
+
+void MetricsExporter::Stop() {
+    if (!exporter.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_requested.notify_one();
+    exporter.join();
+
+    CloseSocket();
+}
+
+bool MetricsExporter::IsRunning() const {
+    return exporter.joinable();
+}
+
+void MetricsExporter::AddFrame(double frame_seconds) {
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+    frame_times.Observe(frame_seconds);
+}
+
+void MetricsExporter::AddGpuTimings(
+    const std::vector<GpuScopeTiming>& gpu_timings) {
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+    double gpu_seconds = 0.0;
+    for (const auto& timing : gpu_timings) {
+        double seconds = timing.milliseconds / 1000.0;
+        gpu_scope_seconds[timing.name] += seconds;
+        gpu_seconds += seconds;
+    }
+    gpu_frame_times.Observe(gpu_seconds);
+}
+
+void MetricsExporter::SetDroppedFrames(uint64_t count) {
+    dropped_frames.store(count, std::memory_order_relaxed);
+}
+
+void MetricsExporter::CountSwapChainRecreation() {
+    swap_chain_recreations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MetricsExporter::CountDeviceLost() {
+    devices_lost.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string MetricsExporter::Format() const {
+    // Copies of the values of the render thread, so it is held up as
+    // briefly as possible
+    std::unique_lock<std::mutex> lock(metrics_mutex);
+    Histogram frames = frame_times;
+    Histogram gpu_frames = gpu_frame_times;
+    std::map<std::string, double> scopes = gpu_scope_seconds;
+    lock.unlock();
+
+    std::ostringstream text;
+    text.precision(9);
+
+    WriteHeader(text, "vulkan_window_start_time_seconds", "gauge",
+                "Start of the metrics in seconds since the Unix epoch.");
+    text << "vulkan_window_start_time_seconds " << std::fixed << start_time
+         << std::defaultfloat << "\n";
+
+    // Buckets of a histogram are cumulative
+    auto write_histogram = [&](const std::string& name, const char* help,
+                               const Histogram& histogram) {
+        WriteHeader(text, name, "histogram", help);
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < histogram.bounds.size(); i++) {
+            cumulative += histogram.counts[i];
+            text << name << "_bucket{le=\"" << histogram.bounds[i] << "\"} "
+                 << cumulative << "\n";
+        }
+        text << name << "_bucket{le=\"+Inf\"} " << histogram.count << "\n";
+        text << name << "_sum " << histogram.sum << "\n";
+        text << name << "_count " << histogram.count << "\n";
+    };
+
+    write_histogram("vulkan_window_frame_time_seconds",
+                    "Time between the starts of consecutive frames.", frames);
+    write_histogram("vulkan_window_gpu_time_seconds",
+                    "GPU time of a frame, summed over the profiled passes.",
+                    gpu_frames);
+
+    WriteHeader(text, "vulkan_window_gpu_pass_seconds_total", "counter",
+                "GPU time spent in a profiled pass.");
+    for (const auto& scope : scopes) {
+        text << "vulkan_window_gpu_pass_seconds_total{pass=\""
+             << EscapeLabel(scope.first) << "\"} " << scope.second << "\n";
+    }
+
+    WriteHeader(text, "vulkan_window_dropped_frames_total", "counter",
+                "Refreshes of the display that showed no new frame.");
+    text << "vulkan_window_dropped_frames_total "
+         << dropped_frames.load(std::memory_order_relaxed) << "\n";
+
+    WriteHeader(text, "vulkan_window_swapchain_recreations_total", "counter",
+                "Swap chains recreated after a resize or an out of date "
+                "swap chain.");
+    text << "vulkan_window_swapchain_recreations_total "
+         << swap_chain_recreations.load(std::memory_order_relaxed) << "\n";
+
+    WriteHeader(text, "vulkan_window_devices_lost_total", "counter",
+                "Times the device was lost.");
+    text << "vulkan_window_devices_lost_total "
+         << devices_lost.load(std::memory_order_relaxed) << "\n";
+
+    /* Memory heaps, read from the driver now */
+    std::vector<MemoryHeapBudget> heaps =
+        QueryMemoryBudget(physical_device, memory_budget_enabled);
+    auto write_heaps = [&](const std::string& name, const char* help,
+                           VkDeviceSize MemoryHeapBudget::*value) {
+        WriteHeader(text, name, "gauge", help);
+        for (size_t i = 0; i < heaps.size(); i++) {
+            text << name << "{heap=\"" << i << "\",device_local=\""
+                 << (heaps[i].device_local ? "true" : "false") << "\"} "
+                 << heaps[i].*value << "\n";
+        }
+    };
+
+    write_heaps("vulkan_window_memory_heap_size_bytes",
+                "Size of a memory heap.", &MemoryHeapBudget::size);
+
+    // Without VK_EXT_memory_budget nothing is known beyond the size
+    if (memory_budget_enabled) {
+        write_heaps("vulkan_window_memory_heap_budget_bytes",
+                    "Memory of a heap the process can use without paging.",
+                    &MemoryHeapBudget::budget);
+        write_heaps("vulkan_window_memory_heap_usage_bytes",
+                    "Memory of a heap used by the process.",
+                    &MemoryHeapBudget::usage);
+    }
+
+    return text.str();
+}
+
+void MetricsExporter::ExportLoop() {
+    // The file is written right away, so it exists from the start
+    auto next_write = std::chrono::steady_clock::now();
+
+    while (!IsStopping()) {
+        auto now = std::chrono::steady_clock::now();
+        if (!file_path.empty() && now >= next_write) {
+            WriteFile();
+            next_write = now + interval;
+        }
+
+        if (listen_socket >= 0) {
+            // Returns at the poll interval to write the file and to notice
+            // a stop
+            ServeConnection(SOCKET_POLL_INTERVAL);
+        } else {
+            std::unique_lock<std::mutex> lock(stop_mutex);
+            stop_requested.wait_until(lock, next_write,
+                                      [this] { return stopping; });
+        }
+    }
+
+    // Final values of the run
+    if (!file_path.empty()) {
+        WriteFile();
+    }
+}
+
+bool MetricsExporter::IsStopping() {
+    std::lock_guard<std::mutex> lock(stop_mutex);
+    return stopping;
+}
+
+void MetricsExporter::WriteFile() const {
+    // Readers only ever see a complete file
+    std::string temporary_path = file_path + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        file << Format();
+        if (!file) {
+            std::cerr << "failed to write metrics file: " << temporary_path
+                      << "!" << std::endl;
+            return;
+        }
+    }
+
+#ifdef _WIN32
+    // Rename does not replace an existing file on Windows
+    std::remove(file_path.c_str());
+#endif
+    if (std::rename(temporary_path.c_str(), file_path.c_str()) != 0) {
+        std::cerr << "failed to replace metrics file: " << file_path << "!"
+                  << std::endl;
+    }
+}
+
+#ifdef _WIN32
+
+void MetricsExporter::OpenSocket() {
+    throw std::runtime_error("metrics sockets are not supported on Windows!");
+}
+
+void MetricsExporter::CloseSocket() {}
+
+void MetricsExporter::ServeConnection(
+    std::chrono::milliseconds /*timeout*/) const {}
+
+#else
+
+void MetricsExporter::OpenSocket() {
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("metrics socket path is too long: " +
+                                 socket_path + "!");
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    // A socket left behind by an earlier run would fail the bind, anything
+    // else at the path is left alone
+    struct stat status {};
+    if (lstat(socket_path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(socket_path.c_str());
+    }
+
+    listen_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_socket < 0 ||
+        bind(listen_socket, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) != 0 ||
+        listen(listen_socket, SOCKET_BACKLOG) != 0) {
+        if (listen_socket >= 0) {
+            close(listen_socket);
+            listen_socket = -1;
+        }
+        throw std::runtime_error("failed to open metrics socket: " +
+                                 socket_path + "!");
+    }
+}
+
+void MetricsExporter::CloseSocket() {
+    if (listen_socket < 0) {
+        return;
+    }
+    close(listen_socket);
+    listen_socket = -1;
+    unlink(socket_path.c_str());
+}
+
+void MetricsExporter::ServeConnection(std::chrono::milliseconds timeout) const {
+    pollfd listen_poll{};
+    listen_poll.fd = listen_socket;
+    listen_poll.events = POLLIN;
+    if (poll(&listen_poll, 1, static_cast<int>(timeout.count())) <= 0) {
+        return;
+    }
+
+    int connection = accept(listen_socket, nullptr, nullptr);
+    if (connection < 0) {
+        return;
+    }
+
+    // Bounds every recv and send on the connection
+    timeval receive_timeout{0, REQUEST_TIMEOUT_MS * 1000};
+    timeval send_timeout{SEND_TIMEOUT_MS / 1000,
+                         (SEND_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout,
+               sizeof(receive_timeout));
+    setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &send_timeout,
+               sizeof(send_timeout));
+#ifdef SO_NOSIGPIPE
+    // macOS has no MSG_NOSIGNAL, the socket itself is kept from raising
+    // SIGPIPE instead
+    int no_sigpipe = 1;
+    setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe,
+               sizeof(no_sigpipe));
+#endif
+
+    // Scrapers send an HTTP request first, tools such as socat may send
+    // nothing at all
+    std::string request;
+    pollfd connection_poll{};
+    connection_poll.fd = connection;
+    connection_poll.events = POLLIN;
+    if (poll(&connection_poll, 1, REQUEST_TIMEOUT_MS) > 0) {
+        std::array<char, 1024> buffer{};
+        ssize_t length = recv(connection, buffer.data(), buffer.size(), 0);
+        if (length > 0) {
+            request.assign(buffer.data(), static_cast<size_t>(length));
+        }
+    }
+
+    std::string response = Format();
+    if (request.compare(0, 4, "GET ") == 0) {
+        response =
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " +
+            std::to_string(response.size()) + "\r\n\r\n" + response;
+    }
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t length = send(connection, response.data() + sent,
+                              response.size() - sent, SEND_FLAGS);
+        if (length <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(length);
+    }
+    close(connection);
+}
+
+#endif  // _WIN32
@@ -0,0 +1,117 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "gpu_profiler.hpp"
+
+/* Standard libraries */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>  // Required for uint64_t
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Seconds between two writes of the metrics file, unless set on the
+// command line
+const uint32_t DEFAULT_METRICS_INTERVAL = 15;
+
+/* Aggregates metrics of a long running instance and exports them in the
+text format of Prometheus. The render thread adds every frame, which only
+takes a short lock, and a background thread does the exporting:
+
+- A file is rewritten at a fixed interval. The text is written to a
+temporary file first and renamed, so a reader such as the textfile
+collector of the node exporter never sees a partial file.
+- A Unix socket answers every connection with the current metrics, as an
+HTTP response if the connection sends a GET request and as plain text
+otherwise.
+
+Memory budgets are read when the metrics are exported, so they cost the
+render thread nothing. */
+class MetricsExporter {
+   private:
+    // Cumulative histogram with fixed upper bounds in seconds
+    struct Histogram {
+        std::vector<double> bounds;
+
+        // Observations per bucket, the last one counts those above every
+        // bound
+        std::vector<uint64_t> counts;
+        double sum = 0.0;
+        uint64_t count = 0;
+
+        explicit Histogram(std::vector<double> bounds);
+        void Observe(double value);
+    };
+
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    bool memory_budget_enabled = false;
+    std::string file_path;
+    std::string socket_path;
+    std::chrono::seconds interval{DEFAULT_METRICS_INTERVAL};
+    double start_time = 0.0;
+
+    // Guards the values added by the render thread
+    mutable std::mutex metrics_mutex;
+    Histogram frame_times;
+    Histogram gpu_frame_times;
+    std::map<std::string, double> gpu_scope_seconds;
+
+    std::atomic<uint64_t> dropped_frames{0};
+    std::atomic<uint64_t> swap_chain_recreations{0};
+    std::atomic<uint64_t> devices_lost{0};
+
+    std::thread exporter;
+    std::mutex stop_mutex;
+    std::condition_variable stop_requested;
+    bool stopping = false;
+
+    // Listening socket, -1 without one
+    int listen_socket = -1;
+
+    void ExportLoop();
+    bool IsStopping();
+    void WriteFile() const;
+    void OpenSocket();
+    void CloseSocket();
+
+    // Waits up to the timeout for a connection and answers it
+    void ServeConnection(std::chrono::milliseconds timeout) const;
+
+   public:
+    MetricsExporter();
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+    ~MetricsExporter();
+
+    // Either path may be empty. Throws if the socket cannot be opened.
+    void Start(VkPhysicalDevice physical_device, bool memory_budget_enabled,
+               const std::string& file_path, const std::string& socket_path,
+               std::chrono::seconds interval);
+
+    // Writes the file a last time and removes the socket
+    void Stop();
+    bool IsRunning() const;
+
+    // Called by the render thread with the time since the previous frame,
+    // and with the GPU timings of every frame the profiler collected
+    void AddFrame(double frame_seconds);
+    void AddGpuTimings(const std::vector<GpuScopeTiming>& gpu_timings);
+
+    // Running totals, taken over as they are
+    void SetDroppedFrames(uint64_t count);
+    void CountSwapChainRecreation();
+    void CountDeviceLost();
+
+    // Current metrics in the Prometheus text format
+    std::string Format() const;
+};
+
+#endif  // METRICS_EXPORTER_H
@@ -0,0 +1,138 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+void TriangleApplication::RunMipBenchmark() {
+    /* Generate the full mip chain of RGBA8 images of increasing size with
+    both paths of the mip generator and print the average GPU time of each.
+    The same image is used for both paths, so they write the same number of
+    texels. */
+    if (!gpu_profiler.IsEnabled()) {
+        throw std::runtime_error(
+            "timestamps are not supported by the graphics queue!");
+    }
+
+    bool compute_supported =
+        mip_generator.SupportsCompute(MIP_BENCHMARK_FORMAT);
+
+    VkQueryPoolCreateInfo query_pool_info{};
+    query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = 2;
+
+    VkQueryPool query_pool = VK_NULL_HANDLE;
+    if (vkCreateQueryPool(device, &query_pool_info, nullptr, &query_pool) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    std::cout << "size       levels  compute (ms)  blit (ms)" << std::endl;
+
+    for (uint32_t size : MIP_BENCHMARK_SIZES) {
+        VkExtent2D extent = {size, size};
+        uint32_t level_count = MipGenerator::GetMipLevelCount(extent);
+        bool compute_timed =
+            compute_supported && MipGenerator::FitsCompute(extent);
+
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory image_memory = VK_NULL_HANDLE;
+        CreateImage(VK_IMAGE_TYPE_2D, {size, size, 1}, level_count,
+                    MIP_BENCHMARK_FORMAT,
+                    mip_generator.GetRequiredUsage(MIP_BENCHMARK_FORMAT),
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, image_memory);
+
+        // The first run of each path is a warm up and is not measured
+        double compute_ms = 0.0;
+        double blit_ms = 0.0;
+        for (uint32_t i = 0; i <= MIP_BENCHMARK_ITERATIONS; i++) {
+            double compute_run = 0.0;
+            if (compute_timed) {
+                compute_run = TimeMipGeneration(query_pool, image, extent,
+                                                level_count, true);
+            }
+            double blit_run = TimeMipGeneration(query_pool, image, extent,
+                                                level_count, false);
+
+            if (i > 0) {
+                compute_ms += compute_run;
+                blit_ms += blit_run;
+            }
+        }
+
+        std::ostringstream row;
+        row << size << "x" << size;
+        std::cout << std::left << std::setw(11) << row.str() << std::setw(8)
+                  << level_count << std::setw(14);
+        if (compute_timed) {
+            std::cout << std::fixed << std::setprecision(3)
+                      << compute_ms / MIP_BENCHMARK_ITERATIONS;
+        } else {
+            std::cout << "n/a";
+        }
+        std::cout << std::fixed << std::setprecision(3)
+                  << blit_ms / MIP_BENCHMARK_ITERATIONS << std::endl;
+
+        vkDestroyImage(device, image, nullptr);
+        vkFreeMemory(device, image_memory, nullptr);
+    }
+
+    vkDestroyQueryPool(device, query_pool, nullptr);
+}
+
+double TriangleApplication::TimeMipGeneration(VkQueryPool query_pool,
+                                              VkImage image, VkExtent2D extent,
+                                              uint32_t level_count,
+                                              bool use_compute) {
+    // The descriptor sets and views of the previous run are no longer in use
+    // since every run waits for the queue to become idle
+    descriptor_allocator.BeginFrame(0);
+    mip_generator.BeginFrame(0);
+
+    VkCommandBuffer command_buffer = BeginSingleTimeCommands();
+
+    // Level 0 is filled by a transfer, just like a streamed texture
+    TransitionImageLayout(command_buffer, image, VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, level_count);
+
+    VkClearColorValue clear_color = {{0.25F, 0.5F, 0.75F, 1.0F}};
+
+    VkImageSubresourceRange range{};
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.baseMipLevel = 0;
+    range.levelCount = 1;
+    range.baseArrayLayer = 0;
+    range.layerCount = 1;
+
+    vkCmdClearColorImage(command_buffer, image,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear_color, 1,
+                         &range);
+
+    // The first timestamp is written once the clear has completed
+    vkCmdResetQueryPool(command_buffer, query_pool, 0, 2);
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        query_pool, 0);
+
+    if (use_compute) {
+        mip_generator.GenerateWithCompute(command_buffer, image,
+                                          MIP_BENCHMARK_FORMAT, extent,
+                                          level_count);
+    } else {
+        MipGenerator::GenerateWithBlit(command_buffer, image, extent,
+                                       level_count);
+    }
+
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        query_pool, 1);
+
+    EndSingleTimeCommands(command_buffer);
+
+    std::array<uint64_t, 2> timestamps{};
+    vkGetQueryPoolResults(device, query_pool, 0, 2, sizeof(timestamps),
+                          timestamps.data(), sizeof(uint64_t),
+                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+    return static_cast<double>(timestamps[1] - timestamps[0]) *
+           static_cast<double>(properties.limits.timestampPeriod) / 1000000.0;
+}
@@ -0,0 +1,548 @@
+/* Local header files */
+#include "mip_generator.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::max
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Levels below level 0 the compute shader can write. Each of its two phases
+// reduces a 64x64 tile to a single texel.
+const uint32_t MAX_COMPUTE_MIP_LEVELS = 12;
+const uint32_t COMPUTE_TILE_SIZE = 64;
+
+// Number of compute dispatches a single frame can record
+const uint32_t MAX_DISPATCHES_PER_FRAME = 8;
+
+// Push constants of the downsampler
+struct MipPushConstants {
+    uint32_t mip_count = 0;
+    uint32_t work_group_count = 0;
+};
+
+VkImageMemoryBarrier LevelBarrier(VkImage image, uint32_t base_level,
+                                  uint32_t level_count,
+                                  VkImageLayout old_layout,
+                                  VkImageLayout new_layout,
+                                  VkAccessFlags src_access,
+                                  VkAccessFlags dst_access) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcAccessMask = src_access;
+    barrier.dstAccessMask = dst_access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = base_level;
+    barrier.subresourceRange.levelCount = level_count;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    return barrier;
+}
+
+int32_t MipSize(uint32_t size, uint32_t level) {
+    return static_cast<int32_t>(std::max(size >> level, 1U));
+}
+
+}  // namespace
+
+void MipGenerator::Init(VkPhysicalDevice physical_device, VkDevice device,
+                        VkShaderModule shader_module,
+                        DescriptorAllocator* descriptor_allocator,
+                        uint32_t frames_in_flight) {
+    this->physical_device = physical_device;
+    this->device = device;
+    this->descriptor_allocator = descriptor_allocator;
+
+    /* The compute path needs quad operations in compute shaders and dynamic
+    indexing into the array of storage images of the levels */
+    VkPhysicalDeviceSubgroupProperties subgroup_properties{};
+    subgroup_properties.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &subgroup_properties;
+    vkGetPhysicalDeviceProperties2(physical_device, &properties);
+
+    VkPhysicalDeviceFeatures features{};
+    vkGetPhysicalDeviceFeatures(physical_device, &features);
+
+    compute_supported =
+        subgroup_properties.subgroupSize >= 4 &&
+        (subgroup_properties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+        (subgroup_properties.supportedOperations &
+         VK_SUBGROUP_FEATURE_QUAD_BIT) &&
+        features.shaderStorageImageArrayDynamicIndexing;
+
+    if (!compute_supported) {
+        return;
+    }
+
+    /* Binding 0: level 0, read through a linear sampler
+    Binding 1: the levels below level 0 as storage images
+    Binding 2: the atomic counter of the dispatch */
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = MAX_COMPUTE_MIP_LEVELS;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    layout_info.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr,
+                                    &descriptor_set_layout) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create mip generator descriptor set layout!");
+    }
+
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(MipPushConstants);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr,
+                               &pipeline_layout) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create mip generator pipeline layout!");
+    }
+
+    VkComputePipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_info.stage.module = shader_module;
+    pipeline_info.stage.pName = "main";
+    pipeline_info.layout = pipeline_layout;
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeline_info,
+                                 nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mip generator pipeline!");
+    }
+
+    // Level 0 is sampled at the corner shared by four texels, so bilinear
+    // filtering averages them with a single fetch
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_LINEAR;
+    sampler_info.minFilter = VK_FILTER_LINEAR;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &sampler) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create mip generator sampler!");
+    }
+
+    // Counters are bound with an offset, which has to respect the minimum
+    // storage buffer alignment
+    counter_stride = std::max<VkDeviceSize>(
+        sizeof(uint32_t),
+        properties.properties.limits.minStorageBufferOffsetAlignment);
+
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size =
+        counter_stride * MAX_DISPATCHES_PER_FRAME * frames_in_flight;
+    buffer_info.usage =
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &buffer_info, nullptr, &counter_buffer) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create mip counter buffer!");
+    }
+
+    VkMemoryRequirements mem_requirements{};
+    vkGetBufferMemoryRequirements(device, counter_buffer, &mem_requirements);
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex = FindMemoryType(
+        mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (vkAllocateMemory(device, &alloc_info, nullptr,
+                         &counter_buffer_memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate mip counter memory!");
+    }
+
+    vkBindBufferMemory(device, counter_buffer, counter_buffer_memory, 0);
+
+    frames.resize(frames_in_flight);
+}
+
+void MipGenerator::Destroy() {
+    for (auto& frame : frames) {
+        for (VkImageView view : frame.image_views) {
+            vkDestroyImageView(device, view, nullptr);
+        }
+    }
+    frames.clear();
+
+    if (!compute_supported) {
+        return;
+    }
+
+    vkDestroyBuffer(device, counter_buffer, nullptr);
+    vkFreeMemory(device, counter_buffer_memory, nullptr);
+    vkDestroySampler(device, sampler, nullptr);
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device, descriptor_set_layout, nullptr);
+}
+
+uint32_t MipGenerator::GetMipLevelCount(VkExtent2D extent) {
+    return static_cast<uint32_t>(std::floor(
+               std::log2(std::max(extent.width, extent.height)))) +
+           1;
+}
+
+bool MipGenerator::SupportsCompute(VkFormat format) const {
+    // The shader declares its storage images as rgba8
+    if (!compute_supported || format != VK_FORMAT_R8G8B8A8_UNORM) {
+        return false;
+    }
+
+    VkFormatProperties format_properties{};
+    vkGetPhysicalDeviceFormatProperties(physical_device, format,
+                                        &format_properties);
+    return (format_properties.optimalTilingFeatures &
+            VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+}
+
+bool MipGenerator::FitsCompute(VkExtent2D extent) {
+    // The last work group reduces one tile of level 6, which has to hold the
+    // whole level. Larger levels would be left partly unwritten.
+    return std::max(extent.width, extent.height) <=
+           COMPUTE_TILE_SIZE * COMPUTE_TILE_SIZE;
+}
+
+bool MipGenerator::CanGenerate(VkFormat format) const {
+    if (SupportsCompute(format)) {
+        return true;
+    }
+
+    // Blitting with a linear filter needs these features of the format
+    VkFormatProperties format_properties{};
+    vkGetPhysicalDeviceFormatProperties(physical_device, format,
+                                        &format_properties);
+
+    VkFormatFeatureFlags blit_features =
+        VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (format_properties.optimalTilingFeatures & blit_features) ==
+           blit_features;
+}
+
+VkImageUsageFlags MipGenerator::GetRequiredUsage(VkFormat format) const {
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                              VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                              VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (SupportsCompute(format)) {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+    return usage;
+}
+
+void MipGenerator::BeginFrame(uint32_t frame) {
+    current_frame = frame;
+    if (frames.empty()) {
+        return;
+    }
+
+    FrameResources& resources = frames[frame];
+    for (VkImageView view : resources.image_views) {
+        vkDestroyImageView(device, view, nullptr);
+    }
+    resources.image_views.clear();
+    resources.dispatch_count = 0;
+}
+
+void MipGenerator::Generate(VkCommandBuffer command_buffer, VkImage image,
+                            VkFormat format, VkExtent2D extent,
+                            uint32_t level_count) {
+    if (level_count <= 1) {
+        // There is nothing to generate, only hand level 0 to the shaders
+        VkImageMemoryBarrier barrier = LevelBarrier(
+            image, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+        return;
+    }
+
+    if (SupportsCompute(format) && FitsCompute(extent) &&
+        level_count - 1 <= MAX_COMPUTE_MIP_LEVELS &&
+        frames[current_frame].dispatch_count < MAX_DISPATCHES_PER_FRAME) {
+        GenerateWithCompute(command_buffer, image, format, extent, level_count);
+    } else {
+        GenerateWithBlit(command_buffer, image, extent, level_count);
+    }
+}
+
+void MipGenerator::GenerateWithCompute(VkCommandBuffer command_buffer,
+                                       VkImage image, VkFormat format,
+                                       VkExtent2D extent,
+                                       uint32_t level_count) {
+    if (!FitsCompute(extent)) {
+        throw std::runtime_error("image is too large for compute mips!");
+    }
+
+    FrameResources& resources = frames[current_frame];
+    if (resources.dispatch_count >= MAX_DISPATCHES_PER_FRAME) {
+        throw std::runtime_error("too many mip generation dispatches!");
+    }
+
+    VkDeviceSize counter_offset =
+        counter_stride *
+        (current_frame * MAX_DISPATCHES_PER_FRAME + resources.dispatch_count);
+    resources.dispatch_count++;
+
+    VkDescriptorSet descriptor_set =
+        descriptor_allocator->Allocate(descriptor_set_layout);
+
+    // Every element of the storage image array has to be valid, so the
+    // elements past the last level repeat it. The shader never writes them.
+    VkDescriptorImageInfo source_info{};
+    source_info.sampler = sampler;
+    source_info.imageView = CreateLevelView(image, format, 0);
+    source_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    resources.image_views.push_back(source_info.imageView);
+
+    std::array<VkDescriptorImageInfo, MAX_COMPUTE_MIP_LEVELS> level_infos{};
+    for (uint32_t i = 0; i < MAX_COMPUTE_MIP_LEVELS; i++) {
+        if (i + 1 < level_count) {
+            level_infos[i].imageView = CreateLevelView(image, format, i + 1);
+            level_infos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            resources.image_views.push_back(level_infos[i].imageView);
+        } else {
+            level_infos[i] = level_infos[i - 1];
+        }
+    }
+
+    VkDescriptorBufferInfo counter_info{};
+    counter_info.buffer = counter_buffer;
+    counter_info.offset = counter_offset;
+    counter_info.range = sizeof(uint32_t);
+
+    std::array<VkWriteDescriptorSet, 3> writes{};
+    for (auto& write : writes) {
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = descriptor_set;
+        write.dstArrayElement = 0;
+        write.descriptorCount = 1;
+    }
+
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].pImageInfo = &source_info;
+
+    writes[1].dstBinding = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[1].descriptorCount = MAX_COMPUTE_MIP_LEVELS;
+    writes[1].pImageInfo = level_infos.data();
+
+    writes[2].dstBinding = 2;
+    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[2].pBufferInfo = &counter_info;
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()),
+                           writes.data(), 0, nullptr);
+
+    // The counter starts at zero for every dispatch
+    vkCmdFillBuffer(command_buffer, counter_buffer, counter_offset,
+                    sizeof(uint32_t), 0);
+
+    VkBufferMemoryBarrier counter_barrier{};
+    counter_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    counter_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    counter_barrier.dstAccessMask =
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    counter_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    counter_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    counter_barrier.buffer = counter_buffer;
+    counter_barrier.offset = counter_offset;
+    counter_barrier.size = sizeof(uint32_t);
+
+    // Level 0 is sampled while the other levels are written as storage
+    // images
+    std::array<VkImageMemoryBarrier, 2> barriers = {
+        LevelBarrier(image, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT),
+        LevelBarrier(image, 1, level_count - 1, VK_IMAGE_LAYOUT_UNDEFINED,
+                     VK_IMAGE_LAYOUT_GENERAL, 0,
+                     VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT)};
+
+    // Earlier frames may still sample the lower levels, e.g. when a texture
+    // regenerates its chain after growing back to level 0
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1,
+                         &counter_barrier,
+                         static_cast<uint32_t>(barriers.size()),
+                         barriers.data());
+
+    MipPushConstants push_constants;
+    push_constants.mip_count = level_count - 1;
+
+    uint32_t group_count_x =
+        (extent.width + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE;
+    uint32_t group_count_y =
+        (extent.height + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE;
+    push_constants.work_group_count = group_count_x * group_count_y;
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+    vkCmdPushConstants(command_buffer, pipeline_layout,
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push_constants),
+                       &push_constants);
+    vkCmdDispatch(command_buffer, group_count_x, group_count_y, 1);
+
+    VkImageMemoryBarrier barrier =
+        LevelBarrier(image, 1, level_count - 1, VK_IMAGE_LAYOUT_GENERAL,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void MipGenerator::GenerateWithBlit(VkCommandBuffer command_buffer,
+                                    VkImage image, VkExtent2D extent,
+                                    uint32_t level_count) {
+    /* Every level is blitted from the previous one, which has to be
+    transitioned into a transfer source first. This needs a barrier per
+    level. */
+    for (uint32_t level = 1; level < level_count; level++) {
+        std::array<VkImageMemoryBarrier, 2> barriers = {
+            LevelBarrier(image, level - 1, 1,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_ACCESS_TRANSFER_READ_BIT),
+            LevelBarrier(image, level, 1, VK_IMAGE_LAYOUT_UNDEFINED,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                         VK_ACCESS_TRANSFER_WRITE_BIT)};
+
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT |
+                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                             nullptr, static_cast<uint32_t>(barriers.size()),
+                             barriers.data());
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {MipSize(extent.width, level - 1),
+                              MipSize(extent.height, level - 1), 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {MipSize(extent.width, level),
+                              MipSize(extent.height, level), 1};
+        blit.dstSubresource = blit.srcSubresource;
+        blit.dstSubresource.mipLevel = level;
+
+        vkCmdBlitImage(command_buffer, image,
+                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                       VK_FILTER_LINEAR);
+    }
+
+    // Hand every level to the shaders
+    std::array<VkImageMemoryBarrier, 2> barriers = {
+        LevelBarrier(image, 0, level_count - 1,
+                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT),
+        LevelBarrier(image, level_count - 1, 1,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT)};
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr,
+                         static_cast<uint32_t>(barriers.size()),
+                         barriers.data());
+}
+
+uint32_t MipGenerator::FindMemoryType(uint32_t type_filter,
+                                      VkMemoryPropertyFlags properties) {
+    VkPhysicalDeviceMemoryProperties mem_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
+
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++) {
+        if ((type_filter & (1U << i)) &&
+            (mem_properties.memoryTypes[i].propertyFlags & properties) ==
+                properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+VkImageView MipGenerator::CreateLevelView(VkImage image, VkFormat format,
+                                          uint32_t level) {
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = format;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view_info.subresourceRange.baseMipLevel = level;
+    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+
+    VkImageView image_view = VK_NULL_HANDLE;
+    if (vkCreateImageView(device, &view_info, nullptr, &image_view) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create mip level view!");
+    }
+
+    return image_view;
+}
@@ -0,0 +1,96 @@
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "descriptor_allocator.hpp"
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <vector>
+
+/* Generates the mip chain of an image on the GPU.
+
+The compute path is a single-pass downsampler: one dispatch reduces every
+64x64 tile of level 0 down to a single texel of level 6 using subgroup quad
+operations and shared memory. The last work group to finish then reduces
+level 6 down to level 12 in the same dispatch, so no barrier between levels
+is needed. That group reduces a single tile, so level 0 can be at most 4096
+texels on its largest side.
+
+The blit path is the classic chain of vkCmdBlitImage calls with a barrier
+per level. It is used for formats the compute shader cannot write, e.g.
+sRGB formats, and serves as the reference for benchmarking.
+
+Both paths expect level 0 in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL right after
+it has been written by a transfer and the other levels in an undefined
+layout. Afterwards every level is in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+*/
+class MipGenerator {
+   private:
+    // Image views used by the dispatches of a frame. Their descriptor sets
+    // come from the pools of the frame slot in the allocator.
+    struct FrameResources {
+        std::vector<VkImageView> image_views;
+        uint32_t dispatch_count = 0;
+    };
+
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    DescriptorAllocator* descriptor_allocator = nullptr;
+    bool compute_supported = false;
+
+    VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+    VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    // Atomic counters that let the last work group of a dispatch detect that
+    // all other work groups are done. Every dispatch of a frame uses its own
+    // counter.
+    VkBuffer counter_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory counter_buffer_memory = VK_NULL_HANDLE;
+    VkDeviceSize counter_stride = 0;
+
+    std::vector<FrameResources> frames;
+    uint32_t current_frame = 0;
+
+    uint32_t FindMemoryType(uint32_t type_filter,
+                            VkMemoryPropertyFlags properties);
+    VkImageView CreateLevelView(VkImage image, VkFormat format, uint32_t level);
+
+   public:
+    void Init(VkPhysicalDevice physical_device, VkDevice device,
+              VkShaderModule shader_module,
+              DescriptorAllocator* descriptor_allocator,
+              uint32_t frames_in_flight);
+    void Destroy();
+
+    // Number of levels of a full mip chain
+    static uint32_t GetMipLevelCount(VkExtent2D extent);
+
+    bool SupportsCompute(VkFormat format) const;
+
+    // Whether the compute path writes every texel of the mip chain
+    static bool FitsCompute(VkExtent2D extent);
+    bool CanGenerate(VkFormat format) const;
+    VkImageUsageFlags GetRequiredUsage(VkFormat format) const;
+
+    // Release the resources of the dispatches recorded the last time the
+    // frame slot was used. Must be called after its fence has signaled, along
+    // with BeginFrame of the descriptor allocator.
+    void BeginFrame(uint32_t frame);
+
+    // Picks the compute path whenever the format and size allow it
+    void Generate(VkCommandBuffer command_buffer, VkImage image,
+                  VkFormat format, VkExtent2D extent, uint32_t level_count);
+    void GenerateWithCompute(VkCommandBuffer command_buffer, VkImage image,
+                             VkFormat format, VkExtent2D extent,
+                             uint32_t level_count);
+    static void GenerateWithBlit(VkCommandBuffer command_buffer, VkImage image,
+                                 VkExtent2D extent, uint32_t level_count);
+};
+
+#endif  // MIP_GENERATOR_H
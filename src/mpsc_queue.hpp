@@ -0,0 +1,97 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+/* Standard libraries */
+#include <array>
+#include <atomic>
+#include <cstddef>  // Required for size_t
+#include <cstdint>  // Required for intptr_t
+
+/* Bounded queue between any number of producer threads and one consumer
+thread, without locks. Every slot carries a sequence number telling whose
+turn it is: a producer claims the tail by a compare and swap and publishes
+the item by advancing the sequence of its slot, and the consumer hands the
+slot back to the producers one lap ahead. A producer that is preempted
+between the two steps only holds up the consumer, never the other
+producers. The capacity has to be a power of two. */
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0,
+                  "capacity must be a power of two");
+
+   private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T item{};
+    };
+
+    std::array<Slot, Capacity> slots;
+
+    // Kept on separate cache lines, so the consumer does not invalidate the
+    // line the producers compete for
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+   public:
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Producer side, safe to call from several threads. False if the queue
+    // is full, in which case the item is not added.
+    bool Push(const T& item) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+
+        while (true) {
+            slot = &slots[position & (Capacity - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) -
+                                  static_cast<intptr_t>(position);
+
+            if (difference == 0) {
+                // The slot is free, claim it unless another producer was
+                // faster, which updates the position
+                if (tail.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // The consumer has not taken the item of the previous lap
+                return false;
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->item = item;
+
+        // Publishes the item to the consumer
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. False if the queue is empty or the next item is still
+    // being written.
+    bool Pop(T& item) {
+        size_t position = head.load(std::memory_order_relaxed);
+        Slot& slot = slots[position & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+
+        item = slot.item;
+
+        // Hands the slot to the producers of the next lap
+        slot.sequence.store(position + Capacity, std::memory_order_release);
+        head.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+#endif  // MPSC_QUEUE_H
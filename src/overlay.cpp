@@ -0,0 +1,430 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+namespace {
+
+// Window pixels per pixel of a glyph, and the space around the overlay and
+// around its contents
+const float OVERLAY_SCALE = 2.0F;
+const float OVERLAY_MARGIN = 8.0F;
+const float OVERLAY_PADDING = 6.0F;
+
+// Size of the frame time graph below the text
+const float GRAPH_BAR_WIDTH = 2.0F;
+const float GRAPH_HEIGHT = 48.0F;
+
+const uint32_t BACKGROUND_COLOR = PackOverlayColor(0, 0, 0, 176);
+const uint32_t TEXT_COLOR = PackOverlayColor(255, 255, 255, 255);
+const uint32_t TARGET_LINE_COLOR = PackOverlayColor(255, 255, 255, 128);
+
+// Frames within the refresh interval, up to twice of it and beyond
+const uint32_t ON_TIME_COLOR = PackOverlayColor(64, 255, 64, 255);
+const uint32_t SLOW_COLOR = PackOverlayColor(255, 208, 64, 255);
+const uint32_t MISSED_COLOR = PackOverlayColor(255, 80, 80, 255);
+
+std::string FormatMilliseconds(double milliseconds) {
+    std::ostringstream text;
+    text.setf(std::ios::fixed);
+    text.precision(2);
+    text << milliseconds;
+    return text.str();
+}
+
+}  // namespace
+
+void TriangleApplication::InitPerfOverlay() {
+    overlay_visible = options.show_overlay;
+
+    /* Glyph atlas, uploaded once through a staging buffer */
+    std::vector<uint8_t> atlas = BuildOverlayAtlas();
+    const VkExtent3D atlas_extent = {OVERLAY_ATLAS_COLUMNS * OVERLAY_CELL_SIZE,
+                                     OVERLAY_ATLAS_ROWS * OVERLAY_CELL_SIZE,
+                                     1};
+
+    VkBuffer staging_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory staging_buffer_memory = VK_NULL_HANDLE;
+    CreateBuffer(atlas.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 staging_buffer, staging_buffer_memory);
+
+    void* data = nullptr;
+    vkMapMemory(device, staging_buffer_memory, 0, atlas.size(), 0, &data);
+    std::memcpy(data, atlas.data(), atlas.size());
+    vkUnmapMemory(device, staging_buffer_memory);
+
+    CreateImage(VK_IMAGE_TYPE_2D, atlas_extent, 1, VK_FORMAT_R8_UNORM,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, overlay_atlas_image,
+                overlay_atlas_image_memory);
+    debug_markers.SetName(overlay_atlas_image, "overlay glyph atlas");
+    debug_markers.SetName(overlay_atlas_image_memory,
+                          "overlay glyph atlas memory");
+
+    VkCommandBuffer command_buffer = BeginSingleTimeCommands();
+    TransitionImageLayout(command_buffer, overlay_atlas_image,
+                          VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
+    CopyBufferToImage(command_buffer, staging_buffer, overlay_atlas_image,
+                      atlas_extent, 0);
+    TransitionImageLayout(command_buffer, overlay_atlas_image,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
+    EndSingleTimeCommands(command_buffer);
+
+    vkDestroyBuffer(device, staging_buffer, nullptr);
+    vkFreeMemory(device, staging_buffer_memory, nullptr);
+
+    overlay_atlas_image_view =
+        CreateImageView(overlay_atlas_image, VK_IMAGE_VIEW_TYPE_2D,
+                        VK_FORMAT_R8_UNORM, 0, 1);
+    debug_markers.SetName(overlay_atlas_image_view,
+                          "overlay glyph atlas view");
+
+    // Glyphs are scaled by whole numbers, so they are sampled unfiltered
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_NEAREST;
+    sampler_info.minFilter = VK_FILTER_NEAREST;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.maxLod = 0.0F;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &overlay_sampler) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create overlay sampler!");
+    }
+    debug_markers.SetName(overlay_sampler, "overlay sampler");
+
+    /* Quad ring. The CPU writes the slice of a frame slot once its fence
+    has signaled, and the slice is bound with a dynamic offset, which has to
+    respect the minimum storage buffer alignment. */
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    VkDeviceSize alignment = std::max<VkDeviceSize>(
+        1, properties.limits.minStorageBufferOffsetAlignment);
+    overlay_slice_size =
+        (sizeof(OverlayQuad) * OVERLAY_MAX_QUADS + alignment - 1) /
+        alignment * alignment;
+
+    CreateBuffer(overlay_slice_size * MAX_FRAMES_IN_FLIGHT,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 overlay_quad_buffer, overlay_quad_buffer_memory);
+    debug_markers.SetName(overlay_quad_buffer, "overlay quad ring");
+    debug_markers.SetName(overlay_quad_buffer_memory,
+                          "overlay quad ring memory");
+
+    // Stays mapped until the buffer is destroyed
+    vkMapMemory(device, overlay_quad_buffer_memory, 0, VK_WHOLE_SIZE, 0,
+                &overlay_quad_data);
+
+    /* Binding 0: the glyph atlas
+    Binding 1: the quads of the frame, at a dynamic offset */
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    layout_info.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr,
+                                    &overlay_descriptor_set_layout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create overlay descriptor set layout!");
+    }
+    debug_markers.SetName(overlay_descriptor_set_layout,
+                          "overlay descriptor set layout");
+
+    std::array<VkDescriptorPoolSize, 2> pool_sizes{};
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_sizes[0].descriptorCount = 1;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    pool_sizes[1].descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
+    pool_info.maxSets = 1;
+
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr,
+                               &overlay_descriptor_pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create overlay descriptor pool!");
+    }
+    debug_markers.SetName(overlay_descriptor_pool, "overlay descriptor pool");
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = overlay_descriptor_pool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &overlay_descriptor_set_layout;
+
+    if (vkAllocateDescriptorSets(device, &alloc_info,
+                                 &overlay_descriptor_set) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate overlay descriptor set!");
+    }
+    debug_markers.SetName(overlay_descriptor_set, "overlay descriptor set");
+
+    VkDescriptorImageInfo image_info{};
+    image_info.sampler = overlay_sampler;
+    image_info.imageView = overlay_atlas_image_view;
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkDescriptorBufferInfo buffer_info{};
+    buffer_info.buffer = overlay_quad_buffer;
+    buffer_info.offset = 0;
+    buffer_info.range = overlay_slice_size;
+
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = overlay_descriptor_set;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorCount = 1;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].pImageInfo = &image_info;
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = overlay_descriptor_set;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorCount = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    writes[1].pBufferInfo = &buffer_info;
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()),
+                           writes.data(), 0, nullptr);
+
+    // The scale from pixels to normalized device coordinates
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(std::array<float, 2>);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &overlay_descriptor_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr,
+                               &overlay_pipeline_layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create overlay pipeline layout!");
+    }
+    debug_markers.SetName(overlay_pipeline_layout, "overlay pipeline layout");
+
+    // Blended over the composited image
+    overlay_pipeline = CreateVertexlessPipeline(
+        "shaders/overlay_vert.spv", "shaders/overlay_frag.spv",
+        overlay_pipeline_layout, composite_render_pass, OVERLAY_RASTER_STATE);
+}
+
+void TriangleApplication::CleanupPerfOverlay() {
+    vkDestroyPipeline(device, overlay_pipeline, nullptr);
+    vkDestroyPipelineLayout(device, overlay_pipeline_layout, nullptr);
+    vkDestroyDescriptorPool(device, overlay_descriptor_pool, nullptr);
+    vkDestroyDescriptorSetLayout(device, overlay_descriptor_set_layout,
+                                 nullptr);
+
+    vkUnmapMemory(device, overlay_quad_buffer_memory);
+    vkDestroyBuffer(device, overlay_quad_buffer, nullptr);
+    vkFreeMemory(device, overlay_quad_buffer_memory, nullptr);
+
+    vkDestroySampler(device, overlay_sampler, nullptr);
+    vkDestroyImageView(device, overlay_atlas_image_view, nullptr);
+    vkDestroyImage(device, overlay_atlas_image, nullptr);
+    vkFreeMemory(device, overlay_atlas_image_memory, nullptr);
+}
+
+double TriangleApplication::AddFrameTime(
+    std::chrono::steady_clock::time_point frame_start) {
+    // A frame lasts until the next one starts
+    double milliseconds =
+        std::chrono::duration<double, std::milli>(frame_start -
+                                                  last_frame_start)
+            .count();
+    last_frame_start = frame_start;
+
+    frame_time_history[frame_time_index] = static_cast<float>(milliseconds);
+    frame_time_index = (frame_time_index + 1) % OVERLAY_GRAPH_FRAMES;
+
+    cpu_timing_sums.frame += milliseconds;
+    cpu_timing_frames++;
+    return milliseconds;
+}
+
+void TriangleApplication::UpdatePerfOverlay() {
+    overlay_quad_count = 0;
+    if (!overlay_visible) {
+        return;
+    }
+
+    if (std::chrono::steady_clock::now() - last_overlay_text_update >=
+        OVERLAY_TEXT_INTERVAL) {
+        UpdatePerfOverlayText();
+    }
+
+    // The fence of the frame slot has signaled, so the GPU is done reading
+    // its slice
+    auto* quads = reinterpret_cast<OverlayQuad*>(
+        static_cast<char*>(overlay_quad_data) +
+        current_frame * overlay_slice_size);
+    OverlayBuilder builder(quads, OVERLAY_MAX_QUADS, OVERLAY_SCALE);
+
+    // The background goes first, sized to the text and the graph
+    const float line_height = builder.GetLineHeight();
+    const float graph_width = OVERLAY_GRAPH_FRAMES * GRAPH_BAR_WIDTH;
+    float content_width = graph_width;
+    for (const std::string& line : overlay_lines) {
+        content_width =
+            std::max(content_width, static_cast<float>(line.size()) *
+                                        builder.GetCharWidth());
+    }
+    float content_height =
+        static_cast<float>(overlay_lines.size()) * line_height + GRAPH_HEIGHT;
+    builder.AddRect(OVERLAY_MARGIN, OVERLAY_MARGIN,
+                    content_width + 2.0F * OVERLAY_PADDING,
+                    content_height + 2.0F * OVERLAY_PADDING,
+                    BACKGROUND_COLOR);
+
+    const float x = OVERLAY_MARGIN + OVERLAY_PADDING;
+    float y = OVERLAY_MARGIN + OVERLAY_PADDING;
+    for (const std::string& line : overlay_lines) {
+        builder.AddText(x, y, line, TEXT_COLOR);
+        y += line_height;
+    }
+
+    /* Frame time graph with the oldest frame on the left, colored by how
+    the frame compares to the refresh interval of the display */
+    const float target =
+        display_refresh_rate > 0.0
+            ? static_cast<float>(1000.0 / display_refresh_rate)
+            : 1000.0F / 60.0F;
+    const float graph_bottom = y + GRAPH_HEIGHT;
+    for (uint32_t i = 0; i < OVERLAY_GRAPH_FRAMES; i++) {
+        float milliseconds =
+            frame_time_history[(frame_time_index + i) % OVERLAY_GRAPH_FRAMES];
+        float height =
+            std::min(milliseconds / OVERLAY_GRAPH_MAX_MS, 1.0F) * GRAPH_HEIGHT;
+        if (height <= 0.0F) {
+            continue;
+        }
+
+        uint32_t color = milliseconds <= target * 1.05F ? ON_TIME_COLOR
+                         : milliseconds <= target * 2.0F ? SLOW_COLOR
+                                                         : MISSED_COLOR;
+        float bar_x = x + static_cast<float>(i) * GRAPH_BAR_WIDTH;
+        builder.AddRect(bar_x, graph_bottom - height, GRAPH_BAR_WIDTH, height,
+                        color);
+    }
+
+    float target_height =
+        std::min(target / OVERLAY_GRAPH_MAX_MS, 1.0F) * GRAPH_HEIGHT;
+    builder.AddRect(x, graph_bottom - target_height, graph_width, 1.0F,
+                    TARGET_LINE_COLOR);
+
+    overlay_quad_count = builder.GetCount();
+}
+
+void TriangleApplication::UpdatePerfOverlayText() {
+    last_overlay_text_update = std::chrono::steady_clock::now();
+    overlay_lines.clear();
+
+    // Averages of the CPU phases since the last update
+    if (cpu_timing_frames > 0) {
+        const CpuFrameTimings& sums = cpu_timing_sums;
+        double frames = cpu_timing_frames;
+        double frame_time = sums.frame / frames;
+
+        std::ostringstream frame_line;
+        frame_line << "frame " << FormatMilliseconds(frame_time) << " ms";
+        if (frame_time > 0.0) {
+            frame_line << "  " << std::lround(1000.0 / frame_time) << " fps";
+        }
+        overlay_lines.push_back(frame_line.str());
+
+        overlay_lines.push_back(
+            "cpu wait " + FormatMilliseconds(sums.wait / frames) + " acq " +
+            FormatMilliseconds(sums.acquire / frames) + " rec " +
+            FormatMilliseconds(sums.record / frames) + " sub " +
+            FormatMilliseconds(sums.submit / frames) + " pres " +
+            FormatMilliseconds(sums.present / frames));
+    }
+    cpu_timing_sums = {};
+    cpu_timing_frames = 0;
+
+    // GPU passes of the last collected frame
+    double gpu_total = 0.0;
+    for (const auto& timing : gpu_profiler.GetResults()) {
+        std::ostringstream line;
+        line << "gpu " << std::left << std::setw(15) << timing.name
+             << FormatMilliseconds(timing.milliseconds) << " ms";
+        overlay_lines.push_back(line.str());
+        gpu_total += timing.milliseconds;
+    }
+    overlay_lines.push_back("gpu total " + FormatMilliseconds(gpu_total) +
+                            " ms");
+
+    TextureStreamerStats stats = texture_streamer.GetStats();
+    overlay_lines.push_back("textures " +
+                            std::to_string(stats.allocated_bytes >> 20) +
+                            "/" + std::to_string(stats.budget_bytes >> 20) +
+                            " mib  mips " +
+                            std::to_string(stats.resident_levels) + "/" +
+                            std::to_string(stats.total_levels));
+
+    // Device local memory of the whole process
+    if (memory_budget_supported) {
+        overlay_lines.push_back(
+            "vram " + std::to_string(device_memory.usage >> 20) + "/" +
+            std::to_string(device_memory.budget >> 20) + " mib  scale " +
+            std::to_string(std::lround(RENDER_SCALES[render_scale_index] *
+                                       100.0F)) +
+            "%");
+    }
+
+    overlay_lines.push_back(
+        "draws " + std::to_string(last_draw_counts.draws) + "  dispatches " +
+        std::to_string(last_draw_counts.dispatches));
+}
+
+void TriangleApplication::RecordPerfOverlay(VkCommandBuffer command_buffer,
+                                            VkExtent2D extent) {
+    if (overlay_quad_count == 0) {
+        return;
+    }
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      overlay_pipeline);
+    extended_dynamic_state.CmdSetState(command_buffer, OVERLAY_RASTER_STATE);
+
+    auto slice_offset =
+        static_cast<uint32_t>(current_frame * overlay_slice_size);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            overlay_pipeline_layout, 0, 1,
+                            &overlay_descriptor_set, 1, &slice_offset);
+
+    std::array<float, 2> pixel_to_ndc = {
+        2.0F / static_cast<float>(extent.width),
+        2.0F / static_cast<float>(extent.height)};
+    vkCmdPushConstants(command_buffer, overlay_pipeline_layout,
+                       VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pixel_to_ndc),
+                       pixel_to_ndc.data());
+
+    // Every quad is an instance of the same six vertices
+    vkCmdDraw(command_buffer, 6, overlay_quad_count, 0, 0);
+    draw_counts.draws++;
+}
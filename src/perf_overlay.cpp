@@ -0,0 +1,183 @@
+/* Local header files */
+#include "perf_overlay.hpp"
+
+/* Standard libraries */
+#include <array>
+#include <cctype>   // Required for std::toupper
+#include <cstddef>  // Required for size_t
+
+namespace {
+
+// First character of the atlas and the number of characters in it
+const char FIRST_GLYPH_CHAR = ' ';
+const uint32_t GLYPH_COUNT = 64;
+
+// Rows of a glyph from the top, the leftmost pixel in bit 4
+using Glyph = std::array<uint8_t, OVERLAY_GLYPH_HEIGHT>;
+
+const std::array<Glyph, GLYPH_COUNT> FONT = {{
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},  // space
+    {{0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04}},  // !
+    {{0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00}},  // "
+    {{0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A}},  // #
+    {{0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04}},  // $
+    {{0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}},  // %
+    {{0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D}},  // &
+    {{0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00}},  // '
+    {{0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}},  // (
+    {{0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}},  // )
+    {{0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00}},  // *
+    {{0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}},  // +
+    {{0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}},  // ,
+    {{0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},  // -
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}},  // .
+    {{0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},  // /
+    {{0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},  // 0
+    {{0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},  // 1
+    {{0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},  // 2
+    {{0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},  // 3
+    {{0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},  // 4
+    {{0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},  // 5
+    {{0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},  // 6
+    {{0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},  // 7
+    {{0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},  // 8
+    {{0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},  // 9
+    {{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},  // :
+    {{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08}},  // ;
+    {{0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}},  // <
+    {{0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}},  // =
+    {{0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}},  // >
+    {{0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}},  // ?
+    {{0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E}},  // @
+    {{0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}},  // A
+    {{0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},  // B
+    {{0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},  // C
+    {{0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},  // D
+    {{0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},  // E
+    {{0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},  // F
+    {{0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},  // G
+    {{0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},  // H
+    {{0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},  // I
+    {{0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},  // J
+    {{0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},  // K
+    {{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},  // L
+    {{0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},  // M
+    {{0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},  // N
+    {{0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},  // O
+    {{0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},  // P
+    {{0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},  // Q
+    {{0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},  // R
+    {{0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},  // S
+    {{0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},  // T
+    {{0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},  // U
+    {{0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},  // V
+    {{0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},  // W
+    {{0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},  // X
+    {{0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}},  // Y
+    {{0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},  // Z
+    {{0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E}},  // [
+    {{0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00}},  // backslash
+    {{0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E}},  // ]
+    {{0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00}},  // ^
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}},  // _
+}};
+
+// Pixels of a glyph between characters and between lines
+const uint32_t CHAR_SPACING = 1;
+const uint32_t LINE_SPACING = 3;
+
+}  // namespace
+
+uint32_t PackOverlayColor(uint8_t red, uint8_t green, uint8_t blue,
+                          uint8_t alpha) {
+    return static_cast<uint32_t>(red) | (static_cast<uint32_t>(green) << 8) |
+           (static_cast<uint32_t>(blue) << 16) |
+           (static_cast<uint32_t>(alpha) << 24);
+}
+
+std::vector<uint8_t> BuildOverlayAtlas() {
+    const uint32_t width = OVERLAY_ATLAS_COLUMNS * OVERLAY_CELL_SIZE;
+    const uint32_t height = OVERLAY_ATLAS_ROWS * OVERLAY_CELL_SIZE;
+    std::vector<uint8_t> texels(static_cast<size_t>(width) * height, 0);
+
+    auto cell_origin = [&](uint32_t glyph) {
+        uint32_t x = (glyph % OVERLAY_ATLAS_COLUMNS) * OVERLAY_CELL_SIZE;
+        uint32_t y = (glyph / OVERLAY_ATLAS_COLUMNS) * OVERLAY_CELL_SIZE;
+        return static_cast<size_t>(y) * width + x;
+    };
+
+    for (uint32_t glyph = 0; glyph < GLYPH_COUNT; glyph++) {
+        size_t origin = cell_origin(glyph);
+        for (uint32_t y = 0; y < OVERLAY_GLYPH_HEIGHT; y++) {
+            for (uint32_t x = 0; x < OVERLAY_GLYPH_WIDTH; x++) {
+                uint32_t bit = OVERLAY_GLYPH_WIDTH - 1 - x;
+                texels[origin + y * width + x] =
+                    ((FONT[glyph][y] >> bit) & 1U) != 0 ? 255 : 0;
+            }
+        }
+    }
+
+    // Rectangles are drawn with the solid cell
+    size_t origin = cell_origin(OVERLAY_SOLID_GLYPH);
+    for (uint32_t y = 0; y < OVERLAY_CELL_SIZE; y++) {
+        for (uint32_t x = 0; x < OVERLAY_CELL_SIZE; x++) {
+            texels[origin + y * width + x] = 255;
+        }
+    }
+
+    return texels;
+}
+
+OverlayBuilder::OverlayBuilder(OverlayQuad* quads, uint32_t capacity,
+                               float scale)
+    : quads(quads), capacity(capacity), scale(scale) {}
+
+void OverlayBuilder::AddRect(float x, float y, float width, float height,
+                             uint32_t color) {
+    if (count == capacity) {
+        return;
+    }
+
+    OverlayQuad& quad = quads[count++];
+    quad.x = x;
+    quad.y = y;
+    quad.width = width;
+    quad.height = height;
+    quad.glyph = OVERLAY_SOLID_GLYPH;
+    quad.color = color;
+}
+
+float OverlayBuilder::AddText(float x, float y, const std::string& text,
+                              uint32_t color) {
+    float advance = GetCharWidth();
+    for (size_t i = 0; i < text.size() && count < capacity; i++) {
+        int character = std::toupper(static_cast<unsigned char>(text[i]));
+        uint32_t glyph = static_cast<uint32_t>(character - FIRST_GLYPH_CHAR);
+
+        // Spaces take no quad
+        if (character <= FIRST_GLYPH_CHAR || glyph >= GLYPH_COUNT) {
+            continue;
+        }
+
+        OverlayQuad& quad = quads[count++];
+        quad.x = x + static_cast<float>(i) * advance;
+        quad.y = y;
+        quad.width = OVERLAY_GLYPH_WIDTH * scale;
+        quad.height = OVERLAY_GLYPH_HEIGHT * scale;
+        quad.glyph = glyph;
+        quad.color = color;
+    }
+    return static_cast<float>(text.size()) * advance;
+}
+
+float OverlayBuilder::GetCharWidth() const {
+    return static_cast<float>(OVERLAY_GLYPH_WIDTH + CHAR_SPACING) * scale;
+}
+
+float OverlayBuilder::GetLineHeight() const {
+    return static_cast<float>(OVERLAY_GLYPH_HEIGHT + LINE_SPACING) * scale;
+}
+
+uint32_t OverlayBuilder::GetCount() const {
+    return count;
+}
@@ -0,0 +1,65 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+#include <vector>
+
+/* Layout of the glyph atlas, which overlay.vert repeats. Every glyph is 5x7
+pixels in the top left corner of an 8x8 cell. The printable ASCII
+characters from the space to the underscore fill the first four rows, and
+the first cell of the last row is solid for rectangles. */
+const uint32_t OVERLAY_ATLAS_COLUMNS = 16;
+const uint32_t OVERLAY_ATLAS_ROWS = 5;
+const uint32_t OVERLAY_CELL_SIZE = 8;
+const uint32_t OVERLAY_GLYPH_WIDTH = 5;
+const uint32_t OVERLAY_GLYPH_HEIGHT = 7;
+const uint32_t OVERLAY_SOLID_GLYPH = 64;
+
+// Rectangle of the overlay in pixels from the top left corner of the
+// window. Matches the quads read by overlay.vert.
+struct OverlayQuad {
+    float x = 0.0F;
+    float y = 0.0F;
+    float width = 0.0F;
+    float height = 0.0F;
+    uint32_t glyph = OVERLAY_SOLID_GLYPH;
+
+    // 8 bits per channel with red in the lowest byte, see PackOverlayColor
+    uint32_t color = 0;
+};
+
+uint32_t PackOverlayColor(uint8_t red, uint8_t green, uint8_t blue,
+                          uint8_t alpha);
+
+// Coverage of the glyph atlas, one byte per texel in rows from the top
+std::vector<uint8_t> BuildOverlayAtlas();
+
+/* Writes the text and rectangles of the overlay as quads into a mapped
+buffer. Quads beyond the capacity are dropped, so an overlay that does not
+fit is cut off instead of overflowing the buffer. */
+class OverlayBuilder {
+   private:
+    OverlayQuad* quads;
+    uint32_t capacity;
+    uint32_t count = 0;
+
+    // Pixels of the window per pixel of a glyph
+    float scale;
+
+   public:
+    OverlayBuilder(OverlayQuad* quads, uint32_t capacity, float scale);
+
+    void AddRect(float x, float y, float width, float height, uint32_t color);
+
+    // Lowercase letters are drawn as capitals and characters missing from
+    // the atlas as spaces. Returns the width of the text in pixels.
+    float AddText(float x, float y, const std::string& text, uint32_t color);
+
+    float GetCharWidth() const;
+    float GetLineHeight() const;
+    uint32_t GetCount() const;
+};
+
+#endif  // PERF_OVERLAY_H
@@ -0,0 +1,805 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+namespace {
+
+// Names of the post-processing stages as shown by the GPU profiler
+const std::array<const char*, POST_STAGE_COUNT> POST_STAGE_NAMES = {
+    "bloom downsample", "bloom upsample", "tone map", "color grade"};
+
+// Work group size of every post-processing compute shader
+const uint32_t POST_WORK_GROUP_SIZE = 8;
+
+// Brightness above which pixels contribute to bloom
+const float BLOOM_THRESHOLD = 1.0F;
+
+// Radius of the tent filter used while upsampling the bloom pyramid
+const float BLOOM_FILTER_RADIUS = 1.0F;
+
+// How much of the bloom pyramid is added on top of the scene color
+const float BLOOM_STRENGTH = 0.04F;
+
+const float EXPOSURE = 1.0F;
+
+uint32_t DispatchSize(uint32_t size) {
+    // Round up so that partially covered work groups are dispatched as well
+    return (size + POST_WORK_GROUP_SIZE - 1) / POST_WORK_GROUP_SIZE;
+}
+
+VkExtent2D MipExtent(VkExtent2D extent, uint32_t mip_level) {
+    return {std::max(extent.width >> mip_level, 1U),
+            std::max(extent.height >> mip_level, 1U)};
+}
+
+VkExtent2D BloomExtent(VkExtent2D extent) {
+    // The bloom pyramid starts at half the resolution of the render target
+    return MipExtent(extent, 1);
+}
+
+uint32_t BloomMipLevels(VkExtent2D extent) {
+    VkExtent2D bloom_extent = BloomExtent(extent);
+    auto levels = static_cast<uint32_t>(std::floor(std::log2(
+                      std::min(bloom_extent.width, bloom_extent.height)))) +
+                  1;
+    return std::clamp(levels, 1U, MAX_BLOOM_MIP_LEVELS);
+}
+
+// Storage image writes of the post-processing dispatches
+const SyncScope COMPUTE_WRITES = {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR,
+                                  VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR};
+
+// What the next dispatch does with the images of the chain: sample the
+// previous result and load and store its own
+const SyncScope COMPUTE_ACCESSES = {
+    VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR,
+    VK_ACCESS_2_SHADER_SAMPLED_READ_BIT_KHR |
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT_KHR |
+        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR};
+
+}  // namespace
+
+void TriangleApplication::CreateCompositeRenderPass() {
+    /* The composite render pass draws the post-processed image into the swap
+    chain image with a fullscreen triangle. */
+    VkAttachmentDescription color_attachment{};
+    color_attachment.format = swap_chain_image_format;
+    color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    // Every pixel is overwritten by the fullscreen triangle, so the previous
+    // contents of the swap chain image do not have to be loaded or cleared
+    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // Offscreen images are only ever read back, never presented
+    composite_final_layout = options.headless
+                                 ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                 : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    color_attachment.finalLayout = composite_final_layout;
+
+    VkAttachmentReference color_attachment_ref{};
+    color_attachment_ref.attachment = 0;
+    color_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &color_attachment_ref;
+
+    // Wait for the swap chain to finish reading from the image before the
+    // layout transition writes to it
+    VkSubpassDependency dependency{};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask = 0;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    // Order the final layout transition before the color attachment stage of
+    // later commands, so a frame capture recorded after the render pass can
+    // chain its barrier onto it
+    VkSubpassDependency capture_dependency{};
+    capture_dependency.srcSubpass = 0;
+    capture_dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    capture_dependency.srcStageMask =
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    capture_dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    capture_dependency.dstStageMask =
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    capture_dependency.dstAccessMask = 0;
+
+    std::array<VkSubpassDependency, 2> dependencies = {dependency,
+                                                       capture_dependency};
+
+    VkRenderPassCreateInfo render_pass_info{};
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    render_pass_info.attachmentCount = 1;
+    render_pass_info.pAttachments = &color_attachment;
+    render_pass_info.subpassCount = 1;
+    render_pass_info.pSubpasses = &subpass;
+    render_pass_info.dependencyCount =
+        static_cast<uint32_t>(dependencies.size());
+    render_pass_info.pDependencies = dependencies.data();
+
+    if (vkCreateRenderPass(device, &render_pass_info, nullptr,
+                           &composite_render_pass) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create composite render pass!");
+    }
+    debug_markers.SetName(composite_render_pass, "composite render pass");
+}
+
+void TriangleApplication::CreatePostProcessingPipelines() {
+    /* Every post-processing stage uses the same descriptor set layout:
+    - binding 0: image that is read by the stage
+    - binding 1: storage image that is written by the stage
+    - binding 2: auxiliary image (bloom pyramid or color grading LUT)
+    */
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags =
+        VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    layout_info.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr,
+                                    &post_descriptor_set_layout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create post-processing descriptor set layout!");
+    }
+    debug_markers.SetName(post_descriptor_set_layout,
+                          "post-processing set layout");
+
+    // The parameters of each stage are passed as push constants
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(PostPushConstants);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &post_descriptor_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr,
+                               &post_pipeline_layout) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create post-processing pipeline layout!");
+    }
+    debug_markers.SetName(post_pipeline_layout,
+                          "post-processing pipeline layout");
+
+    post_pipelines[POST_STAGE_BLOOM_DOWNSAMPLE] = CreateComputePipeline(
+        "shaders/bloom_downsample.spv", post_pipeline_layout);
+    post_pipelines[POST_STAGE_BLOOM_UPSAMPLE] = CreateComputePipeline(
+        "shaders/bloom_upsample.spv", post_pipeline_layout);
+    post_pipelines[POST_STAGE_TONE_MAP] =
+        CreateComputePipeline("shaders/tone_map.spv", post_pipeline_layout);
+    post_pipelines[POST_STAGE_COLOR_GRADE] =
+        CreateComputePipeline("shaders/color_grade.spv", post_pipeline_layout);
+
+    // Bilinear filtering with clamped addressing is used to read every image
+    // of the chain
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_LINEAR;
+    sampler_info.minFilter = VK_FILTER_LINEAR;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.maxLod = 0.0F;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &post_sampler) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create post-processing sampler!");
+    }
+    debug_markers.SetName(post_sampler, "post-processing sampler");
+}
+
+VkPipeline TriangleApplication::CreateComputePipeline(
+    const std::string& filename, VkPipelineLayout layout) {
+    auto shader_code = ReadFile(filename);
+    VkShaderModule shader_module = CreateShaderModule(shader_code);
+
+    VkPipelineShaderStageCreateInfo shader_stage_info{};
+    shader_stage_info.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stage_info.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shader_stage_info.module = shader_module;
+    shader_stage_info.pName = "main";
+
+    // A compute pipeline only consists of a single shader stage and a layout
+    VkComputePipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage = shader_stage_info;
+    pipeline_info.layout = layout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeline_info,
+                                 nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute pipeline: " +
+                                 filename + "!");
+    }
+    debug_markers.SetName(pipeline, filename);
+
+    vkDestroyShaderModule(device, shader_module, nullptr);
+
+    return pipeline;
+}
+
+void TriangleApplication::CreateCompositePipeline() {
+    // The vertex shader generates a fullscreen triangle from gl_VertexIndex
+    composite_pipeline =
+        CreateVertexlessPipeline("shaders/fullscreen.spv",
+                                 "shaders/composite.spv", post_pipeline_layout,
+                                 composite_render_pass, QUAD_RASTER_STATE);
+}
+
+void TriangleApplication::CreateColorGradingLut() {
+    /* The color grading LUT maps a tone mapped color to its graded color.
+    It is initialized to the identity mapping, which leaves the image
+    unchanged until a grading is authored. */
+    const uint32_t size = COLOR_GRADING_LUT_SIZE;
+    const VkDeviceSize image_size =
+        static_cast<VkDeviceSize>(size) * size * size * 4;
+
+    // Fill a host visible staging buffer with the texels of the LUT
+    VkBuffer staging_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory staging_buffer_memory = VK_NULL_HANDLE;
+    CreateBuffer(image_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 staging_buffer, staging_buffer_memory);
+
+    void* data = nullptr;
+    vkMapMemory(device, staging_buffer_memory, 0, image_size, 0, &data);
+
+    auto* texels = static_cast<uint8_t*>(data);
+    for (uint32_t b = 0; b < size; b++) {
+        for (uint32_t g = 0; g < size; g++) {
+            for (uint32_t r = 0; r < size; r++) {
+                size_t offset =
+                    ((static_cast<size_t>(b) * size + g) * size + r) * 4;
+                texels[offset + 0] = static_cast<uint8_t>(r * 255 / (size - 1));
+                texels[offset + 1] = static_cast<uint8_t>(g * 255 / (size - 1));
+                texels[offset + 2] = static_cast<uint8_t>(b * 255 / (size - 1));
+                texels[offset + 3] = 255;
+            }
+        }
+    }
+
+    vkUnmapMemory(device, staging_buffer_memory);
+
+    CreateImage(VK_IMAGE_TYPE_3D, {size, size, size}, 1,
+                VK_FORMAT_R8G8B8A8_UNORM,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, color_grading_lut_image,
+                color_grading_lut_image_memory);
+    debug_markers.SetName(color_grading_lut_image, "color grading lut");
+    debug_markers.SetName(color_grading_lut_image_memory,
+                          "color grading lut memory");
+
+    // Copy the staging buffer to the LUT and prepare it for shader access
+    VkCommandBuffer command_buffer = BeginSingleTimeCommands();
+    TransitionImageLayout(command_buffer, color_grading_lut_image,
+                          VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
+    CopyBufferToImage(command_buffer, staging_buffer, color_grading_lut_image,
+                      {size, size, size}, 0);
+    TransitionImageLayout(command_buffer, color_grading_lut_image,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
+    EndSingleTimeCommands(command_buffer);
+
+    vkDestroyBuffer(device, staging_buffer, nullptr);
+    vkFreeMemory(device, staging_buffer_memory, nullptr);
+
+    color_grading_lut_image_view =
+        CreateImageView(color_grading_lut_image, VK_IMAGE_VIEW_TYPE_3D,
+                        VK_FORMAT_R8G8B8A8_UNORM, 0, 1);
+    debug_markers.SetName(color_grading_lut_image_view,
+                          "color grading lut view");
+}
+
+void TriangleApplication::CreatePostProcessTarget(PostProcessTarget& target,
+                                                  VkExtent2D extent,
+                                                  const std::string& name) {
+    target.extent = extent;
+
+    /* HDR scene color */
+    CreateImage(VK_IMAGE_TYPE_2D, {extent.width, extent.height, 1}, 1,
+                HDR_FORMAT,
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                    VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, target.hdr_image,
+                target.hdr_image_memory);
+    target.hdr_image_view = CreateImageView(
+        target.hdr_image, VK_IMAGE_VIEW_TYPE_2D, HDR_FORMAT, 0, 1);
+    debug_markers.SetName(target.hdr_image, name + " hdr image");
+    debug_markers.SetName(target.hdr_image_memory, name + " hdr image memory");
+    debug_markers.SetName(target.hdr_image_view, name + " hdr image view");
+
+    VkFramebufferCreateInfo framebuffer_info{};
+    framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebuffer_info.renderPass = render_pass;
+    framebuffer_info.attachmentCount = 1;
+    framebuffer_info.pAttachments = &target.hdr_image_view;
+    framebuffer_info.width = extent.width;
+    framebuffer_info.height = extent.height;
+    framebuffer_info.layers = 1;
+
+    if (vkCreateFramebuffer(device, &framebuffer_info, nullptr,
+                            &target.scene_framebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create scene framebuffer!");
+    }
+    debug_markers.SetName(target.scene_framebuffer,
+                          name + " scene framebuffer");
+
+    /* Bloom pyramid */
+    VkExtent2D bloom_extent = BloomExtent(extent);
+    uint32_t bloom_mip_levels = BloomMipLevels(extent);
+
+    CreateImage(VK_IMAGE_TYPE_2D, {bloom_extent.width, bloom_extent.height, 1},
+                bloom_mip_levels, HDR_FORMAT,
+                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, target.bloom_image,
+                target.bloom_image_memory);
+
+    // Every mip level gets its own view, so that one level can be sampled
+    // while the next one is written
+    target.bloom_mip_views.resize(bloom_mip_levels);
+    for (uint32_t i = 0; i < bloom_mip_levels; i++) {
+        target.bloom_mip_views[i] = CreateImageView(
+            target.bloom_image, VK_IMAGE_VIEW_TYPE_2D, HDR_FORMAT, i, 1);
+        debug_markers.SetName(target.bloom_mip_views[i],
+                              name + " bloom mip " + std::to_string(i));
+    }
+    debug_markers.SetName(target.bloom_image, name + " bloom image");
+    debug_markers.SetName(target.bloom_image_memory,
+                          name + " bloom image memory");
+
+    /* Tone mapped result */
+    CreateImage(VK_IMAGE_TYPE_2D, {extent.width, extent.height, 1}, 1,
+                LDR_FORMAT,
+                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, target.ldr_image,
+                target.ldr_image_memory);
+    target.ldr_image_view = CreateImageView(
+        target.ldr_image, VK_IMAGE_VIEW_TYPE_2D, LDR_FORMAT, 0, 1);
+    debug_markers.SetName(target.ldr_image, name + " ldr image");
+    debug_markers.SetName(target.ldr_image_memory, name + " ldr image memory");
+    debug_markers.SetName(target.ldr_image_view, name + " ldr image view");
+
+    // Storage images stay in the general layout for their whole lifetime
+    VkCommandBuffer command_buffer = BeginSingleTimeCommands();
+    BarrierBatch barriers;
+    AddLayoutTransition(barriers, target.bloom_image, VK_IMAGE_LAYOUT_UNDEFINED,
+                        VK_IMAGE_LAYOUT_GENERAL, bloom_mip_levels);
+    AddLayoutTransition(barriers, target.ldr_image, VK_IMAGE_LAYOUT_UNDEFINED,
+                        VK_IMAGE_LAYOUT_GENERAL, 1);
+    barriers.Flush(command_buffer, synchronization2);
+    EndSingleTimeCommands(command_buffer);
+
+    /* Descriptor sets */
+    // One set per bloom downsample and upsample dispatch plus the tone map,
+    // color grade and the two composite sets
+    uint32_t set_count = bloom_mip_levels * 2 - 1 + 4;
+
+    std::array<VkDescriptorPoolSize, 2> pool_sizes{};
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_sizes[0].descriptorCount = set_count * 2;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    pool_sizes[1].descriptorCount = set_count;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
+    pool_info.maxSets = set_count;
+
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr,
+                               &target.descriptor_pool) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create post-processing descriptor pool!");
+    }
+    debug_markers.SetName(target.descriptor_pool,
+                          name + " post-processing descriptor pool");
+
+    std::vector<VkDescriptorSetLayout> layouts(set_count,
+                                               post_descriptor_set_layout);
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = target.descriptor_pool;
+    alloc_info.descriptorSetCount = set_count;
+    alloc_info.pSetLayouts = layouts.data();
+
+    std::vector<VkDescriptorSet> sets(set_count);
+    if (vkAllocateDescriptorSets(device, &alloc_info, sets.data()) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to allocate post-processing descriptor sets!");
+    }
+
+    auto next_set = sets.begin();
+    target.bloom_downsample_sets.assign(next_set, next_set + bloom_mip_levels);
+    next_set += bloom_mip_levels;
+    target.bloom_upsample_sets.assign(next_set,
+                                      next_set + bloom_mip_levels - 1);
+    next_set += bloom_mip_levels - 1;
+    target.tone_map_set = *next_set++;
+    target.color_grade_set = *next_set++;
+    target.composite_ldr_set = *next_set++;
+    target.composite_hdr_set = *next_set++;
+
+    for (uint32_t i = 0; i < bloom_mip_levels; i++) {
+        debug_markers.SetName(target.bloom_downsample_sets[i],
+                              name + " bloom downsample " + std::to_string(i));
+    }
+    for (uint32_t i = 0; i + 1 < bloom_mip_levels; i++) {
+        debug_markers.SetName(target.bloom_upsample_sets[i],
+                              name + " bloom upsample " + std::to_string(i));
+    }
+    debug_markers.SetName(target.tone_map_set, name + " tone map");
+    debug_markers.SetName(target.color_grade_set, name + " color grade");
+    debug_markers.SetName(target.composite_ldr_set, name + " composite ldr");
+    debug_markers.SetName(target.composite_hdr_set, name + " composite hdr");
+
+    // The first downsample reads the HDR scene color, every following one
+    // reads the previous level of the pyramid
+    for (uint32_t i = 0; i < bloom_mip_levels; i++) {
+        if (i == 0) {
+            WritePostDescriptorSet(
+                target.bloom_downsample_sets[i], target.hdr_image_view,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                target.bloom_mip_views[i], color_grading_lut_image_view,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        } else {
+            WritePostDescriptorSet(
+                target.bloom_downsample_sets[i], target.bloom_mip_views[i - 1],
+                VK_IMAGE_LAYOUT_GENERAL, target.bloom_mip_views[i],
+                color_grading_lut_image_view,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+    }
+
+    // Every upsample adds the next smaller level onto the current level
+    for (uint32_t i = 0; i + 1 < bloom_mip_levels; i++) {
+        WritePostDescriptorSet(
+            target.bloom_upsample_sets[i], target.bloom_mip_views[i + 1],
+            VK_IMAGE_LAYOUT_GENERAL, target.bloom_mip_views[i],
+            color_grading_lut_image_view,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    WritePostDescriptorSet(target.tone_map_set, target.hdr_image_view,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           target.ldr_image_view, target.bloom_mip_views[0],
+                           VK_IMAGE_LAYOUT_GENERAL);
+    WritePostDescriptorSet(target.color_grade_set, target.ldr_image_view,
+                           VK_IMAGE_LAYOUT_GENERAL, target.ldr_image_view,
+                           color_grading_lut_image_view,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    WritePostDescriptorSet(target.composite_ldr_set, target.ldr_image_view,
+                           VK_IMAGE_LAYOUT_GENERAL, target.ldr_image_view,
+                           color_grading_lut_image_view,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    WritePostDescriptorSet(target.composite_hdr_set, target.hdr_image_view,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           target.ldr_image_view, color_grading_lut_image_view,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void TriangleApplication::WritePostDescriptorSet(
+    VkDescriptorSet descriptor_set, VkImageView input_view,
+    VkImageLayout input_layout, VkImageView output_view,
+    VkImageView auxiliary_view, VkImageLayout auxiliary_layout) {
+    VkDescriptorImageInfo input_info{};
+    input_info.sampler = post_sampler;
+    input_info.imageView = input_view;
+    input_info.imageLayout = input_layout;
+
+    // Storage images must be accessed in the general layout
+    VkDescriptorImageInfo output_info{};
+    output_info.imageView = output_view;
+    output_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkDescriptorImageInfo auxiliary_info{};
+    auxiliary_info.sampler = post_sampler;
+    auxiliary_info.imageView = auxiliary_view;
+    auxiliary_info.imageLayout = auxiliary_layout;
+
+    std::array<VkWriteDescriptorSet, 3> descriptor_writes{};
+    descriptor_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_writes[0].dstSet = descriptor_set;
+    descriptor_writes[0].dstBinding = 0;
+    descriptor_writes[0].descriptorType =
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptor_writes[0].descriptorCount = 1;
+    descriptor_writes[0].pImageInfo = &input_info;
+
+    descriptor_writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_writes[1].dstSet = descriptor_set;
+    descriptor_writes[1].dstBinding = 1;
+    descriptor_writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    descriptor_writes[1].descriptorCount = 1;
+    descriptor_writes[1].pImageInfo = &output_info;
+
+    descriptor_writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_writes[2].dstSet = descriptor_set;
+    descriptor_writes[2].dstBinding = 2;
+    descriptor_writes[2].descriptorType =
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptor_writes[2].descriptorCount = 1;
+    descriptor_writes[2].pImageInfo = &auxiliary_info;
+
+    vkUpdateDescriptorSets(device,
+                           static_cast<uint32_t>(descriptor_writes.size()),
+                           descriptor_writes.data(), 0, nullptr);
+}
+
+void TriangleApplication::DestroyPostProcessTarget(PostProcessTarget& target) {
+    // Descriptor sets are freed together with their pool
+    vkDestroyDescriptorPool(device, target.descriptor_pool, nullptr);
+
+    vkDestroyImageView(device, target.ldr_image_view, nullptr);
+    vkDestroyImage(device, target.ldr_image, nullptr);
+    vkFreeMemory(device, target.ldr_image_memory, nullptr);
+
+    for (VkImageView mip_view : target.bloom_mip_views) {
+        vkDestroyImageView(device, mip_view, nullptr);
+    }
+    vkDestroyImage(device, target.bloom_image, nullptr);
+    vkFreeMemory(device, target.bloom_image_memory, nullptr);
+
+    vkDestroyFramebuffer(device, target.scene_framebuffer, nullptr);
+    vkDestroyImageView(device, target.hdr_image_view, nullptr);
+    vkDestroyImage(device, target.hdr_image, nullptr);
+    vkFreeMemory(device, target.hdr_image_memory, nullptr);
+
+    target = PostProcessTarget{};
+}
+
+void TriangleApplication::CleanupPostProcessing() {
+    vkDestroyImageView(device, color_grading_lut_image_view, nullptr);
+    vkDestroyImage(device, color_grading_lut_image, nullptr);
+    vkFreeMemory(device, color_grading_lut_image_memory, nullptr);
+
+    vkDestroySampler(device, post_sampler, nullptr);
+
+    for (VkPipeline pipeline : post_pipelines) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+    }
+    vkDestroyPipeline(device, composite_pipeline, nullptr);
+
+    vkDestroyPipelineLayout(device, post_pipeline_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device, post_descriptor_set_layout, nullptr);
+
+    vkDestroyRenderPass(device, composite_render_pass, nullptr);
+}
+
+void TriangleApplication::RecordPostProcessing(
+    VkCommandBuffer command_buffer, const PostProcessTarget& target) {
+    /* Post-processing chain
+    - Bloom downsample: bright parts of the scene are filtered into a pyramid
+    of successively smaller images
+    - Bloom upsample: the pyramid is blurred back up to its largest level
+    - Tone map: the HDR scene color plus bloom is mapped into [0, 1]
+    - Color grade: the tone mapped color is remapped through a 3D LUT
+    Skipped stages also skip the stages that depend on their output. */
+    const bool downsample = post_stage_enabled[POST_STAGE_BLOOM_DOWNSAMPLE];
+    const bool upsample =
+        downsample && post_stage_enabled[POST_STAGE_BLOOM_UPSAMPLE];
+    const bool tone_map = post_stage_enabled[POST_STAGE_TONE_MAP];
+    const bool color_grade =
+        tone_map && post_stage_enabled[POST_STAGE_COLOR_GRADE];
+
+    const auto bloom_mip_levels =
+        static_cast<uint32_t>(target.bloom_mip_views.size());
+    const VkExtent2D bloom_extent = BloomExtent(target.extent);
+
+    // The images of the chain are still read by the previous frame, whose
+    // composite pass samples the result
+    PostBarrier(command_buffer,
+                {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR |
+                     VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+                 VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR},
+                COMPUTE_ACCESSES);
+
+    PostPushConstants push_constants{};
+
+    if (downsample) {
+        uint32_t scope = gpu_profiler.BeginScope(
+            command_buffer, POST_STAGE_NAMES[POST_STAGE_BLOOM_DOWNSAMPLE]);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          post_pipelines[POST_STAGE_BLOOM_DOWNSAMPLE]);
+
+        for (uint32_t i = 0; i < bloom_mip_levels; i++) {
+            if (i > 0) {
+                PostBarrier(command_buffer, COMPUTE_WRITES, COMPUTE_ACCESSES);
+            }
+
+            // Only the first level applies the brightness threshold
+            push_constants.params = {BLOOM_THRESHOLD, i == 0 ? 1.0F : 0.0F,
+                                     0.0F, 0.0F};
+            vkCmdPushConstants(command_buffer, post_pipeline_layout,
+                               VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                               sizeof(PostPushConstants), &push_constants);
+            vkCmdBindDescriptorSets(command_buffer,
+                                    VK_PIPELINE_BIND_POINT_COMPUTE,
+                                    post_pipeline_layout, 0, 1,
+                                    &target.bloom_downsample_sets[i], 0,
+                                    nullptr);
+
+            VkExtent2D mip_extent = MipExtent(bloom_extent, i);
+            vkCmdDispatch(command_buffer, DispatchSize(mip_extent.width),
+                          DispatchSize(mip_extent.height), 1);
+            draw_counts.dispatches++;
+        }
+
+        gpu_profiler.EndScope(command_buffer, scope);
+    }
+
+    if (upsample) {
+        uint32_t scope = gpu_profiler.BeginScope(
+            command_buffer, POST_STAGE_NAMES[POST_STAGE_BLOOM_UPSAMPLE]);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          post_pipelines[POST_STAGE_BLOOM_UPSAMPLE]);
+
+        push_constants.params = {BLOOM_FILTER_RADIUS, 0.0F, 0.0F, 0.0F};
+        vkCmdPushConstants(command_buffer, post_pipeline_layout,
+                           VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(PostPushConstants), &push_constants);
+
+        // Walk the pyramid from the smallest level back up to the largest
+        for (uint32_t i = bloom_mip_levels - 1; i > 0; i--) {
+            PostBarrier(command_buffer, COMPUTE_WRITES, COMPUTE_ACCESSES);
+            vkCmdBindDescriptorSets(command_buffer,
+                                    VK_PIPELINE_BIND_POINT_COMPUTE,
+                                    post_pipeline_layout, 0, 1,
+                                    &target.bloom_upsample_sets[i - 1], 0,
+                                    nullptr);
+
+            VkExtent2D mip_extent = MipExtent(bloom_extent, i - 1);
+            vkCmdDispatch(command_buffer, DispatchSize(mip_extent.width),
+                          DispatchSize(mip_extent.height), 1);
+            draw_counts.dispatches++;
+        }
+
+        gpu_profiler.EndScope(command_buffer, scope);
+    }
+
+    if (tone_map) {
+        PostBarrier(command_buffer, COMPUTE_WRITES, COMPUTE_ACCESSES);
+
+        uint32_t scope = gpu_profiler.BeginScope(
+            command_buffer, POST_STAGE_NAMES[POST_STAGE_TONE_MAP]);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          post_pipelines[POST_STAGE_TONE_MAP]);
+
+        // The bloom pyramid is only added if it was generated this frame
+        push_constants.params = {EXPOSURE, downsample ? BLOOM_STRENGTH : 0.0F,
+                                 0.0F, 0.0F};
+        vkCmdPushConstants(command_buffer, post_pipeline_layout,
+                           VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(PostPushConstants), &push_constants);
+        vkCmdBindDescriptorSets(
+            command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+            post_pipeline_layout, 0, 1, &target.tone_map_set, 0, nullptr);
+        vkCmdDispatch(command_buffer, DispatchSize(target.extent.width),
+                      DispatchSize(target.extent.height), 1);
+        draw_counts.dispatches++;
+
+        gpu_profiler.EndScope(command_buffer, scope);
+    }
+
+    if (color_grade) {
+        PostBarrier(command_buffer, COMPUTE_WRITES, COMPUTE_ACCESSES);
+
+        uint32_t scope = gpu_profiler.BeginScope(
+            command_buffer, POST_STAGE_NAMES[POST_STAGE_COLOR_GRADE]);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          post_pipelines[POST_STAGE_COLOR_GRADE]);
+
+        push_constants.params = {static_cast<float>(COLOR_GRADING_LUT_SIZE),
+                                 0.0F, 0.0F, 0.0F};
+        vkCmdPushConstants(command_buffer, post_pipeline_layout,
+                           VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(PostPushConstants), &push_constants);
+        vkCmdBindDescriptorSets(
+            command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+            post_pipeline_layout, 0, 1, &target.color_grade_set, 0, nullptr);
+        vkCmdDispatch(command_buffer, DispatchSize(target.extent.width),
+                      DispatchSize(target.extent.height), 1);
+        draw_counts.dispatches++;
+
+        gpu_profiler.EndScope(command_buffer, scope);
+    }
+
+    // The composite pass samples the result of the chain
+    PostBarrier(command_buffer, COMPUTE_WRITES,
+                {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+                 VK_ACCESS_2_SHADER_SAMPLED_READ_BIT_KHR});
+}
+
+void TriangleApplication::PostBarrier(VkCommandBuffer command_buffer,
+                                      SyncScope src, SyncScope dst) {
+    // Make the storage image writes of one stage visible to the next
+    post_barriers.AddMemoryBarrier(src, dst);
+    post_barriers.Flush(command_buffer, synchronization2);
+}
+
+void TriangleApplication::RecordCompositePass(VkCommandBuffer command_buffer,
+                                              VkFramebuffer framebuffer,
+                                              VkExtent2D extent,
+                                              const PostProcessTarget& target,
+                                              bool draw_overlay) {
+    uint32_t scope = gpu_profiler.BeginScope(command_buffer, "composite");
+
+    VkRenderPassBeginInfo render_pass_info{};
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    render_pass_info.renderPass = composite_render_pass;
+    render_pass_info.framebuffer = framebuffer;
+    render_pass_info.renderArea.offset = {0, 0};
+    render_pass_info.renderArea.extent = extent;
+
+    vkCmdBeginRenderPass(command_buffer, &render_pass_info,
+                         VK_SUBPASS_CONTENTS_INLINE);
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      composite_pipeline);
+    extended_dynamic_state.CmdSetState(command_buffer, QUAD_RASTER_STATE);
+
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0F;
+    viewport.maxDepth = 1.0F;
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = extent;
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+    // Without tone mapping the HDR scene color is presented directly and
+    // clamped by the swap chain format
+    const VkDescriptorSet composite_set =
+        post_stage_enabled[POST_STAGE_TONE_MAP] ? target.composite_ldr_set
+                                                : target.composite_hdr_set;
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            post_pipeline_layout, 0, 1, &composite_set, 0,
+                            nullptr);
+
+    vkCmdDraw(command_buffer, 3, 1, 0, 0);
+    draw_counts.draws++;
+
+    if (draw_overlay) {
+        RecordPerfOverlay(command_buffer, extent);
+    }
+
+    vkCmdEndRenderPass(command_buffer);
+
+    gpu_profiler.EndScope(command_buffer, scope);
+}
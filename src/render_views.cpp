@@ -0,0 +1,190 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+void TriangleApplication::CreateRenderViews(
+    const std::vector<BatchView>& views) {
+    /* Every view gets its own targets, sized to its resolution, but uses the
+    pipelines, samplers and pools of the application. */
+    render_views.resize(views.size());
+
+    for (size_t i = 0; i < views.size(); i++) {
+        RenderView& view = render_views[i];
+        view.name = views[i].name;
+        view.camera = views[i].camera;
+        view.extent = views[i].resolution;
+
+        CreatePostProcessTarget(view.post_target, view.extent,
+                                "view " + view.name);
+
+        view.images.resize(MAX_FRAMES_IN_FLIGHT);
+        view.image_memory.resize(MAX_FRAMES_IN_FLIGHT);
+        view.image_views.resize(MAX_FRAMES_IN_FLIGHT);
+        view.framebuffers.resize(MAX_FRAMES_IN_FLIGHT);
+
+        for (size_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+            CreateImage(VK_IMAGE_TYPE_2D,
+                        {view.extent.width, view.extent.height, 1}, 1,
+                        HEADLESS_FORMAT,
+                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                            VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        view.images[frame], view.image_memory[frame]);
+            view.image_views[frame] =
+                CreateImageView(view.images[frame], VK_IMAGE_VIEW_TYPE_2D,
+                                HEADLESS_FORMAT, 0, 1);
+
+            VkFramebufferCreateInfo framebuffer_info{};
+            framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebuffer_info.renderPass = composite_render_pass;
+            framebuffer_info.attachmentCount = 1;
+            framebuffer_info.pAttachments = &view.image_views[frame];
+            framebuffer_info.width = view.extent.width;
+            framebuffer_info.height = view.extent.height;
+            framebuffer_info.layers = 1;
+
+            if (vkCreateFramebuffer(device, &framebuffer_info, nullptr,
+                                    &view.framebuffers[frame]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create view framebuffer!");
+            }
+
+            std::string suffix = " " + view.name + " " + std::to_string(frame);
+            debug_markers.SetName(view.images[frame], "view image" + suffix);
+            debug_markers.SetName(view.image_memory[frame],
+                                  "view image memory" + suffix);
+            debug_markers.SetName(view.image_views[frame],
+                                  "view image view" + suffix);
+            debug_markers.SetName(view.framebuffers[frame],
+                                  "view framebuffer" + suffix);
+        }
+
+        // Views are recorded into command buffers of their own, which are
+        // submitted after the command buffer of the frame
+        view.command_buffers.resize(MAX_FRAMES_IN_FLIGHT);
+
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = command_pool;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount =
+            static_cast<uint32_t>(view.command_buffers.size());
+
+        if (vkAllocateCommandBuffers(device, &alloc_info,
+                                     view.command_buffers.data()) !=
+            VK_SUCCESS) {
+            throw std::runtime_error(
+                "failed to allocate view command buffers!");
+        }
+        for (size_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+            debug_markers.SetName(view.command_buffers[frame],
+                                  "view command buffer " + view.name + " " +
+                                      std::to_string(frame));
+        }
+
+        view.frame_readback.Init(physical_device, device,
+                                 MAX_FRAMES_IN_FLIGHT);
+    }
+}
+
+void TriangleApplication::DestroyRenderViews() {
+    for (RenderView& view : render_views) {
+        view.frame_readback.Destroy();
+
+        vkFreeCommandBuffers(device, command_pool,
+                             static_cast<uint32_t>(view.command_buffers.size()),
+                             view.command_buffers.data());
+
+        for (size_t frame = 0; frame < view.images.size(); frame++) {
+            vkDestroyFramebuffer(device, view.framebuffers[frame], nullptr);
+            vkDestroyImageView(device, view.image_views[frame], nullptr);
+            vkDestroyImage(device, view.images[frame], nullptr);
+            vkFreeMemory(device, view.image_memory[frame], nullptr);
+        }
+
+        DestroyPostProcessTarget(view.post_target);
+    }
+    render_views.clear();
+}
+
+void TriangleApplication::RecordRenderView(RenderView& view,
+                                           const Camera& base_camera) {
+    VkCommandBuffer command_buffer = view.command_buffers[current_frame];
+    vkResetCommandBuffer(command_buffer, 0);
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    RecordScenePass(command_buffer, view.post_target,
+                    CombineCameras(base_camera, view.camera));
+    RecordPostProcessing(command_buffer, view.post_target);
+    RecordCompositePass(command_buffer, view.framebuffers[current_frame],
+                        view.extent, view.post_target, false);
+    view.frame_readback.Record(command_buffer, current_frame,
+                               view.images[current_frame], HEADLESS_FORMAT,
+                               view.extent, composite_final_layout);
+
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+}
+
+void TriangleApplication::DrawRenderViews() {
+    /* Render every view of the frame with a single submission. Work that
+    is done once per frame, such as texture uploads, is recorded into the
+    command buffer of the frame slot, which is submitted first, so its
+    barriers also order it before the views. A lost device is not recovered,
+    since the views are not created again. */
+    if (vkWaitForFences(device, 1, &in_flight_fences[current_frame], VK_TRUE,
+                        UINT64_MAX) == VK_ERROR_DEVICE_LOST) {
+        FailDeviceLost("vkWaitForFences");
+    }
+
+    gpu_profiler.Collect(current_frame);
+    for (RenderView& view : render_views) {
+        view.frame_readback.Collect(current_frame, image_writer);
+    }
+
+    vkResetFences(device, 1, &in_flight_fences[current_frame]);
+
+    VkCommandBuffer frame_commands = command_buffers[current_frame];
+    vkResetCommandBuffer(frame_commands, 0);
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(frame_commands, &begin_info) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording command buffer!");
+    }
+
+    gpu_profiler.BeginFrame(frame_commands, current_frame);
+    descriptor_allocator.BeginFrame(current_frame);
+    mip_generator.BeginFrame(current_frame);
+
+    uint32_t upload_scope =
+        gpu_profiler.BeginScope(frame_commands, "texture upload");
+    texture_streamer.Update(frame_commands, current_frame);
+    gpu_profiler.EndScope(frame_commands, upload_scope);
+
+    if (vkEndCommandBuffer(frame_commands) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    std::vector<VkCommandBuffer> submitted = {frame_commands};
+    for (RenderView& view : render_views) {
+        RecordRenderView(view, camera);
+        submitted.push_back(view.command_buffers[current_frame]);
+    }
+
+    if (synchronization2.Submit(graphics_queue, {}, submitted, {},
+                                in_flight_fences[current_frame]) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to submit view command buffers!");
+    }
+
+    current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
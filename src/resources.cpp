@@ -0,0 +1,375 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+uint32_t TriangleApplication::FindMemoryType(
+    uint32_t type_filter, VkMemoryPropertyFlags properties) {
+    /* Graphics cards offer different types of memory to allocate from. Each
+    type of memory varies in terms of allowed operations and performance
+    characteristics. Combine the requirements of the buffer or image with the
+    requested properties to find the right type of memory to use. */
+    VkPhysicalDeviceMemoryProperties mem_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
+
+    // The type_filter parameter specifies the bit field of memory types that
+    // are suitable. Also check that the memory type has all of the requested
+    // properties, such as being able to map it from the CPU.
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++) {
+        if ((type_filter & (1U << i)) &&
+            (mem_properties.memoryTypes[i].propertyFlags & properties) ==
+                properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+void TriangleApplication::CreateBuffer(VkDeviceSize size,
+                                       VkBufferUsageFlags usage,
+                                       VkMemoryPropertyFlags properties,
+                                       VkBuffer& buffer,
+                                       VkDeviceMemory& buffer_memory) {
+    // Describe the buffer information
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = usage;
+
+    // The buffer will only be used from the graphics queue
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &buffer_info, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create buffer!");
+    }
+
+    // Query the memory requirements of the buffer
+    VkMemoryRequirements mem_requirements{};
+    vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
+
+    // Describe the memory allocation information
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex =
+        FindMemoryType(mem_requirements.memoryTypeBits, properties);
+
+    if (vkAllocateMemory(device, &alloc_info, nullptr, &buffer_memory) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate buffer memory!");
+    }
+
+    // Associate the memory with the buffer
+    vkBindBufferMemory(device, buffer, buffer_memory, 0);
+}
+
+void TriangleApplication::CreateImage(VkImageType image_type,
+                                      VkExtent3D extent, uint32_t mip_levels,
+                                      VkFormat format, VkImageUsageFlags usage,
+                                      VkMemoryPropertyFlags properties,
+                                      VkImage& image,
+                                      VkDeviceMemory& image_memory) {
+    // Describe the image information
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = image_type;
+    image_info.extent = extent;
+    image_info.mipLevels = mip_levels;
+    image_info.arrayLayers = 1;
+    image_info.format = format;
+
+    // VK_IMAGE_TILING_OPTIMAL: Texels are laid out in an implementation
+    // defined order for optimal access. The images are only ever accessed
+    // from the GPU or through a staging buffer.
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.usage = usage;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateImage(device, &image_info, nullptr, &image) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create image!");
+    }
+
+    // Allocate memory for the image in the same way as for a buffer
+    VkMemoryRequirements mem_requirements{};
+    vkGetImageMemoryRequirements(device, image, &mem_requirements);
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex =
+        FindMemoryType(mem_requirements.memoryTypeBits, properties);
+
+    if (vkAllocateMemory(device, &alloc_info, nullptr, &image_memory) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate image memory!");
+    }
+
+    vkBindImageMemory(device, image, image_memory, 0);
+}
+
+VkImageView TriangleApplication::CreateImageView(VkImage image,
+                                                 VkImageViewType view_type,
+                                                 VkFormat format,
+                                                 uint32_t base_mip_level,
+                                                 uint32_t level_count) {
+    // Parameters for image view creation
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = image;
+    view_info.viewType = view_type;
+    view_info.format = format;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view_info.subresourceRange.baseMipLevel = base_mip_level;
+    view_info.subresourceRange.levelCount = level_count;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+
+    VkImageView image_view = VK_NULL_HANDLE;
+    if (vkCreateImageView(device, &view_info, nullptr, &image_view) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create image view!");
+    }
+
+    return image_view;
+}
+
+VkPipeline TriangleApplication::CreateVertexlessPipeline(
+    const std::string& vert_filename, const std::string& frag_filename,
+    VkPipelineLayout layout, VkRenderPass render_pass,
+    const RasterState& state, VkPipelineCreateFlags flags) {
+    /* Create a pipeline whose vertex shader generates its vertices from
+    gl_VertexIndex, so no vertex input is required. Used for fullscreen passes
+    and simple screen space quads. The raster state is only baked into the
+    pipeline where it can't be set in the command buffer. */
+    auto vert_shader_code = ReadFile(vert_filename);
+    auto frag_shader_code = ReadFile(frag_filename);
+
+    VkShaderModule vert_shader_module = CreateShaderModule(vert_shader_code);
+    VkShaderModule frag_shader_module = CreateShaderModule(frag_shader_code);
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shader_stages{};
+    shader_stages[0].sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shader_stages[0].module = vert_shader_module;
+    shader_stages[0].pName = "main";
+
+    shader_stages[1].sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shader_stages[1].module = frag_shader_module;
+    shader_stages[1].pName = "main";
+
+    VkPipelineVertexInputStateCreateInfo vertex_input_info{};
+    vertex_input_info.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+    input_assembly.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    input_assembly.topology = state.topology;
+    input_assembly.primitiveRestartEnable = VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewport_state{};
+    viewport_state.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0F;
+    rasterizer.cullMode = state.cull_mode;
+    rasterizer.frontFace = state.front_face;
+
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    depth_stencil.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil.depthTestEnable = state.depth_test ? VK_TRUE : VK_FALSE;
+    depth_stencil.depthWriteEnable = depth_stencil.depthTestEnable;
+    depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 1.0F;
+
+    VkPipelineColorBlendAttachmentState color_blend_attachment =
+        BlendAttachmentState(state);
+
+    VkPipelineColorBlendStateCreateInfo color_blending{};
+    color_blending.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blending.logicOpEnable = VK_FALSE;
+    color_blending.attachmentCount = 1;
+    color_blending.pAttachments = &color_blend_attachment;
+
+    std::vector<VkDynamicState> dynamic_states =
+        extended_dynamic_state.GetDynamicStates();
+    dynamic_states.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+    dynamic_states.push_back(VK_DYNAMIC_STATE_SCISSOR);
+
+    VkPipelineDynamicStateCreateInfo dynamic_state{};
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.dynamicStateCount =
+        static_cast<uint32_t>(dynamic_states.size());
+    dynamic_state.pDynamicStates = dynamic_states.data();
+
+    VkGraphicsPipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.flags = flags;
+    pipeline_info.stageCount = static_cast<uint32_t>(shader_stages.size());
+    pipeline_info.pStages = shader_stages.data();
+    pipeline_info.pVertexInputState = &vertex_input_info;
+    pipeline_info.pInputAssemblyState = &input_assembly;
+    pipeline_info.pViewportState = &viewport_state;
+    pipeline_info.pRasterizationState = &rasterizer;
+    pipeline_info.pMultisampleState = &multisampling;
+    pipeline_info.pDepthStencilState = &depth_stencil;
+    pipeline_info.pColorBlendState = &color_blending;
+    pipeline_info.pDynamicState = &dynamic_state;
+    pipeline_info.layout = layout;
+    pipeline_info.renderPass = render_pass;
+    pipeline_info.subpass = 0;
+    pipeline_info.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipeline_info,
+                                  nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create graphics pipeline!");
+    }
+    debug_markers.SetName(pipeline, frag_filename);
+
+    vkDestroyShaderModule(device, frag_shader_module, nullptr);
+    vkDestroyShaderModule(device, vert_shader_module, nullptr);
+
+    return pipeline;
+}
+
+VkCommandBuffer TriangleApplication::BeginSingleTimeCommands() {
+    /* Memory transfer and layout transition operations are executed using
+    command buffers. Allocate a temporary command buffer that is only used
+    once and submitted right away. */
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandPool = command_pool;
+    alloc_info.commandBufferCount = 1;
+
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    if (vkAllocateCommandBuffers(device, &alloc_info, &command_buffer) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate command buffer!");
+    }
+
+    // Tell the driver about our intent to use the command buffer once
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(command_buffer, &begin_info);
+
+    return command_buffer;
+}
+
+void TriangleApplication::EndSingleTimeCommands(
+    VkCommandBuffer command_buffer) {
+    vkEndCommandBuffer(command_buffer);
+
+    // Execute the command buffer and wait for it to complete. These commands
+    // are only used during initialization, so waiting for the queue to become
+    // idle is acceptable.
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+
+    vkQueueSubmit(graphics_queue, 1, &submit_info, VK_NULL_HANDLE);
+    vkQueueWaitIdle(graphics_queue);
+
+    vkFreeCommandBuffers(device, command_pool, 1, &command_buffer);
+}
+
+void TriangleApplication::TransitionImageLayout(VkCommandBuffer command_buffer,
+                                                VkImage image,
+                                                VkImageLayout old_layout,
+                                                VkImageLayout new_layout,
+                                                uint32_t mip_levels) {
+    BarrierBatch barriers;
+    AddLayoutTransition(barriers, image, old_layout, new_layout, mip_levels);
+    barriers.Flush(command_buffer, synchronization2);
+}
+
+void TriangleApplication::AddLayoutTransition(BarrierBatch& barriers,
+                                              VkImage image,
+                                              VkImageLayout old_layout,
+                                              VkImageLayout new_layout,
+                                              uint32_t mip_levels) {
+    /* One of the most common ways to perform layout transitions is using an
+    image memory barrier. A pipeline barrier like that is generally used to
+    synchronize access to resources, but it can also be used to transition
+    image layouts. */
+    SyncScope src;
+    SyncScope dst;
+
+    // Specify which types of operations that involve the resource must happen
+    // before the barrier, and which operations must wait on the barrier. The
+    // contents of an undefined image are discarded, so nothing has to happen
+    // before the barrier.
+    if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+        // Filled by CopyBufferToImage
+        src = {VK_PIPELINE_STAGE_2_COPY_BIT_KHR,
+               VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR};
+    }
+
+    if (new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+        dst = {VK_PIPELINE_STAGE_2_COPY_BIT_KHR |
+                   VK_PIPELINE_STAGE_2_CLEAR_BIT_KHR,
+               VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR};
+    } else if (new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+        dst = {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR |
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR,
+               VK_ACCESS_2_SHADER_SAMPLED_READ_BIT_KHR};
+    } else if (new_layout == VK_IMAGE_LAYOUT_GENERAL) {
+        // Storage images that are sampled by the next stage as well
+        dst = {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR |
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR,
+               VK_ACCESS_2_SHADER_SAMPLED_READ_BIT_KHR |
+                   VK_ACCESS_2_SHADER_STORAGE_READ_BIT_KHR |
+                   VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR};
+    } else {
+        throw std::invalid_argument("unsupported layout transition!");
+    }
+
+    barriers.AddImageBarrier(image, ColorLevels(0, mip_levels), old_layout,
+                             new_layout, src, dst);
+}
+
+void TriangleApplication::CopyBufferToImage(VkCommandBuffer command_buffer,
+                                            VkBuffer buffer, VkImage image,
+                                            VkExtent3D extent,
+                                            uint32_t mip_level) {
+    // Specify which part of the buffer is going to be copied to which part
+    // of the image. A buffer row length and image height of 0 means the
+    // pixels are tightly packed.
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = mip_level;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = extent;
+
+    // The image is expected to be in the transfer destination layout
+    vkCmdCopyBufferToImage(command_buffer, buffer, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
@@ -0,0 +1,261 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+void TriangleApplication::CreateSecondaryWindows() {
+    /* Every window beyond the first gets its own surface and swap chain, but
+    shares the device, the pipelines and the frame slots of the main window.
+    The composite render pass was created for the format of the main swap
+    chain, so the other swap chains have to use the same format. */
+    QueueFamilyIndices indices = FindQueueFamilies(physical_device);
+
+    secondary_windows.resize(options.window_count - 1);
+    for (size_t i = 0; i < secondary_windows.size(); i++) {
+        SecondaryWindow& secondary = secondary_windows[i];
+
+        std::string title = "Vulkan window " + std::to_string(i + 2);
+        secondary.window =
+            glfwCreateWindow(WIDTH, HEIGHT, title.c_str(), nullptr, nullptr);
+        if (secondary.window == nullptr) {
+            throw std::runtime_error("failed to create window!");
+        }
+
+        // Resizes and key presses are handled as for the main window
+        glfwSetWindowUserPointer(secondary.window, this);
+        glfwSetFramebufferSizeCallback(secondary.window,
+                                       FramebufferResizeCallback);
+        glfwSetKeyCallback(secondary.window, KeyCallback);
+
+        int width = 0;
+        int height = 0;
+        glfwGetFramebufferSize(secondary.window, &width, &height);
+        secondary.framebuffer_size = {static_cast<uint32_t>(width),
+                                      static_cast<uint32_t>(height)};
+
+        if (glfwCreateWindowSurface(instance, secondary.window, nullptr,
+                                    &secondary.surface) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create window surface!");
+        }
+
+        // All windows are presented by a single call on the present queue
+        VkBool32 present_support = VK_FALSE;
+        vkGetPhysicalDeviceSurfaceSupportKHR(physical_device,
+                                             indices.present_family.value(),
+                                             secondary.surface,
+                                             &present_support);
+        if (present_support == VK_FALSE) {
+            throw std::runtime_error(
+                "present queue cannot present to every window!");
+        }
+
+        CreateSecondaryDeviceObjects(secondary);
+    }
+}
+
+void TriangleApplication::DestroySecondaryWindows() {
+    for (SecondaryWindow& secondary : secondary_windows) {
+        DestroySecondaryDeviceObjects(secondary);
+
+        vkDestroySurfaceKHR(instance, secondary.surface, nullptr);
+        glfwDestroyWindow(secondary.window);
+    }
+    secondary_windows.clear();
+}
+
+void TriangleApplication::CreateSecondaryDeviceObjects(
+    SecondaryWindow& secondary) {
+    CreateSecondarySwapChain(secondary);
+
+    secondary.image_available_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
+
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    std::string name =
+        "window " + std::to_string(&secondary - secondary_windows.data() + 2);
+    for (size_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+        VkSemaphore& semaphore = secondary.image_available_semaphores[frame];
+        if (vkCreateSemaphore(device, &semaphore_info, nullptr, &semaphore) !=
+            VK_SUCCESS) {
+            throw std::runtime_error("failed to create semaphore!");
+        }
+        debug_markers.SetName(
+            semaphore, name + " image available " + std::to_string(frame));
+    }
+}
+
+void TriangleApplication::DestroySecondaryDeviceObjects(
+    SecondaryWindow& secondary) {
+    CleanupSecondarySwapChain(secondary);
+
+    for (VkSemaphore semaphore : secondary.image_available_semaphores) {
+        vkDestroySemaphore(device, semaphore, nullptr);
+    }
+    secondary.image_available_semaphores.clear();
+}
+
+void TriangleApplication::CreateSecondarySwapChain(SecondaryWindow& secondary) {
+    SwapChainSupportDetails swap_chain_support =
+        QuerySwapChainSupport(physical_device, secondary.surface);
+
+    // Find the color space the surface pairs with the shared format
+    auto surface_format = std::find_if(
+        swap_chain_support.formats.begin(), swap_chain_support.formats.end(),
+        [this](const VkSurfaceFormatKHR& format) {
+            return format.format == swap_chain_image_format;
+        });
+    if (surface_format == swap_chain_support.formats.end()) {
+        throw std::runtime_error(
+            "window surface does not support the swap chain format!");
+    }
+
+    secondary.extent = ChooseSwapExtent(swap_chain_support.capabilities,
+                                        secondary.framebuffer_size);
+
+    uint32_t image_count = swap_chain_support.capabilities.minImageCount + 1;
+    if (swap_chain_support.capabilities.maxImageCount > 0 &&
+        image_count > swap_chain_support.capabilities.maxImageCount) {
+        image_count = swap_chain_support.capabilities.maxImageCount;
+    }
+
+    VkSwapchainCreateInfoKHR create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    create_info.surface = secondary.surface;
+    create_info.minImageCount = image_count;
+    create_info.imageFormat = surface_format->format;
+    create_info.imageColorSpace = surface_format->colorSpace;
+    create_info.imageExtent = secondary.extent;
+    create_info.imageArrayLayers = 1;
+    create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    // Same queue family setup as the main swap chain
+    QueueFamilyIndices indices = FindQueueFamilies(physical_device);
+    std::array<uint32_t, 2> queue_family_indices = {
+        indices.graphics_family.value(), indices.present_family.value()};
+
+    if (indices.graphics_family != indices.present_family) {
+        create_info.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+        create_info.queueFamilyIndexCount = 2;
+        create_info.pQueueFamilyIndices = queue_family_indices.data();
+    } else {
+        create_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+
+    create_info.preTransform = swap_chain_support.capabilities.currentTransform;
+    create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    create_info.presentMode =
+        ChooseSwapPresentMode(swap_chain_support.present_modes);
+    create_info.clipped = VK_TRUE;
+    create_info.oldSwapchain = VK_NULL_HANDLE;
+
+    if (vkCreateSwapchainKHR(device, &create_info, nullptr,
+                             &secondary.swap_chain) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create swap chain!");
+    }
+
+    // Windows are numbered from 1, the main window being the first
+    std::string name =
+        "window " + std::to_string(&secondary - secondary_windows.data() + 2);
+    debug_markers.SetName(secondary.swap_chain, name + " swap chain");
+
+    vkGetSwapchainImagesKHR(device, secondary.swap_chain, &image_count,
+                            nullptr);
+    secondary.images.resize(image_count);
+    vkGetSwapchainImagesKHR(device, secondary.swap_chain, &image_count,
+                            secondary.images.data());
+
+    secondary.image_views.resize(image_count);
+    secondary.framebuffers.resize(image_count);
+    for (size_t i = 0; i < image_count; i++) {
+        secondary.image_views[i] =
+            CreateImageView(secondary.images[i], VK_IMAGE_VIEW_TYPE_2D,
+                            swap_chain_image_format, 0, 1);
+
+        VkFramebufferCreateInfo framebuffer_info{};
+        framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebuffer_info.renderPass = composite_render_pass;
+        framebuffer_info.attachmentCount = 1;
+        framebuffer_info.pAttachments = &secondary.image_views[i];
+        framebuffer_info.width = secondary.extent.width;
+        framebuffer_info.height = secondary.extent.height;
+        framebuffer_info.layers = 1;
+
+        if (vkCreateFramebuffer(device, &framebuffer_info, nullptr,
+                                &secondary.framebuffers[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create framebuffer!");
+        }
+
+        std::string suffix = " " + std::to_string(i);
+        debug_markers.SetName(secondary.images[i], name + " image" + suffix);
+        debug_markers.SetName(secondary.image_views[i],
+                              name + " image view" + suffix);
+        debug_markers.SetName(secondary.framebuffers[i],
+                              name + " framebuffer" + suffix);
+    }
+
+    // The scene is rendered at the resolution of the window, unless the
+    // memory budget lowered it
+    CreatePostProcessTarget(secondary.post_target,
+                            GetRenderExtent(secondary.extent), name);
+}
+
+void TriangleApplication::CleanupSecondarySwapChain(
+    SecondaryWindow& secondary) {
+    DestroyPostProcessTarget(secondary.post_target);
+
+    for (VkFramebuffer framebuffer : secondary.framebuffers) {
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    }
+    for (VkImageView image_view : secondary.image_views) {
+        vkDestroyImageView(device, image_view, nullptr);
+    }
+    secondary.framebuffers.clear();
+    secondary.image_views.clear();
+    secondary.images.clear();
+
+    vkDestroySwapchainKHR(device, secondary.swap_chain, nullptr);
+    secondary.swap_chain = VK_NULL_HANDLE;
+}
+
+bool TriangleApplication::IsAnyWindowClosed() const {
+    // Closing any of the windows ends the application
+    if (glfwWindowShouldClose(window)) {
+        return true;
+    }
+    return std::any_of(secondary_windows.begin(), secondary_windows.end(),
+                       [](const SecondaryWindow& secondary) {
+                           return glfwWindowShouldClose(secondary.window);
+                       });
+}
+
+bool TriangleApplication::AcquireSecondaryImages(
+    std::vector<VkSemaphore>& wait_semaphores) {
+    for (SecondaryWindow& secondary : secondary_windows) {
+        VkSemaphore semaphore =
+            secondary.image_available_semaphores[current_frame];
+        VkResult result = vkAcquireNextImageKHR(
+            device, secondary.swap_chain, UINT64_MAX, semaphore,
+            VK_NULL_HANDLE, &secondary.image_index);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            return false;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
+
+        wait_semaphores.push_back(semaphore);
+    }
+    return true;
+}
+
+void TriangleApplication::RecordSecondaryWindows(
+    VkCommandBuffer command_buffer) {
+    /* Each window runs the whole chain into its own HDR target, so its
+    post-processing works at its own resolution */
+    for (SecondaryWindow& secondary : secondary_windows) {
+        RecordScenePass(command_buffer, secondary.post_target, camera);
+        RecordPostProcessing(command_buffer, secondary.post_target);
+        RecordCompositePass(command_buffer,
+                            secondary.framebuffers[secondary.image_index],
+                            secondary.extent, secondary.post_target, false);
+    }
+}
@@ -0,0 +1,181 @@
+/* Local header files */
+#include "shader_objects.hpp"
+
+/* Standard libraries */
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// The shaders were chosen at startup, so a missing function is an error
+template <typename Function>
+void LoadFunction(VkDevice device, const char* name, Function& function) {
+    function = reinterpret_cast<Function>(vkGetDeviceProcAddr(device, name));
+    if (function == nullptr) {
+        throw std::runtime_error(std::string("failed to load ") + name + "!");
+    }
+}
+
+}  // namespace
+
+void ShaderObjects::Init(VkDevice device, bool enabled) {
+    *this = {};
+    this->device = device;
+    if (!enabled) {
+        return;
+    }
+
+    // Device level extension functions
+    LoadFunction(device, "vkCreateShadersEXT", create_shaders);
+    LoadFunction(device, "vkDestroyShaderEXT", destroy_shader);
+    LoadFunction(device, "vkCmdBindShadersEXT", bind_shaders);
+    LoadFunction(device, "vkCmdBeginRenderingKHR", begin_rendering);
+    LoadFunction(device, "vkCmdEndRenderingKHR", end_rendering);
+    LoadFunction(device, "vkCmdSetViewportWithCountEXT",
+                 set_viewport_with_count);
+    LoadFunction(device, "vkCmdSetScissorWithCountEXT",
+                 set_scissor_with_count);
+    LoadFunction(device, "vkCmdSetVertexInputEXT", set_vertex_input);
+    LoadFunction(device, "vkCmdSetRasterizerDiscardEnableEXT",
+                 set_rasterizer_discard_enable);
+    LoadFunction(device, "vkCmdSetPolygonModeEXT", set_polygon_mode);
+    LoadFunction(device, "vkCmdSetRasterizationSamplesEXT",
+                 set_rasterization_samples);
+    LoadFunction(device, "vkCmdSetSampleMaskEXT", set_sample_mask);
+    LoadFunction(device, "vkCmdSetAlphaToCoverageEnableEXT",
+                 set_alpha_to_coverage_enable);
+    LoadFunction(device, "vkCmdSetDepthBiasEnableEXT", set_depth_bias_enable);
+    LoadFunction(device, "vkCmdSetDepthCompareOpEXT", set_depth_compare_op);
+    LoadFunction(device, "vkCmdSetDepthBoundsTestEnableEXT",
+                 set_depth_bounds_test_enable);
+    LoadFunction(device, "vkCmdSetStencilTestEnableEXT",
+                 set_stencil_test_enable);
+
+    // Every function of the three levels comes with shader objects
+    raster_state.Init(device, 3);
+    if (raster_state.GetLevel() < 3) {
+        throw std::runtime_error("failed to load dynamic state functions!");
+    }
+    this->enabled = true;
+}
+
+bool ShaderObjects::IsEnabled() const { return enabled; }
+
+ShaderPair ShaderObjects::CreateShaderPair(
+    const std::vector<char>& vert_code, const std::vector<char>& frag_code,
+    const std::vector<VkDescriptorSetLayout>& set_layouts,
+    const std::vector<VkPushConstantRange>& push_constant_ranges) const {
+    std::array<VkShaderCreateInfoEXT, 2> create_infos{};
+    for (auto& create_info : create_infos) {
+        create_info.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+        create_info.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+        create_info.pName = "main";
+        create_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+        create_info.pSetLayouts = set_layouts.data();
+        create_info.pushConstantRangeCount =
+            static_cast<uint32_t>(push_constant_ranges.size());
+        create_info.pPushConstantRanges = push_constant_ranges.data();
+    }
+
+    create_infos[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    create_infos[0].nextStage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    create_infos[0].codeSize = vert_code.size();
+    create_infos[0].pCode = vert_code.data();
+
+    create_infos[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    create_infos[1].codeSize = frag_code.size();
+    create_infos[1].pCode = frag_code.data();
+
+    std::array<VkShaderEXT, 2> shaders{};
+    if (create_shaders(device, static_cast<uint32_t>(create_infos.size()),
+                       create_infos.data(), nullptr,
+                       shaders.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader objects!");
+    }
+
+    ShaderPair shader_pair;
+    shader_pair.vertex = shaders[0];
+    shader_pair.fragment = shaders[1];
+    return shader_pair;
+}
+
+void ShaderObjects::DestroyShaderPair(ShaderPair& shaders) const {
+    if (shaders.vertex != VK_NULL_HANDLE) {
+        destroy_shader(device, shaders.vertex, nullptr);
+    }
+    if (shaders.fragment != VK_NULL_HANDLE) {
+        destroy_shader(device, shaders.fragment, nullptr);
+    }
+    shaders = {};
+}
+
+void ShaderObjects::CmdBeginRendering(VkCommandBuffer command_buffer,
+                                      VkImageView image_view,
+                                      VkExtent2D extent,
+                                      VkClearColorValue clear_color) const {
+    VkRenderingAttachmentInfoKHR color_attachment{};
+    color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    color_attachment.imageView = image_view;
+    color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color_attachment.resolveMode = VK_RESOLVE_MODE_NONE;
+    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment.clearValue.color = clear_color;
+
+    VkRenderingInfoKHR rendering_info{};
+    rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    rendering_info.renderArea.offset = {0, 0};
+    rendering_info.renderArea.extent = extent;
+    rendering_info.layerCount = 1;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachments = &color_attachment;
+
+    begin_rendering(command_buffer, &rendering_info);
+}
+
+void ShaderObjects::CmdEndRendering(VkCommandBuffer command_buffer) const {
+    end_rendering(command_buffer);
+}
+
+void ShaderObjects::CmdBindShaders(VkCommandBuffer command_buffer,
+                                   const ShaderPair& shaders,
+                                   const RasterState& state,
+                                   VkExtent2D extent) const {
+    std::array<VkShaderStageFlagBits, 2> stages = {
+        VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT};
+    std::array<VkShaderEXT, 2> stage_shaders = {shaders.vertex,
+                                                shaders.fragment};
+    bind_shaders(command_buffer, static_cast<uint32_t>(stages.size()),
+                 stages.data(), stage_shaders.data());
+
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0F;
+    viewport.maxDepth = 1.0F;
+    set_viewport_with_count(command_buffer, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = extent;
+    set_scissor_with_count(command_buffer, 1, &scissor);
+
+    // The vertices are generated in the vertex shader
+    set_vertex_input(command_buffer, 0, nullptr, 0, nullptr);
+
+    // Filled triangles without multisampling, depth bias or stencil, as
+    // every pipeline of the application is created with
+    VkSampleMask sample_mask = ~0U;
+    set_rasterizer_discard_enable(command_buffer, VK_FALSE);
+    set_polygon_mode(command_buffer, VK_POLYGON_MODE_FILL);
+    set_rasterization_samples(command_buffer, VK_SAMPLE_COUNT_1_BIT);
+    set_sample_mask(command_buffer, VK_SAMPLE_COUNT_1_BIT, &sample_mask);
+    set_alpha_to_coverage_enable(command_buffer, VK_FALSE);
+    set_depth_bias_enable(command_buffer, VK_FALSE);
+    set_depth_compare_op(command_buffer, VK_COMPARE_OP_LESS);
+    set_depth_bounds_test_enable(command_buffer, VK_FALSE);
+    set_stencil_test_enable(command_buffer, VK_FALSE);
+
+    raster_state.CmdSetState(command_buffer, state);
+}
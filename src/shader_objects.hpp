@@ -0,0 +1,87 @@
+#ifndef SHADER_OBJECTS_H
+#define SHADER_OBJECTS_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "extended_dynamic_state.hpp"
+
+/* Standard libraries */
+#include <vector>
+
+// Vertex and fragment shader of a draw, bound together but created apart
+struct ShaderPair {
+    VkShaderEXT vertex = VK_NULL_HANDLE;
+    VkShaderEXT fragment = VK_NULL_HANDLE;
+};
+
+/* Device level functions of VK_EXT_shader_object and of the dynamic
+rendering it draws in. A shader object is created straight from SPIR-V and
+bound to its stage on its own, without a pipeline, so a new combination of
+shaders and state never waits for a pipeline to be compiled.
+
+Nothing is baked in, so every state a pipeline would hold has to be set in
+the command buffer before drawing. Only draws without vertex input into a
+single color attachment without depth are supported. */
+class ShaderObjects {
+   private:
+    VkDevice device = VK_NULL_HANDLE;
+    bool enabled = false;
+
+    // The raster state of the draws is set through the functions of the
+    // extended dynamic state extensions, which shader objects provide
+    ExtendedDynamicState raster_state;
+
+    PFN_vkCreateShadersEXT create_shaders = nullptr;
+    PFN_vkDestroyShaderEXT destroy_shader = nullptr;
+    PFN_vkCmdBindShadersEXT bind_shaders = nullptr;
+    PFN_vkCmdBeginRenderingKHR begin_rendering = nullptr;
+    PFN_vkCmdEndRenderingKHR end_rendering = nullptr;
+
+    // State that is part of every pipeline
+    PFN_vkCmdSetViewportWithCountEXT set_viewport_with_count = nullptr;
+    PFN_vkCmdSetScissorWithCountEXT set_scissor_with_count = nullptr;
+    PFN_vkCmdSetVertexInputEXT set_vertex_input = nullptr;
+    PFN_vkCmdSetRasterizerDiscardEnableEXT set_rasterizer_discard_enable =
+        nullptr;
+    PFN_vkCmdSetPolygonModeEXT set_polygon_mode = nullptr;
+    PFN_vkCmdSetRasterizationSamplesEXT set_rasterization_samples = nullptr;
+    PFN_vkCmdSetSampleMaskEXT set_sample_mask = nullptr;
+    PFN_vkCmdSetAlphaToCoverageEnableEXT set_alpha_to_coverage_enable = nullptr;
+    PFN_vkCmdSetDepthBiasEnableEXT set_depth_bias_enable = nullptr;
+    PFN_vkCmdSetDepthCompareOpEXT set_depth_compare_op = nullptr;
+    PFN_vkCmdSetDepthBoundsTestEnableEXT set_depth_bounds_test_enable = nullptr;
+    PFN_vkCmdSetStencilTestEnableEXT set_stencil_test_enable = nullptr;
+
+   public:
+    // Only enabled if the extension and dynamic rendering were enabled on
+    // the device
+    void Init(VkDevice device, bool enabled);
+    bool IsEnabled() const;
+
+    /* The shaders are not linked, so either one can be bound with other
+    shaders later. The descriptor set layouts and push constant ranges must
+    match the pipeline layout their descriptors and constants are bound
+    with. */
+    ShaderPair CreateShaderPair(
+        const std::vector<char>& vert_code, const std::vector<char>& frag_code,
+        const std::vector<VkDescriptorSetLayout>& set_layouts,
+        const std::vector<VkPushConstantRange>& push_constant_ranges) const;
+    void DestroyShaderPair(ShaderPair& shaders) const;
+
+    // Begin drawing into the whole color attachment, which is cleared first
+    // and must be in VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+    void CmdBeginRendering(VkCommandBuffer command_buffer,
+                           VkImageView image_view, VkExtent2D extent,
+                           VkClearColorValue clear_color) const;
+    void CmdEndRendering(VkCommandBuffer command_buffer) const;
+
+    // Binds the shaders and sets every state the draws depend on, with a
+    // viewport and scissor covering the extent
+    void CmdBindShaders(VkCommandBuffer command_buffer,
+                        const ShaderPair& shaders, const RasterState& state,
+                        VkExtent2D extent) const;
+};
+
+#endif  // SHADER_OBJECTS_H
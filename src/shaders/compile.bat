@@ -1,2 +1,14 @@
 glslc.exe shader.vert -o vert.spv
-glslc.exe shader.frag -o frag.spv
\ No newline at end of file
+glslc.exe shader.frag -o frag.spv
+glslc.exe fullscreen.vert -o fullscreen.spv
+glslc.exe composite.frag -o composite.spv
+glslc.exe textured_quad.vert -o textured_quad_vert.spv
+glslc.exe textured_quad.frag -o textured_quad_frag.spv
+glslc.exe --target-env=vulkan1.1 mip_generate.comp -o mip_generate.spv
+glslc.exe bloom_downsample.comp -o bloom_downsample.spv
+glslc.exe bloom_upsample.comp -o bloom_upsample.spv
+glslc.exe tone_map.comp -o tone_map.spv
+glslc.exe color_grade.comp -o color_grade.spv
+glslc.exe rgb_to_yuv.comp -o rgb_to_yuv.spv
+glslc.exe overlay.vert -o overlay_vert.spv
+glslc.exe overlay.frag -o overlay_frag.spv
\ No newline at end of file
@@ -0,0 +1,18 @@
+#!/bin/sh
+# Same as compile.bat, for glslc from the Vulkan SDK or the shaderc package
+cd "$(dirname "$0")" || exit 1
+set -e
+glslc shader.vert -o vert.spv
+glslc shader.frag -o frag.spv
+glslc fullscreen.vert -o fullscreen.spv
+glslc composite.frag -o composite.spv
+glslc textured_quad.vert -o textured_quad_vert.spv
+glslc textured_quad.frag -o textured_quad_frag.spv
+glslc --target-env=vulkan1.1 mip_generate.comp -o mip_generate.spv
+glslc bloom_downsample.comp -o bloom_downsample.spv
+glslc bloom_upsample.comp -o bloom_upsample.spv
+glslc tone_map.comp -o tone_map.spv
+glslc color_grade.comp -o color_grade.spv
+glslc rgb_to_yuv.comp -o rgb_to_yuv.spv
+glslc overlay.vert -o overlay_vert.spv
+glslc overlay.frag -o overlay_frag.spv
@@ -0,0 +1,14 @@
+#version 450
+
+// Coverage of the glyphs in the red channel
+layout(set = 0, binding = 0) uniform sampler2D glyphAtlas;
+
+layout(location = 0) in vec2 fragUv;
+layout(location = 1) in vec4 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    float coverage = texture(glyphAtlas, fragUv).r;
+    outColor = vec4(fragColor.rgb, fragColor.a * coverage);
+}
@@ -0,0 +1,53 @@
+#version 450
+
+// Rectangle of the overlay in pixels, see OverlayQuad
+struct Quad {
+    float x;
+    float y;
+    float width;
+    float height;
+    uint glyph;
+    uint color;
+};
+
+// Slice of the per-frame ring, selected by a dynamic offset
+layout(std430, set = 0, binding = 1) readonly buffer Quads {
+    Quad quads[];
+};
+
+layout(push_constant) uniform Overlay {
+    vec2 pixelToNdc;
+} overlay;
+
+layout(location = 0) out vec2 fragUv;
+layout(location = 1) out vec4 fragColor;
+
+// Must match the layout of the glyph atlas in perf_overlay.hpp
+const uint ATLAS_COLUMNS = 16;
+const uint ATLAS_ROWS = 5;
+const vec2 GLYPH_SIZE = vec2(5.0, 7.0);
+const vec2 CELL_SIZE = vec2(8.0, 8.0);
+
+vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0),
+    vec2(1.0, 0.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(0.0, 1.0),
+    vec2(0.0, 0.0)
+);
+
+void main() {
+    // Every instance is one quad, built from two triangles
+    Quad quad = quads[gl_InstanceIndex];
+    vec2 corner = corners[gl_VertexIndex];
+
+    vec2 size = vec2(quad.width, quad.height);
+    vec2 position = vec2(quad.x, quad.y) + corner * size;
+    gl_Position = vec4(position * overlay.pixelToNdc - 1.0, 0.0, 1.0);
+
+    vec2 cell = vec2(quad.glyph % ATLAS_COLUMNS, quad.glyph / ATLAS_COLUMNS);
+    fragUv = (cell * CELL_SIZE + corner * GLYPH_SIZE) /
+             (vec2(ATLAS_COLUMNS, ATLAS_ROWS) * CELL_SIZE);
+    fragColor = unpackUnorm4x8(quad.color);
+}
@@ -2,6 +2,17 @@
 
 layout(location = 0) out vec3 fragColor;
 
+// 2D camera, see CameraPushConstants
+layout(push_constant) uniform Camera {
+    vec4 transform;
+    vec2 offset;
+} camera;
+
+vec2 ApplyCamera(vec2 position) {
+    return mat2(camera.transform.xy, camera.transform.zw) * position +
+           camera.offset;
+}
+
 vec2 positions[3] = vec2[](
     vec2(0.0, -0.5),
     vec2(0.5, 0.5),
@@ -15,6 +26,6 @@ vec3 colors[3] = vec3[](
 );
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
+    gl_Position = vec4(ApplyCamera(positions[gl_VertexIndex]), 0.0, 1.0);
     fragColor = colors[gl_VertexIndex];
 }
\ No newline at end of file
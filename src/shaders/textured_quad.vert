@@ -0,0 +1,29 @@
+#version 450
+
+layout(location = 0) out vec2 fragUv;
+
+// 2D camera, see CameraPushConstants
+layout(push_constant) uniform Camera {
+    vec4 transform;
+    vec2 offset;
+} camera;
+
+vec2 ApplyCamera(vec2 position) {
+    return mat2(camera.transform.xy, camera.transform.zw) * position +
+           camera.offset;
+}
+
+vec2 uvs[6] = vec2[](
+    vec2(0.0, 0.0),
+    vec2(1.0, 0.0),
+    vec2(1.0, 1.0),
+    vec2(1.0, 1.0),
+    vec2(0.0, 1.0),
+    vec2(0.0, 0.0)
+);
+
+void main() {
+    // A quad covering the center of the screen, built from two triangles
+    fragUv = uvs[gl_VertexIndex];
+    gl_Position = vec4(ApplyCamera(fragUv * 1.5 - 0.75), 0.0, 1.0);
+}
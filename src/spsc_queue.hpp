@@ -0,0 +1,58 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+/* Standard libraries */
+#include <array>
+#include <atomic>
+#include <cstddef>  // Required for size_t
+
+/* Bounded queue between exactly one producer thread and one consumer thread.
+Neither side takes a lock: the producer only writes the tail and the consumer
+only writes the head, and each reads the index of the other side to find out
+whether there is room or something to take. The indices grow without bound
+and are masked into the ring, so the capacity has to be a power of two. */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "capacity must be a power of two");
+
+   private:
+    std::array<T, Capacity> items{};
+
+    // Kept on separate cache lines, so the two threads do not invalidate
+    // each other's line on every push and pop
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+   public:
+    // Producer side. False if the queue is full, in which case the item is
+    // not added.
+    bool Push(const T& item) {
+        size_t current_tail = tail.load(std::memory_order_relaxed);
+        if (current_tail - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+
+        items[current_tail & (Capacity - 1)] = item;
+
+        // Publishes the item to the consumer
+        tail.store(current_tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. False if the queue is empty.
+    bool Pop(T& item) {
+        size_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        item = items[current_head & (Capacity - 1)];
+
+        // Hands the slot back to the producer
+        head.store(current_head + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif  // SPSC_QUEUE_H
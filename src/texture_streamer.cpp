@@ -0,0 +1,702 @@
+/* Local header files */
+#include "texture_streamer.hpp"
+
+/* Standard libraries */
+#include <algorithm>  // Required for std::min
+#include <cstring>
+#include <stdexcept>
+#include <utility>  // Required for std::move
+
+namespace {
+
+// Offsets into the staging buffer must be a multiple of the block size of
+// every supported format
+const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+// Sampled by the fragment shaders of the textured quad
+const SyncScope SAMPLED_READS = {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+                                 VK_ACCESS_2_SHADER_SAMPLED_READ_BIT_KHR};
+
+const SyncScope COPY_WRITES = {VK_PIPELINE_STAGE_2_COPY_BIT_KHR,
+                               VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR};
+
+}  // namespace
+
+void TextureStreamer::Init(VkPhysicalDevice physical_device, VkDevice device,
+                           MipGenerator* mip_generator,
+                           const Synchronization2* synchronization2,
+                           DescriptorAllocator* descriptor_allocator,
+                           bool descriptor_buffer_enabled,
+                           uint32_t frames_in_flight, uint32_t max_textures,
+                           VkDeviceSize memory_budget,
+                           VkDeviceSize staging_slice_size) {
+    this->physical_device = physical_device;
+    this->device = device;
+    this->mip_generator = mip_generator;
+    this->synchronization2 = synchronization2;
+    this->descriptor_allocator = descriptor_allocator;
+    this->frames_in_flight = frames_in_flight;
+    this->max_textures = max_textures;
+    this->memory_budget = memory_budget;
+    this->staging_slice_size = staging_slice_size;
+
+    // Every texture is sampled through a single combined image sampler
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = 1;
+    layout_info.pBindings = &binding;
+    if (descriptor_buffer_enabled) {
+        layout_info.flags =
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+    }
+
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr,
+                                    &descriptor_set_layout) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create texture descriptor set layout!");
+    }
+
+    // Each texture owns a slot for every frame in flight, so a slot can be
+    // rewritten while the other frames are still being rendered
+    if (descriptor_buffer_enabled) {
+        descriptor_buffer.Init(physical_device, device, descriptor_set_layout,
+                               max_textures * frames_in_flight);
+    }
+
+    // Trilinear filtering across the resident mip levels
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_LINEAR;
+    sampler_info.minFilter = VK_FILTER_LINEAR;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.minLod = 0.0F;
+    sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &sampler) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+
+    /* The staging buffer stays mapped for the lifetime of the streamer. A
+    frame only writes into its own slice, which is no longer read by the GPU
+    once the fence of the frame slot has signaled. */
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = staging_slice_size * frames_in_flight;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &buffer_info, nullptr, &staging_buffer) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture staging buffer!");
+    }
+
+    VkMemoryRequirements mem_requirements{};
+    vkGetBufferMemoryRequirements(device, staging_buffer, &mem_requirements);
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex =
+        FindMemoryType(mem_requirements.memoryTypeBits,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                           VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    if (vkAllocateMemory(device, &alloc_info, nullptr,
+                         &staging_buffer_memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate texture staging memory!");
+    }
+
+    vkBindBufferMemory(device, staging_buffer, staging_buffer_memory, 0);
+
+    void* data = nullptr;
+    vkMapMemory(device, staging_buffer_memory, 0, buffer_info.size, 0, &data);
+    staging_data = static_cast<uint8_t*>(data);
+}
+
+void TextureStreamer::Destroy() {
+    ReleaseRetiredResources(true);
+
+    for (auto& texture : textures) {
+        if (texture.view != VK_NULL_HANDLE) {
+            descriptor_allocator->ForgetImageView(texture.view);
+            vkDestroyImageView(device, texture.view, nullptr);
+        }
+        vkDestroyImage(device, texture.image, nullptr);
+        vkFreeMemory(device, texture.memory, nullptr);
+    }
+    textures.clear();
+    allocated_bytes = 0;
+
+    if (staging_buffer != VK_NULL_HANDLE) {
+        vkUnmapMemory(device, staging_buffer_memory);
+        vkDestroyBuffer(device, staging_buffer, nullptr);
+        vkFreeMemory(device, staging_buffer_memory, nullptr);
+        staging_buffer = VK_NULL_HANDLE;
+        staging_data = nullptr;
+    }
+
+    vkDestroySampler(device, sampler, nullptr);
+    descriptor_buffer.Destroy();
+    vkDestroyDescriptorSetLayout(device, descriptor_set_layout, nullptr);
+}
+
+VkDescriptorSetLayout TextureStreamer::GetDescriptorSetLayout() const {
+    return descriptor_set_layout;
+}
+
+VkPipelineCreateFlags TextureStreamer::GetPipelineCreateFlags() const {
+    return descriptor_buffer.IsEnabled()
+               ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT
+               : 0;
+}
+
+uint32_t TextureStreamer::LoadTexture(const std::string& filename) {
+    if (textures.size() >= max_textures) {
+        throw std::runtime_error("too many streamed textures!");
+    }
+
+    StreamedTexture texture;
+    texture.source = Ktx2Image::Load(filename);
+
+    // Decode the texture on the CPU if the device cannot sample its
+    // compressed format, e.g. BC formats on mobile GPUs
+    VkFormatProperties format_properties{};
+    vkGetPhysicalDeviceFormatProperties(
+        physical_device, texture.source.GetFormat(), &format_properties);
+
+    if ((format_properties.optimalTilingFeatures &
+         VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0) {
+        if (!texture.source.CanTranscodeToRgba8()) {
+            throw std::runtime_error(
+                "texture format is not supported by the device: " + filename +
+                "!");
+        }
+        texture.source.TranscodeToRgba8();
+    }
+
+    texture.format = texture.source.GetFormat();
+    texture.level_count = texture.source.GetLevelCount();
+
+    // Generate the missing levels of textures that come without a mip chain
+    VkExtent2D extent = texture.source.GetLevelExtent(0);
+    uint32_t full_level_count = MipGenerator::GetMipLevelCount(extent);
+    if (mip_generator != nullptr && texture.level_count == 1 &&
+        full_level_count > 1 && mip_generator->CanGenerate(texture.format)) {
+        texture.generate_mips = true;
+        texture.level_count = full_level_count;
+    }
+    texture.resident_level = texture.level_count;
+
+    // A single row of blocks has to fit into a slice of the staging buffer
+    if (texture.source.GetLevelRowPitch(0) > staging_slice_size) {
+        throw std::runtime_error("texture is too wide to be streamed: " +
+                                 filename + "!");
+    }
+
+    // Start with as many levels as the remaining budget allows. The smallest
+    // level is always kept. Generated levels need level 0 as their source.
+    uint32_t first_level = 0;
+    while (!texture.generate_mips && first_level + 1 < texture.level_count &&
+           allocated_bytes + EstimateImageSize(texture, first_level) >
+               memory_budget) {
+        first_level++;
+    }
+    AllocateImage(texture, first_level);
+
+    texture.descriptor_versions.resize(frames_in_flight, 0);
+    texture.last_used_frame = frame_number;
+    textures.push_back(std::move(texture));
+
+    return static_cast<uint32_t>(textures.size() - 1);
+}
+
+void TextureStreamer::Update(VkCommandBuffer command_buffer, uint32_t frame) {
+    frame_number++;
+
+    ReleaseRetiredResources(false);
+    EnforceBudget(command_buffer);
+    RecordUploads(command_buffer, frame);
+    UpdateDescriptorBuffer(frame);
+}
+
+bool TextureStreamer::BindTexture(VkCommandBuffer command_buffer,
+                                  VkPipelineLayout pipeline_layout,
+                                  uint32_t texture, uint32_t frame) {
+    // Textures that are drawn are the last ones to be evicted
+    textures[texture].last_used_frame = frame_number;
+
+    if (textures[texture].view == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    if (descriptor_buffer.IsEnabled()) {
+        descriptor_buffer.Bind(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                               pipeline_layout, 0,
+                               texture * frames_in_flight + frame);
+        return true;
+    }
+
+    // The set points at the current view, and is freed along with it
+    DescriptorBinding binding;
+    binding.binding = 0;
+    binding.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.image.sampler = sampler;
+    binding.image.imageView = textures[texture].view;
+    binding.image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkDescriptorSet descriptor_set =
+        descriptor_allocator->GetCachedSet(descriptor_set_layout, {binding});
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            pipeline_layout, 0, 1, &descriptor_set, 0,
+                            nullptr);
+    return true;
+}
+
+void TextureStreamer::SetMemoryBudget(VkDeviceSize memory_budget) {
+    // The new budget is enforced by the next update
+    this->memory_budget = memory_budget;
+}
+
+TextureStreamerStats TextureStreamer::GetStats() const {
+    TextureStreamerStats stats;
+    stats.allocated_bytes = allocated_bytes;
+    stats.budget_bytes = memory_budget;
+    stats.texture_count = static_cast<uint32_t>(textures.size());
+
+    for (const auto& texture : textures) {
+        stats.resident_levels += texture.level_count - texture.resident_level;
+        stats.total_levels += texture.level_count;
+    }
+
+    return stats;
+}
+
+uint32_t TextureStreamer::FindMemoryType(uint32_t type_filter,
+                                         VkMemoryPropertyFlags properties) {
+    VkPhysicalDeviceMemoryProperties mem_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
+
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++) {
+        if ((type_filter & (1U << i)) &&
+            (mem_properties.memoryTypes[i].propertyFlags & properties) ==
+                properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+void TextureStreamer::AllocateImage(StreamedTexture& texture,
+                                    uint32_t first_level) {
+    /* Create an image that holds the levels from first_level down to the
+    smallest one. None of its levels contain any data yet. */
+    VkExtent2D extent = texture.source.GetLevelExtent(first_level);
+
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.extent = {extent.width, extent.height, 1};
+    image_info.mipLevels = texture.level_count - first_level;
+    image_info.arrayLayers = 1;
+    image_info.format = texture.format;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // The levels are copied into another image when the image is resized
+    image_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                       VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                       VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (texture.generate_mips) {
+        image_info.usage |= mip_generator->GetRequiredUsage(texture.format);
+    }
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateImage(device, &image_info, nullptr, &texture.image) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create streamed texture image!");
+    }
+
+    VkMemoryRequirements mem_requirements{};
+    vkGetImageMemoryRequirements(device, texture.image, &mem_requirements);
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    alloc_info.memoryTypeIndex = FindMemoryType(
+        mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (vkAllocateMemory(device, &alloc_info, nullptr, &texture.memory) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate streamed texture memory!");
+    }
+
+    vkBindImageMemory(device, texture.image, texture.memory, 0);
+
+    texture.first_level = first_level;
+    texture.memory_size = mem_requirements.size;
+    allocated_bytes += mem_requirements.size;
+}
+
+void TextureStreamer::RecreateView(StreamedTexture& texture) {
+    // The view only covers the resident levels, so the sampler never reads a
+    // level that is still being uploaded
+    if (texture.view != VK_NULL_HANDLE) {
+        Retire(VK_NULL_HANDLE, VK_NULL_HANDLE, texture.view);
+        texture.view = VK_NULL_HANDLE;
+    }
+
+    texture.view_version++;
+    if (texture.resident_level >= texture.level_count) {
+        return;
+    }
+
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = texture.image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = texture.format;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view_info.subresourceRange.baseMipLevel =
+        texture.resident_level - texture.first_level;
+    view_info.subresourceRange.levelCount =
+        texture.level_count - texture.resident_level;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(device, &view_info, nullptr, &texture.view) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create streamed texture view!");
+    }
+}
+
+void TextureStreamer::Retire(VkImage image, VkDeviceMemory memory,
+                             VkImageView view) {
+    // Frames that are still in flight may reference the resources
+    RetiredResource resource;
+    resource.image = image;
+    resource.memory = memory;
+    resource.view = view;
+    resource.retired_frame = frame_number;
+    retired_resources.push_back(resource);
+}
+
+void TextureStreamer::ReleaseRetiredResources(bool release_all) {
+    auto it = retired_resources.begin();
+    while (it != retired_resources.end()) {
+        if (!release_all &&
+            frame_number < it->retired_frame + frames_in_flight) {
+            ++it;
+            continue;
+        }
+
+        if (it->view != VK_NULL_HANDLE) {
+            descriptor_allocator->ForgetImageView(it->view);
+            vkDestroyImageView(device, it->view, nullptr);
+        }
+        if (it->image != VK_NULL_HANDLE) {
+            vkDestroyImage(device, it->image, nullptr);
+            vkFreeMemory(device, it->memory, nullptr);
+        }
+        it = retired_resources.erase(it);
+    }
+}
+
+void TextureStreamer::Reallocate(VkCommandBuffer command_buffer,
+                                 StreamedTexture& texture,
+                                 uint32_t first_level) {
+    /* Move the texture into an image with a different number of levels. The
+    resident levels that exist in both images are copied on the GPU, a level
+    that was only partially uploaded is streamed again. */
+    VkImage old_image = texture.image;
+    VkDeviceMemory old_memory = texture.memory;
+    uint32_t old_first_level = texture.first_level;
+    allocated_bytes -= texture.memory_size;
+
+    AllocateImage(texture, first_level);
+
+    uint32_t copy_level = std::max(texture.resident_level, first_level);
+    if (copy_level < texture.level_count) {
+        uint32_t copy_count = texture.level_count - copy_level;
+
+        // Earlier frames may still sample the old image, which only has to
+        // finish before the copy reads it
+        barriers.AddImageBarrier(
+            old_image, ColorLevels(copy_level - old_first_level, copy_count),
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR},
+            {VK_PIPELINE_STAGE_2_COPY_BIT_KHR,
+             VK_ACCESS_2_TRANSFER_READ_BIT_KHR});
+        barriers.AddImageBarrier(
+            texture.image, ColorLevels(copy_level - first_level, copy_count),
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, {},
+            COPY_WRITES);
+        barriers.Flush(command_buffer, *synchronization2);
+
+        std::vector<VkImageCopy> regions(copy_count);
+        for (uint32_t i = 0; i < copy_count; i++) {
+            VkExtent2D extent = texture.source.GetLevelExtent(copy_level + i);
+
+            regions[i].srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            regions[i].srcSubresource.mipLevel =
+                copy_level + i - old_first_level;
+            regions[i].srcSubresource.baseArrayLayer = 0;
+            regions[i].srcSubresource.layerCount = 1;
+            regions[i].dstSubresource = regions[i].srcSubresource;
+            regions[i].dstSubresource.mipLevel = copy_level + i - first_level;
+            regions[i].extent = {extent.width, extent.height, 1};
+        }
+
+        vkCmdCopyImage(command_buffer, old_image,
+                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, texture.image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       static_cast<uint32_t>(regions.size()), regions.data());
+
+        // The same texture may be evicted again before the next flush, so
+        // its levels are handed back right away
+        barriers.AddImageBarrier(
+            texture.image, ColorLevels(copy_level - first_level, copy_count),
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, COPY_WRITES,
+            SAMPLED_READS);
+        barriers.Flush(command_buffer, *synchronization2);
+    }
+
+    texture.resident_level = copy_level;
+    texture.uploaded_rows = 0;
+
+    Retire(old_image, old_memory, VK_NULL_HANDLE);
+    RecreateView(texture);
+}
+
+VkDeviceSize TextureStreamer::EstimateImageSize(const StreamedTexture& texture,
+                                                uint32_t first_level) const {
+    // The payload size is close to the size of the image, apart from the
+    // alignment the implementation adds
+    VkDeviceSize size = 0;
+    for (uint32_t level = first_level; level < texture.level_count; level++) {
+        size += texture.source.GetLevelSize(level);
+    }
+    return size;
+}
+
+void TextureStreamer::EnforceBudget(VkCommandBuffer command_buffer) {
+    /* Evict the most detailed level of the least recently used texture until
+    the images fit into the budget again. The largest texture goes first if
+    several were last used in the same frame. */
+    while (allocated_bytes > memory_budget) {
+        StreamedTexture* victim = nullptr;
+        for (auto& texture : textures) {
+            if (texture.first_level + 1 >= texture.level_count) {
+                continue;
+            }
+
+            // Level 0 of a texture that is still being generated has to stay
+            if (texture.generate_mips &&
+                texture.resident_level > texture.first_level) {
+                continue;
+            }
+
+            if (victim == nullptr ||
+                texture.last_used_frame < victim->last_used_frame ||
+                (texture.last_used_frame == victim->last_used_frame &&
+                 texture.memory_size > victim->memory_size)) {
+                victim = &texture;
+            }
+        }
+
+        if (victim == nullptr) {
+            break;
+        }
+
+        Reallocate(command_buffer, *victim, victim->first_level + 1);
+    }
+
+    /* Grow the most recently used, fully streamed texture by one level if it
+    still fits comfortably. Keeping a quarter of the budget as headroom stops
+    textures from bouncing between sizes. */
+    StreamedTexture* candidate = nullptr;
+    for (auto& texture : textures) {
+        if (texture.first_level == 0 ||
+            texture.resident_level != texture.first_level) {
+            continue;
+        }
+
+        if (candidate == nullptr ||
+            texture.last_used_frame > candidate->last_used_frame) {
+            candidate = &texture;
+        }
+    }
+
+    if (candidate != nullptr) {
+        // Only level 0 of a generated chain can be streamed in
+        uint32_t grown_level =
+            candidate->generate_mips ? 0 : candidate->first_level - 1;
+        VkDeviceSize grown_size = EstimateImageSize(*candidate, grown_level);
+        if (allocated_bytes - candidate->memory_size + grown_size <=
+            memory_budget / 4 * 3) {
+            Reallocate(command_buffer, *candidate, grown_level);
+        }
+    }
+}
+
+uint32_t TextureStreamer::NextLevel(const StreamedTexture& texture) const {
+    // Generated chains are filled from level 0, other textures are streamed
+    // from the smallest level up
+    if (texture.generate_mips) {
+        return 0;
+    }
+    return texture.resident_level - 1;
+}
+
+void TextureStreamer::RecordUploads(VkCommandBuffer command_buffer,
+                                    uint32_t frame) {
+    /* Fill the staging slice of the frame with the smallest missing levels
+    across all textures. Levels that do not fit are split into rows of
+    blocks and continued in the next frame. */
+    VkDeviceSize slice_offset = static_cast<VkDeviceSize>(frame) *
+                                staging_slice_size;
+    VkDeviceSize offset = 0;
+
+    while (true) {
+        StreamedTexture* next = nullptr;
+        for (auto& texture : textures) {
+            if (texture.resident_level <= texture.first_level) {
+                continue;
+            }
+
+            if (next == nullptr ||
+                texture.source.GetLevelSize(NextLevel(texture)) <
+                    next->source.GetLevelSize(NextLevel(*next))) {
+                next = &texture;
+            }
+        }
+
+        if (next == nullptr) {
+            break;
+        }
+
+        uint32_t level = NextLevel(*next);
+        uint32_t image_level = level - next->first_level;
+        size_t row_pitch = next->source.GetLevelRowPitch(level);
+        uint32_t block_rows = next->source.GetLevelBlockRows(level);
+
+        offset = (offset + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT *
+                 STAGING_ALIGNMENT;
+        if (offset >= staging_slice_size) {
+            break;
+        }
+
+        auto rows = static_cast<uint32_t>(std::min<VkDeviceSize>(
+            (staging_slice_size - offset) / row_pitch,
+            block_rows - next->uploaded_rows));
+        if (rows == 0) {
+            break;
+        }
+
+        std::memcpy(staging_data + slice_offset + offset,
+                    next->source.GetLevelData(level) +
+                        next->uploaded_rows * row_pitch,
+                    rows * row_pitch);
+
+        if (next->uploaded_rows == 0) {
+            // Recorded together with the levels that are still waiting to be
+            // handed to the shaders. A level that is started never waits for
+            // another one of the batch.
+            barriers.AddImageBarrier(next->image, ColorLevels(image_level, 1),
+                                     VK_IMAGE_LAYOUT_UNDEFINED,
+                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, {},
+                                     COPY_WRITES);
+            barriers.Flush(command_buffer, *synchronization2);
+        }
+
+        // A buffer row length of 0 means the rows of blocks are tightly
+        // packed, which is how KTX2 stores them
+        BlockFormatInfo info = Ktx2Image::GetBlockFormatInfo(next->format);
+        VkExtent2D extent = next->source.GetLevelExtent(level);
+        uint32_t y = next->uploaded_rows * info.block_height;
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = slice_offset + offset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = image_level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, static_cast<int32_t>(y), 0};
+        region.imageExtent = {
+            extent.width,
+            std::min(rows * info.block_height, extent.height - y), 1};
+
+        vkCmdCopyBufferToImage(command_buffer, staging_buffer, next->image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                               &region);
+
+        offset += rows * row_pitch;
+        next->uploaded_rows += rows;
+
+        if (next->uploaded_rows < block_rows) {
+            // The staging slice is full
+            break;
+        }
+
+        if (next->generate_mips) {
+            // The generator also moves level 0 out of the transfer layout. It
+            // only touches this image, none of whose levels are in the batch.
+            mip_generator->Generate(command_buffer, next->image, next->format,
+                                    next->source.GetLevelExtent(0),
+                                    next->level_count);
+        } else {
+            // Nothing samples the level before the end of the frame
+            barriers.AddImageBarrier(next->image, ColorLevels(image_level, 1),
+                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                     COPY_WRITES, SAMPLED_READS);
+        }
+
+        next->resident_level = level;
+        next->uploaded_rows = 0;
+        RecreateView(*next);
+    }
+
+    barriers.Flush(command_buffer, *synchronization2);
+}
+
+void TextureStreamer::UpdateDescriptorBuffer(uint32_t frame) {
+    if (!descriptor_buffer.IsEnabled()) {
+        return;
+    }
+
+    // The slot of this frame is not in use by the GPU anymore, so it can be
+    // pointed at the current view of the texture
+    for (size_t i = 0; i < textures.size(); i++) {
+        StreamedTexture& texture = textures[i];
+        if (texture.view == VK_NULL_HANDLE ||
+            texture.descriptor_versions[frame] == texture.view_version) {
+            continue;
+        }
+
+        VkDescriptorImageInfo image_info{};
+        image_info.sampler = sampler;
+        image_info.imageView = texture.view;
+        image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        descriptor_buffer.WriteCombinedImageSampler(
+            static_cast<uint32_t>(i) * frames_in_flight + frame, 0,
+            image_info);
+        texture.descriptor_versions[frame] = texture.view_version;
+    }
+}
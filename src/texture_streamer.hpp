@@ -0,0 +1,165 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "barrier_batch.hpp"
+#include "descriptor_allocator.hpp"
+#include "descriptor_buffer.hpp"
+#include "ktx2_image.hpp"
+#include "mip_generator.hpp"
+
+/* Standard libraries */
+#include <cstdint>  // Required for uint32_t
+#include <string>
+#include <vector>
+
+// Memory usage and streaming progress of all textures
+struct TextureStreamerStats {
+    VkDeviceSize allocated_bytes = 0;
+    VkDeviceSize budget_bytes = 0;
+    uint32_t texture_count = 0;
+    uint32_t resident_levels = 0;
+    uint32_t total_levels = 0;
+};
+
+/* Streams the mip levels of KTX2 textures to the GPU. Levels are uploaded
+through a per-frame staging buffer, starting with the smallest one, so a
+texture becomes visible at low detail right after it is loaded and sharpens
+over the following frames.
+
+Every texture image only holds the levels from its first allowed level down
+to the smallest one. When the total size of the images exceeds the memory
+budget, the most detailed level of the least recently used texture is
+evicted by copying the remaining levels into a smaller image. Once there is
+enough headroom again, the image grows back and the level is streamed in
+anew.
+
+Textures that are stored with a single level get their mip chain generated
+on the GPU once level 0 has been uploaded. Since only level 0 exists in the
+file, such a texture always grows back to level 0 and regenerates the chain.
+*/
+class TextureStreamer {
+   private:
+    struct StreamedTexture {
+        Ktx2Image source;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t level_count = 0;
+
+        // The levels below level 0 are generated instead of uploaded
+        bool generate_mips = false;
+
+        // Source level stored in level 0 of the image
+        uint32_t first_level = 0;
+
+        // Most detailed source level that has been uploaded completely.
+        // Equal to level_count while no level is resident.
+        uint32_t resident_level = 0;
+
+        // Rows of blocks of the next level that have been uploaded already
+        uint32_t uploaded_rows = 0;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize memory_size = 0;
+
+        // View of the resident levels. It is recreated whenever a level
+        // becomes resident. A descriptor set is cached for every view, and
+        // the slots of the descriptor buffer of every frame are rewritten the
+        // next time the frame is recorded.
+        VkImageView view = VK_NULL_HANDLE;
+        uint64_t view_version = 0;
+        std::vector<uint64_t> descriptor_versions;
+
+        uint64_t last_used_frame = 0;
+    };
+
+    // Resources that are destroyed once the GPU no longer uses them
+    struct RetiredResource {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        uint64_t retired_frame = 0;
+    };
+
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    MipGenerator* mip_generator = nullptr;
+    const Synchronization2* synchronization2 = nullptr;
+    uint32_t frames_in_flight = 0;
+    uint32_t max_textures = 0;
+    VkDeviceSize memory_budget = 0;
+    VkDeviceSize allocated_bytes = 0;
+
+    VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    // Holds a set for every frame slot of every texture when
+    // VK_EXT_descriptor_buffer is enabled. Otherwise the sets are cached by
+    // the allocator.
+    DescriptorAllocator* descriptor_allocator = nullptr;
+    DescriptorBuffer descriptor_buffer;
+
+    // Persistently mapped staging buffer, split into a slice for every frame
+    // in flight
+    VkBuffer staging_buffer = VK_NULL_HANDLE;
+    VkDeviceMemory staging_buffer_memory = VK_NULL_HANDLE;
+    VkDeviceSize staging_slice_size = 0;
+    uint8_t* staging_data = nullptr;
+
+    std::vector<StreamedTexture> textures;
+    std::vector<RetiredResource> retired_resources;
+
+    // Levels that were uploaded and still have to be handed to the shaders.
+    // They are recorded along with the barrier of the next upload, or at the
+    // end of the frame.
+    BarrierBatch barriers;
+    uint64_t frame_number = 0;
+
+    uint32_t FindMemoryType(uint32_t type_filter,
+                            VkMemoryPropertyFlags properties);
+    void AllocateImage(StreamedTexture& texture, uint32_t first_level);
+    void RecreateView(StreamedTexture& texture);
+    void Retire(VkImage image, VkDeviceMemory memory, VkImageView view);
+    void ReleaseRetiredResources(bool release_all);
+    void Reallocate(VkCommandBuffer command_buffer, StreamedTexture& texture,
+                    uint32_t first_level);
+    VkDeviceSize EstimateImageSize(const StreamedTexture& texture,
+                                   uint32_t first_level) const;
+    void EnforceBudget(VkCommandBuffer command_buffer);
+    uint32_t NextLevel(const StreamedTexture& texture) const;
+    void RecordUploads(VkCommandBuffer command_buffer, uint32_t frame);
+    void UpdateDescriptorBuffer(uint32_t frame);
+
+   public:
+    void Init(VkPhysicalDevice physical_device, VkDevice device,
+              MipGenerator* mip_generator,
+              const Synchronization2* synchronization2,
+              DescriptorAllocator* descriptor_allocator,
+              bool descriptor_buffer_enabled, uint32_t frames_in_flight,
+              uint32_t max_textures, VkDeviceSize memory_budget,
+              VkDeviceSize staging_slice_size);
+    void Destroy();
+    VkDescriptorSetLayout GetDescriptorSetLayout() const;
+
+    // Flags of the pipelines that are created with the set layout
+    VkPipelineCreateFlags GetPipelineCreateFlags() const;
+    uint32_t LoadTexture(const std::string& filename);
+
+    // Record the uploads and evictions of a frame. Must be called outside of
+    // a render pass after the fence of the frame slot has signaled.
+    void Update(VkCommandBuffer command_buffer, uint32_t frame);
+
+    // Binds the texture to the first set of the pipeline layout. Returns
+    // false and binds nothing while no level of the texture is resident.
+    bool BindTexture(VkCommandBuffer command_buffer,
+                     VkPipelineLayout pipeline_layout, uint32_t texture,
+                     uint32_t frame);
+
+    void SetMemoryBudget(VkDeviceSize memory_budget);
+    TextureStreamerStats GetStats() const;
+};
+
+#endif  // TEXTURE_STREAMER_H
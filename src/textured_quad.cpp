@@ -0,0 +1,106 @@
+/* Local header files */
+#include "triangle_application.hpp"
+
+void TriangleApplication::InitTextureStreaming() {
+    // Textures without a mip chain get it generated after their upload. The
+    // pipeline keeps its own reference to the shader module.
+    VkShaderModule mip_shader_module =
+        CreateShaderModule(ReadFile("shaders/mip_generate.spv"));
+    mip_generator.Init(physical_device, device, mip_shader_module,
+                       &descriptor_allocator, MAX_FRAMES_IN_FLIGHT);
+    vkDestroyShaderModule(device, mip_shader_module, nullptr);
+
+    texture_streamer.Init(physical_device, device, &mip_generator,
+                          &synchronization2, &descriptor_allocator,
+                          descriptor_buffer_supported, MAX_FRAMES_IN_FLIGHT,
+                          MAX_STREAMED_TEXTURES, TEXTURE_MEMORY_BUDGET,
+                          TEXTURE_STAGING_SIZE);
+
+    // The textured quad reads its texture through the descriptor set layout
+    // of the streamer
+    VkDescriptorSetLayout set_layout =
+        texture_streamer.GetDescriptorSetLayout();
+
+    VkPushConstantRange camera_range{};
+    camera_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    camera_range.offset = 0;
+    camera_range.size = sizeof(CameraPushConstants);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &camera_range;
+
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr,
+                               &textured_pipeline_layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create textured pipeline layout!");
+    }
+    debug_markers.SetName(textured_pipeline_layout,
+                          "textured quad pipeline layout");
+
+    textured_pipeline = CreateVertexlessPipeline(
+        "shaders/textured_quad_vert.spv", "shaders/textured_quad_frag.spv",
+        textured_pipeline_layout, render_pass, QUAD_RASTER_STATE,
+        texture_streamer.GetPipelineCreateFlags());
+
+    if (shader_objects.IsEnabled()) {
+        textured_shaders = shader_objects.CreateShaderPair(
+            ReadFile("shaders/textured_quad_vert.spv"),
+            ReadFile("shaders/textured_quad_frag.spv"), {set_layout},
+            {camera_range});
+        debug_markers.SetName(textured_shaders.vertex, "textured quad vertex");
+        debug_markers.SetName(textured_shaders.fragment,
+                              "textured quad fragment");
+    }
+
+    // The texture is optional, the scene is rendered without it otherwise
+    if (std::ifstream(scene_texture_path).good()) {
+        streamed_texture = texture_streamer.LoadTexture(scene_texture_path);
+    }
+}
+
+void TriangleApplication::CleanupTextureStreaming() {
+    vkDestroyPipeline(device, textured_pipeline, nullptr);
+    vkDestroyPipelineLayout(device, textured_pipeline_layout, nullptr);
+    shader_objects.DestroyShaderPair(textured_shaders);
+
+    texture_streamer.Destroy();
+    mip_generator.Destroy();
+}
+
+void TriangleApplication::RecordTexturedQuad(VkCommandBuffer command_buffer,
+                                             const Camera& view_camera,
+                                             VkExtent2D extent) {
+    /* Draw the streamed texture on a quad. Nothing is drawn until the
+    smallest mip level of the texture has been uploaded. */
+    if (!streamed_texture.has_value()) {
+        return;
+    }
+
+    if (!texture_streamer.BindTexture(command_buffer, textured_pipeline_layout,
+                                      streamed_texture.value(),
+                                      current_frame)) {
+        return;
+    }
+
+    if (shader_objects.IsEnabled()) {
+        shader_objects.CmdBindShaders(command_buffer, textured_shaders,
+                                      QUAD_RASTER_STATE, extent);
+    } else {
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          textured_pipeline);
+        extended_dynamic_state.CmdSetState(command_buffer, QUAD_RASTER_STATE);
+    }
+
+    CameraPushConstants camera_constants =
+        ComputeCameraPushConstants(view_camera, extent);
+    vkCmdPushConstants(command_buffer, textured_pipeline_layout,
+                       VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(camera_constants),
+                       &camera_constants);
+
+    // Two triangles generated in the vertex shader
+    vkCmdDraw(command_buffer, 6, 1, 0, 0);
+    draw_counts.draws++;
+}
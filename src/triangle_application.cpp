@@ -1,23 +1,93 @@
 /* Local header files */
 #include "triangle_application.hpp"
 
+namespace {
+
+// Adds the milliseconds since the start of a phase to its sum. Returns the
+// end of the phase, which starts the next one.
+std::chrono::steady_clock::time_point EndPhase(
+    double& sum, std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    sum += std::chrono::duration<double, std::milli>(end - start).count();
+    return end;
+}
+
+}  // namespace
+
 bool TriangleApplication::QueueFamilyIndices::IsComplete() {
     // Checks if the graphicsFamily and presentFamily objects
     // contain a value
     return graphics_family.has_value() && present_family.has_value();
 }
 
+TriangleApplication::TriangleApplication(const AppOptions& options)
+    : options(options) {}
+
 void TriangleApplication::Run() {
-    InitWindow();
+    // The KTX2 files are checked on the CPU alone
+    if (!options.ktx2_validation_dir.empty()) {
+        if (!ValidateKtx2Files(options.ktx2_validation_dir)) {
+            throw std::runtime_error("KTX2 validation failed!");
+        }
+        return;
+    }
+
+    // The job decides the size of the offscreen images and the scene
+    if (!options.batch_job_path.empty()) {
+        batch_job = LoadBatchJob(options.batch_job_path);
+        offscreen_extent = batch_job.resolution.width > 0
+                               ? batch_job.resolution
+                               : batch_job.views.front().resolution;
+        scene_texture_path = batch_job.scene;
+    }
+
+    if (!options.headless) {
+        InitWindow();
+    }
     InitVulkan();
-    MainLoop();
+
+    // The benchmark, the golden images and batch jobs replace the main loop
+    // and exit once they are done
+    bool succeeded = true;
+    if (options.benchmark_mips) {
+        RunMipBenchmark();
+    } else if (!options.batch_job_path.empty()) {
+        succeeded = RunBatchJob();
+    } else if (!options.golden_dir.empty()) {
+        succeeded = RunGoldenImages();
+    } else {
+        MainLoop();
+    }
+
     CleanUp();
+
+    if (!succeeded) {
+        throw std::runtime_error(options.batch_job_path.empty()
+                                     ? "golden image comparison failed!"
+                                     : "failed to write every frame!");
+    }
 }
 
 void TriangleApplication::InitWindow() {
     /* Initialize the GLFW window */
+    // GLFW picks the window system by itself unless one was requested. The
+    // hint is only known to GLFW 3.4 and later.
+#ifdef GLFW_PLATFORM
+    if (options.window_platform == WINDOW_PLATFORM_X11) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11);
+    } else if (options.window_platform == WINDOW_PLATFORM_WAYLAND) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_WAYLAND);
+    }
+#else
+    if (options.window_platform != WINDOW_PLATFORM_AUTO) {
+        throw std::runtime_error("choosing a platform requires GLFW 3.4!");
+    }
+#endif
+
     // Initialize GLFW libary
-    glfwInit();
+    if (glfwInit() != GLFW_TRUE) {
+        throw std::runtime_error("failed to initialize GLFW!");
+    }
 
     // Inform GLFW to not create an OpenGL context
     // GLFW was originally designed to create an OpenGL context
@@ -34,46 +104,235 @@ void TriangleApplication::InitWindow() {
 
     // Detect resizes
     glfwSetFramebufferSizeCallback(window, FramebufferResizeCallback);
+
+    // Keyboard shortcuts to toggle the post-processing stages
+    glfwSetKeyCallback(window, KeyCallback);
+
+    // Later sizes arrive as resize events
+    int width = 0;
+    int height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    framebuffer_size = {static_cast<uint32_t>(width),
+                        static_cast<uint32_t>(height)};
+
+    // Frame pacing without present timing runs at the refresh rate of the
+    // display
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* video_mode =
+        monitor != nullptr ? glfwGetVideoMode(monitor) : nullptr;
+    if (video_mode != nullptr) {
+        display_refresh_rate = video_mode->refreshRate;
+    }
 }
 
 void TriangleApplication::InitVulkan() {
     /* Initialize Vulkan */
     CreateInstance();
     SetupDebugMessenger();
-    CreateSurface();
+
+    // Headless rendering has no window to present to
+    if (!options.headless) {
+        CreateSurface();
+    }
     PickPhysicalDevice();
+    CreateDeviceResources();
+
+    if (!options.headless) {
+        frame_pacer.Init(device, present_wait_supported, display_refresh_rate,
+                         options.latency_log_path);
+    }
+
+    // Captured frames are encoded and written on worker threads
+    image_writer.Start(options.batch_job_path.empty()
+                           ? IMAGE_WRITER_THREADS
+                           : BATCH_IMAGE_WRITER_THREADS);
+
+    if (!options.video_path.empty()) {
+        InitVideoCapture();
+    }
+
+    if (!options.metrics_file_path.empty() ||
+        !options.metrics_socket_path.empty()) {
+        metrics.Start(physical_device, memory_budget_supported,
+                      options.metrics_file_path, options.metrics_socket_path,
+                      std::chrono::seconds(options.metrics_interval));
+    }
+
+    if (!batch_job.views.empty()) {
+        CreateRenderViews(batch_job.views);
+    }
+
+    if (options.window_count > 1) {
+        CreateSecondaryWindows();
+    }
+}
+
+void TriangleApplication::CreateDeviceResources() {
     CreateLogicalDevice();
-    CreateSwapChain();
-    CreateImageViews();
+    if (options.headless) {
+        CreateOffscreenTargets();
+    } else {
+        CreateSwapChain();
+        CreateImageViews();
+    }
     CreateRenderPass();
+    CreateCompositeRenderPass();
     CreateGraphicsPipeline();
+    CreatePostProcessingPipelines();
+    CreateCompositePipeline();
     CreateFramebuffers();
     CreateCommandPool();
+    CreateColorGradingLut();
+    descriptor_allocator.Init(device, MAX_FRAMES_IN_FLIGHT);
+    InitTextureStreaming();
+    CreatePostProcessTarget(post_target, GetRenderExtent(swap_chain_extent),
+                            "main");
+    InitPerfOverlay();
     CreateCommandBuffers();
     CreateSyncObjects();
+
+    // Every profiler scope leaves a breadcrumb
+    uint32_t max_scopes = GetGpuProfilerScopeCount();
+    breadcrumbs.Init(physical_device, device, MAX_FRAMES_IN_FLIGHT,
+                     max_scopes, buffer_marker_supported, debug_markers);
+
+    QueueFamilyIndices indices = FindQueueFamilies(physical_device);
+    gpu_profiler.Init(physical_device, device, indices.graphics_family.value(),
+                      MAX_FRAMES_IN_FLIGHT, max_scopes,
+                      pipeline_statistics_supported, debug_markers,
+                      breadcrumbs);
+
+    frame_readback.Init(physical_device, device, MAX_FRAMES_IN_FLIGHT);
+}
+
+uint32_t TriangleApplication::GetGpuProfilerScopeCount() const {
+    // Secondary windows record the same passes as a view
+    uint32_t view_count = static_cast<uint32_t>(batch_job.views.size()) +
+                          options.window_count - 1;
+    return MAX_GPU_PROFILER_SCOPES + view_count * GPU_PROFILER_SCOPES_PER_VIEW;
 }
 
 void TriangleApplication::MainLoop() {
-    /* Main game loop */
-    while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-        DrawFrame();
+    /* Main game loop
+    The main thread sleeps until window events arrive and passes them on to
+    the render thread, which draws frames as fast as presentation allows. A
+    resize drag or a burst of input therefore never holds up a frame. */
+    render_thread_running = true;
+    render_thread = std::thread(&TriangleApplication::RenderLoop, this);
+
+    while (render_thread_running && !IsAnyWindowClosed()) {
+        glfwWaitEvents();
+
+        std::string title;
+        {
+            std::lock_guard<std::mutex> lock(window_title_mutex);
+            title.swap(pending_window_title);
+        }
+        if (!title.empty()) {
+            glfwSetWindowTitle(window, title.c_str());
+        }
     }
 
+    render_thread_running = false;
+    render_thread.join();
+
     /* This helps to prevent any asynchronous issues with drawing a frame
     with the drawFrame method. It is not a good idea to clean up resources
     while drawing and presenation operations are happening. */
 
     // Wait for operations in a specific command queue to be finished
     vkDeviceWaitIdle(device);
+
+    // Errors of the render thread are reported once both threads are done
+    if (render_thread_error) {
+        std::rethrow_exception(render_thread_error);
+    }
+}
+
+void TriangleApplication::RenderLoop() {
+    last_frame_start = std::chrono::steady_clock::now();
+
+    try {
+        while (render_thread_running) {
+            // Input is picked up after the pacer, so it is as recent as
+            // possible when the frame is shown
+            uint32_t previous_frame =
+                (current_frame + MAX_FRAMES_IN_FLIGHT - 1) %
+                MAX_FRAMES_IN_FLIGHT;
+            frame_pacer.WaitForFrameStart(swap_chain,
+                                          in_flight_fences[previous_frame],
+                                          GetGpuFrameTime());
+            ProcessWindowEvents();
+
+            // Nothing can be presented to a minimized window
+            if (IsAnyWindowMinimized()) {
+                std::this_thread::sleep_for(MINIMIZED_WAIT_INTERVAL);
+                continue;
+            }
+
+            DrawFrame();
+        }
+    } catch (...) {
+        render_thread_error = std::current_exception();
+    }
+
+    // Wakes up the main thread if it is waiting for events
+    render_thread_running = false;
+    glfwPostEmptyEvent();
 }
 
 void TriangleApplication::CleanUp() {
     /* Clean up resources */
+    DestroyRenderViews();
+    DestroySecondaryWindows();
+
+    // Writes the final metrics while the physical device can still be
+    // queried for its memory budget
+    metrics.Stop();
+
+    // The device is idle, so captures that are still in flight can be
+    // handed to the writer, which finishes them before it stops
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        frame_readback.Collect(i, image_writer);
+    }
+    image_writer.Stop();
+
+    // Writes the frames that are still queued
+    video_capture.Destroy();
+
+    DestroyDeviceResources();
+
+    if (options.validation) {
+        DestroyDebugUtilsMessengerEXT(instance, debug_messenger, nullptr);
+    }
+
+    vkDestroySurfaceKHR(instance, surface, nullptr);
+    vkDestroyInstance(instance, nullptr);
+
+    // The instance reports until it is destroyed
+    diagnostics_log.Stop();
+
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+}
+
+void TriangleApplication::DestroyDeviceResources() {
     CleanupSwapChain();
+    DestroyPostProcessTarget(post_target);
+    CleanupPostProcessing();
+    CleanupTextureStreaming();
+    CleanupPerfOverlay();
+    descriptor_allocator.Destroy();
+
+    gpu_profiler.Destroy();
+    breadcrumbs.Destroy();
+    frame_readback.Destroy();
 
     vkDestroyPipeline(device, graphics_pipeline, nullptr);
     vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
+    shader_objects.DestroyShaderPair(triangle_shaders);
 
     vkDestroyRenderPass(device, render_pass, nullptr);
 
@@ -86,17 +345,6 @@ void TriangleApplication::CleanUp() {
     vkDestroyCommandPool(device, command_pool, nullptr);
 
     vkDestroyDevice(device, nullptr);
-
-    if (ENABLE_VALIDATION_LAYERS) {
-        DestroyDebugUtilsMessengerEXT(instance, debug_messenger, nullptr);
-    }
-
-    vkDestroySurfaceKHR(instance, surface, nullptr);
-    vkDestroyInstance(instance, nullptr);
-
-    glfwDestroyWindow(window);
-
-    glfwTerminate();
 }
 
 void TriangleApplication::CheckExtensionSupport() {
@@ -118,7 +366,7 @@ void TriangleApplication::CheckExtensionSupport() {
 
 void TriangleApplication::CreateInstance() {
     /* Create instance */
-    if (ENABLE_VALIDATION_LAYERS && !CheckValidationLayerSupport()) {
+    if (options.validation && !CheckValidationLayerSupport()) {
         throw std::runtime_error(
             "validation layers requested, but not available!");
     }
@@ -131,7 +379,7 @@ void TriangleApplication::CreateInstance() {
     app_info.applicationVersion = VK_MAKE_VERSION(0, 1, 0);
     app_info.pEngineName = "No Engine";
     app_info.engineVersion = VK_MAKE_VERSION(0, 1, 0);
-    app_info.apiVersion = VK_API_VERSION_1_0;
+    app_info.apiVersion = VK_API_VERSION_1_1;
 
     // Informs the Vulkan driver which global extensions and
     // validation layers we want to use
@@ -139,6 +387,13 @@ void TriangleApplication::CreateInstance() {
     create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     create_info.pApplicationInfo = &app_info;
 
+    // Debug builds name objects for graphics debuggers, which takes the
+    // debug utils extension even without the validation layers
+    debug_utils_enabled =
+        options.validation ||
+        (DEBUG_MARKERS_ENABLED &&
+         IsInstanceExtensionSupported(VK_EXT_DEBUG_UTILS_EXTENSION_NAME));
+
     // Retreive the required list of extensions
     auto extensions = GetRequiredExtensions();
 
@@ -149,14 +404,41 @@ void TriangleApplication::CreateInstance() {
 
     VkDebugUtilsMessengerCreateInfoEXT debug_create_info{};
 
+    // The heavier checks of the validation layers are opt-in. GPU-assisted
+    // validation takes one descriptor set binding for itself.
+    std::vector<VkValidationFeatureEnableEXT> enabled_features;
+    if (options.gpu_assisted_validation) {
+        enabled_features.push_back(
+            VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT);
+        enabled_features.push_back(
+            VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_RESERVE_BINDING_SLOT_EXT);
+    }
+    if (options.sync_validation) {
+        enabled_features.push_back(
+            VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT);
+    }
+
+    VkValidationFeaturesEXT validation_features{};
+    validation_features.sType = VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT;
+    validation_features.enabledValidationFeatureCount =
+        static_cast<uint32_t>(enabled_features.size());
+    validation_features.pEnabledValidationFeatures = enabled_features.data();
+
     // Modify the VkInstanceCreateInfo struct to include the validation layer
     // names if they are enabled
-    if (ENABLE_VALIDATION_LAYERS) {
+    if (options.validation) {
         create_info.enabledLayerCount =
             static_cast<uint32_t>(VALIDATION_LAYERS.size());
         create_info.ppEnabledLayerNames = VALIDATION_LAYERS.data();
 
+        // Messages of instance creation and destruction go to the log as
+        // well, so it runs before the instance exists
+        diagnostics_log.Start();
+
         PopulateDebugMessengerCreateInfo(debug_create_info);
+        if (!enabled_features.empty()) {
+            debug_create_info.pNext = &validation_features;
+        }
         create_info.pNext = &debug_create_info;
     } else {
         create_info.enabledLayerCount = 0;
@@ -201,23 +483,49 @@ bool TriangleApplication::CheckValidationLayerSupport() {
     return true;
 }
 
-std::vector<const char*> TriangleApplication::GetRequiredExtensions() {
+bool TriangleApplication::IsInstanceExtensionSupported(
+    const char* extension_name) {
+    uint32_t extension_count = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, nullptr);
+
+    std::vector<VkExtensionProperties> extensions(extension_count);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extension_count,
+                                           extensions.data());
+
+    return std::any_of(extensions.begin(), extensions.end(),
+                       [extension_name](const VkExtensionProperties& e) {
+                           return strcmp(e.extensionName, extension_name) == 0;
+                       });
+}
+
+std::vector<const char*> TriangleApplication::GetRequiredExtensions() const {
     /* Retrieve the required list of extensions based on if the
     validation layers are enabled or disabled */
-    uint32_t glfw_extension_count = 0;
-    const char** glfw_extensions = nullptr;
+    std::vector<const char*> extensions;
 
-    // This function returns an array of required Vulkan instance extensions
-    // for creating Vulkan surfaces on GLFW windows
-    glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+    // Without a window no surface is created, so GLFW is never initialized
+    if (!options.headless) {
+        uint32_t glfw_extension_count = 0;
+        const char** glfw_extensions = nullptr;
 
-    std::vector<const char*> extensions(glfw_extensions,
-                                        glfw_extensions + glfw_extension_count);
+        // This function returns an array of required Vulkan instance
+        // extensions for creating Vulkan surfaces on GLFW windows
+        glfw_extensions =
+            glfwGetRequiredInstanceExtensions(&glfw_extension_count);
 
-    if (ENABLE_VALIDATION_LAYERS) {
+        extensions.assign(glfw_extensions,
+                          glfw_extensions + glfw_extension_count);
+    }
+
+    if (debug_utils_enabled) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
 
+    // Provided by the validation layer
+    if (options.gpu_assisted_validation || options.sync_validation) {
+        extensions.push_back(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+    }
+
     return extensions;
 }
 
@@ -226,24 +534,17 @@ VKAPI_ATTR VkBool32 VKAPI_CALL TriangleApplication::DebugCallback(
     VkDebugUtilsMessageTypeFlagsEXT message_type,
     const VkDebugUtilsMessengerCallbackDataEXT* p_callback_data,
     void* p_user_data) {
-    /* Debug to the console for validation layers */
-    std::string debug_msg = "validation layer: " +
-                            static_cast<std::string>(p_callback_data->pMessage);
-    std::cerr << debug_msg << std::endl;
-    OutputDebugStringA(debug_msg.c_str());
-
-    if (message_severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
-        // Message is important enought to show
-        debug_msg = "validation layer ERROR: " +
-                    static_cast<std::string>(p_callback_data->pMessage);
-        throw std::runtime_error(debug_msg.c_str());
-    }
+    /* Hand the message to the log of the application. This runs on the
+    thread that made the Vulkan call, so it must neither block nor throw. */
+    auto* diagnostics_log = static_cast<DiagnosticsLog*>(p_user_data);
+    diagnostics_log->Report(message_severity, *p_callback_data);
 
+    // The call that triggered the message is not aborted
     return VK_FALSE;
 }
 
 void TriangleApplication::SetupDebugMessenger() {
-    if (!ENABLE_VALIDATION_LAYERS) {
+    if (!options.validation) {
         return;
     }
 
@@ -301,6 +602,7 @@ void TriangleApplication::PopulateDebugMessengerCreateInfo(
                               VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
                               VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
     create_info.pfnUserCallback = DebugCallback;
+    create_info.pUserData = &diagnostics_log;
 }
 
 void TriangleApplication::PickPhysicalDevice() {
@@ -337,10 +639,10 @@ bool TriangleApplication::IsDeviceSuitable(VkPhysicalDevice device) {
     bool extensions_supported = CheckDeviceExtensionSupport(device);
 
     // Verify swap chain support is adequate
-    bool swap_chain_adequate = false;
-    if (extensions_supported) {
+    bool swap_chain_adequate = options.headless;
+    if (extensions_supported && !options.headless) {
         SwapChainSupportDetails swap_chain_support =
-            QuerySwapChainSupport(device);
+            QuerySwapChainSupport(device, surface);
         swap_chain_adequate = !swap_chain_support.formats.empty() &&
                               !swap_chain_support.present_modes.empty();
     }
@@ -372,8 +674,16 @@ TriangleApplication::QueueFamilyIndices TriangleApplication::FindQueueFamilies(
         // Look for a queue family that is capable of presenting to the window
         // surface
         VkBool32 present_support = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface,
-                                             &present_support);
+        if (surface != VK_NULL_HANDLE) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface,
+                                                 &present_support);
+        } else {
+            // Nothing is presented without a surface, the graphics queue
+            // stands in for the present queue
+            if (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+                present_support = VK_TRUE;
+            }
+        }
 
         if (present_support) {
             indices.present_family = i;
@@ -420,7 +730,254 @@ void TriangleApplication::CreateLogicalDevice() {
     }
 
     // Specify the device features to be used
+    VkPhysicalDeviceFeatures supported_features{};
+    vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+
+    // Enable every block compression family the device supports, so that
+    // compressed textures can be sampled without decoding them first
     VkPhysicalDeviceFeatures device_features{};
+    device_features.textureCompressionBC =
+        supported_features.textureCompressionBC;
+    device_features.textureCompressionETC2 =
+        supported_features.textureCompressionETC2;
+    device_features.textureCompressionASTC_LDR =
+        supported_features.textureCompressionASTC_LDR;
+
+    // The mip generator writes every level through an array of storage
+    // images indexed in the shader
+    device_features.shaderStorageImageArrayDynamicIndexing =
+        supported_features.shaderStorageImageArrayDynamicIndexing;
+
+    // The GPU profiler counts the invocations of every scope if it can
+    device_features.pipelineStatisticsQuery =
+        supported_features.pipelineStatisticsQuery;
+    pipeline_statistics_supported =
+        supported_features.pipelineStatisticsQuery == VK_TRUE;
+
+    // GPU-assisted validation writes its findings from the shaders
+    if (options.gpu_assisted_validation) {
+        device_features.fragmentStoresAndAtomics =
+            supported_features.fragmentStoresAndAtomics;
+        device_features.vertexPipelineStoresAndAtomics =
+            supported_features.vertexPipelineStoresAndAtomics;
+    }
+
+    // The frame pacer waits for presents if the device can tell when a frame
+    // is shown. Nothing is presented without a window.
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{};
+    present_wait_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features{};
+    present_id_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    present_id_features.pNext = &present_wait_features;
+
+    if (!options.headless &&
+        std::all_of(PRESENT_TIMING_EXTENSIONS.begin(),
+                    PRESENT_TIMING_EXTENSIONS.end(),
+                    [this](const char* extension_name) {
+                        return IsDeviceExtensionSupported(physical_device,
+                                                          extension_name);
+                    })) {
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &present_id_features;
+        vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+        present_wait_supported = present_id_features.presentId == VK_TRUE &&
+                                 present_wait_features.presentWait == VK_TRUE;
+    }
+
+    std::vector<const char*> extensions(DEVICE_EXTENSIONS.begin(),
+                                        DEVICE_EXTENSIONS.end());
+    if (present_wait_supported) {
+        extensions.insert(extensions.end(), PRESENT_TIMING_EXTENSIONS.begin(),
+                          PRESENT_TIMING_EXTENSIONS.end());
+    }
+
+    // Only adds a query, so it is enabled wherever it is available
+    memory_budget_supported = IsDeviceExtensionSupported(
+        physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memory_budget_supported) {
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    // Breadcrumbs written by the pipeline stages, without a barrier
+    buffer_marker_supported = IsDeviceExtensionSupported(
+        physical_device, VK_AMD_BUFFER_MARKER_EXTENSION_NAME);
+    if (buffer_marker_supported) {
+        extensions.push_back(VK_AMD_BUFFER_MARKER_EXTENSION_NAME);
+    }
+
+    // Barriers and submissions with exact stages and accesses
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2_features{};
+    synchronization2_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+
+    synchronization2_supported = false;
+    if (IsDeviceExtensionSupported(physical_device,
+                                   VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &synchronization2_features;
+        vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+        synchronization2_supported =
+            synchronization2_features.synchronization2 == VK_TRUE;
+    }
+    if (synchronization2_supported) {
+        extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    }
+
+    // Descriptors written into memory instead of updated through sets. The
+    // extension depends on synchronization2.
+    VkPhysicalDeviceBufferDeviceAddressFeaturesKHR buffer_address_features{};
+    buffer_address_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_KHR;
+
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer_features{};
+    descriptor_buffer_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+    descriptor_buffer_features.pNext = &buffer_address_features;
+
+    descriptor_buffer_supported = false;
+    if (synchronization2_supported &&
+        std::all_of(DESCRIPTOR_BUFFER_EXTENSIONS.begin(),
+                    DESCRIPTOR_BUFFER_EXTENSIONS.end(),
+                    [this](const char* extension_name) {
+                        return IsDeviceExtensionSupported(physical_device,
+                                                          extension_name);
+                    })) {
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &descriptor_buffer_features;
+        vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+        descriptor_buffer_supported =
+            descriptor_buffer_features.descriptorBuffer == VK_TRUE &&
+            buffer_address_features.bufferDeviceAddress == VK_TRUE;
+    }
+    if (descriptor_buffer_supported) {
+        extensions.insert(extensions.end(),
+                          DESCRIPTOR_BUFFER_EXTENSIONS.begin(),
+                          DESCRIPTOR_BUFFER_EXTENSIONS.end());
+
+        // Only the features that are used are enabled
+        descriptor_buffer_features.descriptorBufferCaptureReplay = VK_FALSE;
+        descriptor_buffer_features.descriptorBufferImageLayoutIgnored =
+            VK_FALSE;
+        descriptor_buffer_features.descriptorBufferPushDescriptors = VK_FALSE;
+        buffer_address_features.bufferDeviceAddressCaptureReplay = VK_FALSE;
+        buffer_address_features.bufferDeviceAddressMultiDevice = VK_FALSE;
+    }
+
+    // Raster state set in the command buffer instead of baked into the
+    // pipelines. Every extension builds on the ones before it, so the level
+    // ends at the first one that is missing.
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT dynamic_state_features{};
+    dynamic_state_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+
+    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT
+        dynamic_state2_features{};
+    dynamic_state2_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT
+        dynamic_state3_features{};
+    dynamic_state3_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+    uint32_t dynamic_state_extensions = 0;
+    for (const char* extension_name : EXTENDED_DYNAMIC_STATE_EXTENSIONS) {
+        if (!IsDeviceExtensionSupported(physical_device, extension_name)) {
+            break;
+        }
+        dynamic_state_extensions++;
+    }
+
+    extended_dynamic_state_level = 0;
+    if (dynamic_state_extensions > 0) {
+        // Only the features of the supported extensions can be queried
+        dynamic_state_features.pNext =
+            dynamic_state_extensions > 1 ? &dynamic_state2_features : nullptr;
+        dynamic_state2_features.pNext =
+            dynamic_state_extensions > 2 ? &dynamic_state3_features : nullptr;
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &dynamic_state_features;
+        vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+        std::array<bool, 3> level_supported = {
+            dynamic_state_features.extendedDynamicState == VK_TRUE,
+            dynamic_state2_features.extendedDynamicState2 == VK_TRUE,
+            dynamic_state3_features.extendedDynamicState3ColorBlendEnable ==
+                    VK_TRUE &&
+                dynamic_state3_features
+                        .extendedDynamicState3ColorBlendEquation == VK_TRUE &&
+                dynamic_state3_features.extendedDynamicState3ColorWriteMask ==
+                    VK_TRUE,
+        };
+        while (extended_dynamic_state_level < dynamic_state_extensions &&
+               level_supported[extended_dynamic_state_level]) {
+            extended_dynamic_state_level++;
+        }
+    }
+    if (extended_dynamic_state_level > 0) {
+        extensions.insert(extensions.end(),
+                          EXTENDED_DYNAMIC_STATE_EXTENSIONS.begin(),
+                          EXTENDED_DYNAMIC_STATE_EXTENSIONS.begin() +
+                              extended_dynamic_state_level);
+
+        // Only the features that are used are enabled
+        dynamic_state2_features.extendedDynamicState2LogicOp = VK_FALSE;
+        dynamic_state2_features.extendedDynamicState2PatchControlPoints =
+            VK_FALSE;
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT blend_features{};
+        blend_features.sType = dynamic_state3_features.sType;
+        blend_features.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+        blend_features.extendedDynamicState3ColorBlendEquation = VK_TRUE;
+        blend_features.extendedDynamicState3ColorWriteMask = VK_TRUE;
+        dynamic_state3_features = blend_features;
+    }
+
+    // Shaders bound without pipelines, which draw with dynamic rendering.
+    // Only enabled if the path was chosen at startup, and required then.
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_features{};
+    dynamic_rendering_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    VkPhysicalDeviceShaderObjectFeaturesEXT shader_object_features{};
+    shader_object_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+    shader_object_features.pNext = &dynamic_rendering_features;
+
+    bool shader_object_enabled = false;
+    if (options.render_path == RENDER_PATH_SHADER_OBJECT) {
+        if (std::all_of(SHADER_OBJECT_EXTENSIONS.begin(),
+                        SHADER_OBJECT_EXTENSIONS.end(),
+                        [this](const char* extension_name) {
+                            return IsDeviceExtensionSupported(physical_device,
+                                                              extension_name);
+                        })) {
+            VkPhysicalDeviceFeatures2 features{};
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features.pNext = &shader_object_features;
+            vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+            shader_object_enabled =
+                shader_object_features.shaderObject == VK_TRUE &&
+                dynamic_rendering_features.dynamicRendering == VK_TRUE;
+        }
+        if (!shader_object_enabled) {
+            throw std::runtime_error(
+                "shader objects are not supported by the device!");
+        }
+        extensions.insert(extensions.end(), SHADER_OBJECT_EXTENSIONS.begin(),
+                          SHADER_OBJECT_EXTENSIONS.end());
+    }
 
     // Create the logical device
     VkDeviceCreateInfo create_info{};
@@ -430,15 +987,47 @@ void TriangleApplication::CreateLogicalDevice() {
     create_info.pQueueCreateInfos = queue_create_infos.data();
     create_info.pEnabledFeatures = &device_features;
 
+    // Chain the features of the optional extensions that are enabled
+    void* enabled_features = nullptr;
+    if (shader_object_enabled) {
+        dynamic_rendering_features.pNext = enabled_features;
+        enabled_features = &shader_object_features;
+    }
+    if (extended_dynamic_state_level >= 3) {
+        dynamic_state3_features.pNext = enabled_features;
+        enabled_features = &dynamic_state3_features;
+    }
+    if (extended_dynamic_state_level >= 2) {
+        dynamic_state2_features.pNext = enabled_features;
+        enabled_features = &dynamic_state2_features;
+    }
+    if (extended_dynamic_state_level >= 1) {
+        dynamic_state_features.pNext = enabled_features;
+        enabled_features = &dynamic_state_features;
+    }
+    if (descriptor_buffer_supported) {
+        buffer_address_features.pNext = enabled_features;
+        enabled_features = &descriptor_buffer_features;
+    }
+    if (synchronization2_supported) {
+        synchronization2_features.pNext = enabled_features;
+        enabled_features = &synchronization2_features;
+    }
+    if (present_wait_supported) {
+        present_wait_features.pNext = enabled_features;
+        enabled_features = &present_id_features;
+    }
+    create_info.pNext = enabled_features;
+
     // Enabling device extensions
     // Using a swapchain requires enabling the VK_KHR_swapchain
     create_info.enabledExtensionCount =
-        static_cast<uint32_t>(DEVICE_EXTENSIONS.size());
-    create_info.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
+        static_cast<uint32_t>(extensions.size());
+    create_info.ppEnabledExtensionNames = extensions.data();
 
     // Specify the validation layers for the logical device if the validation
     // layers is enabled
-    if (ENABLE_VALIDATION_LAYERS) {
+    if (options.validation) {
         create_info.enabledLayerCount =
             static_cast<uint32_t>(VALIDATION_LAYERS.size());
         create_info.ppEnabledLayerNames = VALIDATION_LAYERS.data();
@@ -463,6 +1052,19 @@ void TriangleApplication::CreateLogicalDevice() {
         throw std::runtime_error(
             "Indices's graphics and present Families contain no value!");
     }
+
+    // Every object created from here on is named
+    if (debug_utils_enabled) {
+        debug_markers.Init(instance, device);
+    }
+    debug_markers.SetName(graphics_queue, "graphics queue");
+    if (present_queue != graphics_queue) {
+        debug_markers.SetName(present_queue, "present queue");
+    }
+
+    synchronization2.Init(device, synchronization2_supported);
+    extended_dynamic_state.Init(device, extended_dynamic_state_level);
+    shader_objects.Init(device, shader_object_enabled);
 }
 
 void TriangleApplication::CreateSurface() {
@@ -494,34 +1096,54 @@ bool TriangleApplication::CheckDeviceExtensionSupport(VkPhysicalDevice device) {
     return required_extensions.empty();
 }
 
+bool TriangleApplication::IsDeviceExtensionSupported(
+    VkPhysicalDevice device, const char* extension_name) {
+    uint32_t extension_count = 0;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count,
+                                         nullptr);
+
+    std::vector<VkExtensionProperties> available_extensions(extension_count);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count,
+                                         available_extensions.data());
+
+    return std::any_of(
+        available_extensions.begin(), available_extensions.end(),
+        [extension_name](const VkExtensionProperties& extension) {
+            return std::strcmp(extension.extensionName, extension_name) == 0;
+        });
+}
+
 TriangleApplication::SwapChainSupportDetails
-TriangleApplication::QuerySwapChainSupport(VkPhysicalDevice device) {
+TriangleApplication::QuerySwapChainSupport(VkPhysicalDevice device,
+                                           VkSurfaceKHR target_surface) {
     TriangleApplication::SwapChainSupportDetails details;
 
     // Query basic surface capabilities
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface,
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, target_surface,
                                               &details.capabilities);
 
     // Querying the supported surface formats
     uint32_t format_count = 0;
-    vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &format_count,
+    vkGetPhysicalDeviceSurfaceFormatsKHR(device, target_surface, &format_count,
                                          nullptr);
 
     if (format_count != 0) {
         details.formats.resize(format_count);
-        vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &format_count,
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device, target_surface,
+                                             &format_count,
                                              details.formats.data());
     }
 
     // Querying the supported presentation modes
     uint32_t present_mode_count = 0;
-    vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface,
+    vkGetPhysicalDeviceSurfacePresentModesKHR(device, target_surface,
                                               &present_mode_count, nullptr);
 
     if (present_mode_count != 0) {
         details.present_modes.resize(present_mode_count);
-        vkGetPhysicalDeviceSurfacePresentModesKHR(
-            device, surface, &present_mode_count, details.present_modes.data());
+        vkGetPhysicalDeviceSurfacePresentModesKHR(device, target_surface,
+                                                  &present_mode_count,
+                                                  details.present_modes.data());
     }
 
     return details;
@@ -564,7 +1186,7 @@ VkPresentModeKHR TriangleApplication::ChooseSwapPresentMode(
 }
 
 VkExtent2D TriangleApplication::ChooseSwapExtent(
-    const VkSurfaceCapabilitiesKHR& capabilities) {
+    const VkSurfaceCapabilitiesKHR& capabilities, VkExtent2D framebuffer_size) {
     // The swap extent is the resolution of the swap chain images and it's
     // usually always exactly equal to the resolution of the window that the
     // program draws in pixels.
@@ -575,18 +1197,14 @@ VkExtent2D TriangleApplication::ChooseSwapExtent(
     // coordinates.
     // The orginal WIDTH and HEIGHT variables will not work.
     // The glfwGetFramebufferSize function is required to query the resolution
-    // of the window in pixels.
+    // of the window in pixels. It can only be called on the main thread, so
+    // the size is passed in from the window events.
     if (capabilities.currentExtent.width !=
         std::numeric_limits<uint32_t>::max()) {
         return capabilities.currentExtent;
     }
 
-    int width = 0;
-    int height = 0;
-    glfwGetFramebufferSize(window, &width, &height);
-
-    VkExtent2D actual_extent = {static_cast<uint32_t>(width),
-                                static_cast<uint32_t>(height)};
+    VkExtent2D actual_extent = framebuffer_size;
 
     actual_extent.width =
         std::clamp(actual_extent.width, capabilities.minImageExtent.width,
@@ -601,12 +1219,13 @@ VkExtent2D TriangleApplication::ChooseSwapExtent(
 
 void TriangleApplication::CreateSwapChain() {
     SwapChainSupportDetails swap_chain_support =
-        QuerySwapChainSupport(physical_device);
+        QuerySwapChainSupport(physical_device, surface);
     VkSurfaceFormatKHR surface_format =
         ChooseSwapSurfaceFormat(swap_chain_support.formats);
     VkPresentModeKHR present_mode =
         ChooseSwapPresentMode(swap_chain_support.present_modes);
-    VkExtent2D extent = ChooseSwapExtent(swap_chain_support.capabilities);
+    VkExtent2D extent =
+        ChooseSwapExtent(swap_chain_support.capabilities, framebuffer_size);
 
     // Decide how many images the program would like to have in the swap chain.
     // Request one more image than the minimum to prevent waiting on the driver
@@ -634,6 +1253,24 @@ void TriangleApplication::CreateSwapChain() {
     create_info.imageArrayLayers = 1;
     create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+    // Screenshots copy the swap chain image into a buffer
+    swap_chain_capture_supported =
+        (swap_chain_support.capabilities.supportedUsageFlags &
+         VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0 &&
+        FrameReadback::IsFormatSupported(surface_format.format);
+    if (swap_chain_capture_supported) {
+        create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
+    // The YUV conversion of the video capture samples the image
+    swap_chain_sampling_supported =
+        (swap_chain_support.capabilities.supportedUsageFlags &
+         VK_IMAGE_USAGE_SAMPLED_BIT) != 0;
+    if (swap_chain_sampling_supported && !options.video_path.empty() &&
+        options.video_format == VIDEO_FORMAT_YUV420) {
+        create_info.imageUsage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+    }
+
     // Handle swap chain images that will be used across multiple queue
     // families.
     //
@@ -689,6 +1326,7 @@ void TriangleApplication::CreateSwapChain() {
         VK_SUCCESS) {
         throw std::runtime_error("failed to create swap chain!");
     }
+    debug_markers.SetName(swap_chain, "swap chain");
 
     // Retrieve the swap chain images
     // 1. First query the final number of images via vkGetSwapchainImagesKHR.
@@ -698,6 +1336,10 @@ void TriangleApplication::CreateSwapChain() {
     swap_chain_images.resize(image_count);
     vkGetSwapchainImagesKHR(device, swap_chain, &image_count,
                             swap_chain_images.data());
+    for (size_t i = 0; i < swap_chain_images.size(); i++) {
+        debug_markers.SetName(swap_chain_images[i],
+                              "swap chain image " + std::to_string(i));
+    }
 
     // Store the format and extent for the swap chain images
     swap_chain_image_format = surface_format.format;
@@ -739,7 +1381,40 @@ void TriangleApplication::CreateImageViews() {
                               &swap_chain_image_views[i]) != VK_SUCCESS) {
             throw std::runtime_error("failed to create image views!");
         }
+        debug_markers.SetName(swap_chain_image_views[i],
+                              "swap chain image view " + std::to_string(i));
+    }
+}
+
+void TriangleApplication::CreateOffscreenTargets() {
+    /* Without a window, the frames are drawn into images owned by the
+    application. There is one for every frame in flight, so the fence of a
+    frame slot guards its image just like an acquired swap chain image. */
+    swap_chain_image_format = HEADLESS_FORMAT;
+    swap_chain_extent = offscreen_extent;
+
+    swap_chain_images.resize(MAX_FRAMES_IN_FLIGHT);
+    offscreen_image_memory.resize(MAX_FRAMES_IN_FLIGHT);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        CreateImage(VK_IMAGE_TYPE_2D,
+                    {swap_chain_extent.width, swap_chain_extent.height, 1}, 1,
+                    swap_chain_image_format,
+                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                        VK_IMAGE_USAGE_SAMPLED_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, swap_chain_images[i],
+                    offscreen_image_memory[i]);
+        debug_markers.SetName(swap_chain_images[i],
+                              "offscreen image " + std::to_string(i));
+        debug_markers.SetName(offscreen_image_memory[i],
+                              "offscreen image memory " + std::to_string(i));
     }
+
+    // The images support everything the captures need
+    swap_chain_capture_supported = true;
+    swap_chain_sampling_supported = true;
+
+    CreateImageViews();
 }
 
 void TriangleApplication::CreateGraphicsPipeline() {
@@ -784,7 +1459,7 @@ void TriangleApplication::CreateGraphicsPipeline() {
     VkPipelineInputAssemblyStateCreateInfo input_assembly{};
     input_assembly.sType =
         VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    input_assembly.topology = TRIANGLE_RASTER_STATE.topology;
     input_assembly.primitiveRestartEnable = VK_FALSE;
 
     // Specify viewport and scissor
@@ -821,8 +1496,8 @@ void TriangleApplication::CreateGraphicsPipeline() {
     // The frontFace variable specifies the vertex order for faces to be
     // considered front-facing.
     // It can be clockwise or counterclockwise
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    rasterizer.cullMode = TRIANGLE_RASTER_STATE.cull_mode;
+    rasterizer.frontFace = TRIANGLE_RASTER_STATE.front_face;
     rasterizer.depthBiasEnable = VK_FALSE;
     rasterizer.depthBiasConstantFactor = 0.0F;  // Optional
     rasterizer.depthBiasClamp = 0.0F;           // Optional
@@ -875,8 +1550,12 @@ void TriangleApplication::CreateGraphicsPipeline() {
 
     // Dynamic State
     // Fill in the dynamic state's information
-    std::vector<VkDynamicState> dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT,
-                                                  VK_DYNAMIC_STATE_SCISSOR};
+    // With extended dynamic state, the raster state above only serves as a
+    // default and the draw sets it in the command buffer
+    std::vector<VkDynamicState> dynamic_states =
+        extended_dynamic_state.GetDynamicStates();
+    dynamic_states.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+    dynamic_states.push_back(VK_DYNAMIC_STATE_SCISSOR);
 
     VkPipelineDynamicStateCreateInfo dynamic_state{};
     dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
@@ -884,13 +1563,19 @@ void TriangleApplication::CreateGraphicsPipeline() {
         static_cast<uint32_t>(dynamic_states.size());
     dynamic_state.pDynamicStates = dynamic_states.data();
 
+    // The vertex shader places the triangle through the camera
+    VkPushConstantRange camera_range{};
+    camera_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    camera_range.offset = 0;
+    camera_range.size = sizeof(CameraPushConstants);
+
     // Fill in the information for the pipeline layout
     VkPipelineLayoutCreateInfo pipeline_layout_info;
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipeline_layout_info.setLayoutCount = 0;             // Optional
-    pipeline_layout_info.pSetLayouts = nullptr;          // Optional
-    pipeline_layout_info.pushConstantRangeCount = 0;     // Optional
-    pipeline_layout_info.pPushConstantRanges = nullptr;  // Optional
+    pipeline_layout_info.setLayoutCount = 0;     // Optional
+    pipeline_layout_info.pSetLayouts = nullptr;  // Optional
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &camera_range;
     pipeline_layout_info.flags =
         VK_PIPELINE_LAYOUT_CREATE_INDEPENDENT_SETS_BIT_EXT;
     pipeline_layout_info.pNext = NULL;
@@ -900,6 +1585,7 @@ void TriangleApplication::CreateGraphicsPipeline() {
                                &pipeline_layout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
     }
+    debug_markers.SetName(pipeline_layout, "triangle pipeline layout");
 
     // Describe the graphics pipeline information
     VkGraphicsPipelineCreateInfo pipeline_info{};
@@ -925,6 +1611,16 @@ void TriangleApplication::CreateGraphicsPipeline() {
                                   nullptr, &graphics_pipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
+    debug_markers.SetName(graphics_pipeline, "triangle pipeline");
+
+    // The same shaders for the shader object path, sharing the push
+    // constants of the pipeline layout
+    if (shader_objects.IsEnabled()) {
+        triangle_shaders = shader_objects.CreateShaderPair(
+            vert_shader_code, frag_shader_code, {}, {camera_range});
+        debug_markers.SetName(triangle_shaders.vertex, "triangle vertex");
+        debug_markers.SetName(triangle_shaders.fragment, "triangle fragment");
+    }
 
     // Destroy shader modules
     vkDestroyShaderModule(device, frag_shader_module, nullptr);
@@ -975,7 +1671,7 @@ void TriangleApplication::CreateRenderPass() {
     // Describe the color buffer attachment represented by one of the images
     // from the swap chain
     VkAttachmentDescription color_attachment{};
-    color_attachment.format = swap_chain_image_format;
+    color_attachment.format = HDR_FORMAT;
     color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
 
     // loadOp and storeOp determine what to do with the data in the attachment
@@ -1018,8 +1714,9 @@ void TriangleApplication::CreateRenderPass() {
     // The initialLayout specifies which layout the image will contain before
     // the render pass begins. The finalLayout specifies the layout to
     // automatically transition to when the render pass finishes.
+    // The HDR scene color is read by the post-processing chain afterwards.
     color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    color_attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
     /* Subpasses and attachment references */
     // Describe the color attachement references.
@@ -1053,7 +1750,8 @@ void TriangleApplication::CreateRenderPass() {
     subpass.pColorAttachments = &color_attachment_ref;
 
     /* Subpass dependencies */
-    VkSubpassDependency dependency{};
+    std::array<VkSubpassDependency, 2> dependencies{};
+    VkSubpassDependency& dependency = dependencies[0];
 
     // The two fields specify the indices of the dependency and the
     // dependent subpass.
@@ -1068,10 +1766,12 @@ void TriangleApplication::CreateRenderPass() {
     dependency.dstSubpass = 0;
 
     // The two fields specify the operations to wait on and the stages in which
-    // these operations occur. We need to wait for the swap chain to finish
-    // reading from the image before we can access it. This can be accomplished
-    // by waiting on the color attachment output stage itself.
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // these operations occur. We need to wait for the post-processing chain
+    // of the previous frame to finish reading from the image before we can
+    // access it.
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     dependency.srcAccessMask = 0;
 
     // The operations that should wait on this are in the color attachment stage
@@ -1081,6 +1781,17 @@ void TriangleApplication::CreateRenderPass() {
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
+    // Make the rendered scene color visible to the compute and fragment
+    // shaders of the post-processing chain
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask =
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
     /* Render pass */
     // Describe the informatioon for the render pass
     VkRenderPassCreateInfo render_pass_info{};
@@ -1089,13 +1800,15 @@ void TriangleApplication::CreateRenderPass() {
     render_pass_info.pAttachments = &color_attachment;
     render_pass_info.subpassCount = 1;
     render_pass_info.pSubpasses = &subpass;
-    render_pass_info.dependencyCount = 1;
-    render_pass_info.pDependencies = &dependency;
+    render_pass_info.dependencyCount =
+        static_cast<uint32_t>(dependencies.size());
+    render_pass_info.pDependencies = dependencies.data();
 
     if (vkCreateRenderPass(device, &render_pass_info, nullptr, &render_pass) !=
         VK_SUCCESS) {
         throw std::runtime_error("failed to create render pass!");
     }
+    debug_markers.SetName(render_pass, "scene render pass");
 }
 
 void TriangleApplication::CreateFramebuffers() {
@@ -1109,7 +1822,7 @@ void TriangleApplication::CreateFramebuffers() {
         // Describe the framebuffer information
         VkFramebufferCreateInfo framebuffer_info{};
         framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebuffer_info.renderPass = render_pass;
+        framebuffer_info.renderPass = composite_render_pass;
         framebuffer_info.attachmentCount = 1;
         framebuffer_info.pAttachments = attachments.data();
         framebuffer_info.width = swap_chain_extent.width;
@@ -1121,6 +1834,8 @@ void TriangleApplication::CreateFramebuffers() {
                                 &swap_chain_framebuffers[i]) != VK_SUCCESS) {
             throw std::runtime_error("failed to create framebuffer!");
         }
+        debug_markers.SetName(swap_chain_framebuffers[i],
+                              "swap chain framebuffer " + std::to_string(i));
     }
 }
 
@@ -1159,6 +1874,7 @@ void TriangleApplication::CreateCommandPool() {
         VK_SUCCESS) {
         throw std::runtime_error("failed to create command pool!");
     }
+    debug_markers.SetName(command_pool, "graphics command pool");
 }
 
 void TriangleApplication::CreateCommandBuffers() {
@@ -1185,6 +1901,10 @@ void TriangleApplication::CreateCommandBuffers() {
         VK_SUCCESS) {
         throw std::runtime_error("failed to allocate command buffers!");
     }
+    for (size_t i = 0; i < command_buffers.size(); i++) {
+        debug_markers.SetName(command_buffers[i],
+                              "frame command buffer " + std::to_string(i));
+    }
 }
 
 void TriangleApplication::RecordCommandBuffer(VkCommandBuffer command_buffer,
@@ -1210,16 +1930,67 @@ void TriangleApplication::RecordCommandBuffer(VkCommandBuffer command_buffer,
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
+    gpu_profiler.BeginFrame(command_buffer, current_frame);
+    descriptor_allocator.BeginFrame(current_frame);
+    mip_generator.BeginFrame(current_frame);
+
+    // The overlay shows the counts of the previous frame
+    last_draw_counts = draw_counts;
+    draw_counts = {};
+
+    // Texture uploads are transfer commands, which have to be recorded
+    // outside of the render pass
+    uint32_t upload_scope =
+        gpu_profiler.BeginScope(command_buffer, "texture upload");
+    texture_streamer.Update(command_buffer, current_frame);
+    gpu_profiler.EndScope(command_buffer, upload_scope);
+
+    RecordScenePass(command_buffer, post_target, camera);
+
+    // Run the post-processing chain and draw its result into the swap chain
+    // image, with the performance overlay on top
+    RecordPostProcessing(command_buffer, post_target);
+    UpdatePerfOverlay();
+    RecordCompositePass(command_buffer, swap_chain_framebuffers[image_index],
+                        swap_chain_extent, post_target, true);
+
+    // Copy the presented image if a screenshot was requested
+    if (swap_chain_capture_supported) {
+        frame_readback.Record(command_buffer, current_frame,
+                              swap_chain_images[image_index],
+                              swap_chain_image_format, swap_chain_extent,
+                              composite_final_layout);
+        video_capture.Record(command_buffer, current_frame,
+                             swap_chain_images[image_index],
+                             swap_chain_image_views[image_index],
+                             swap_chain_image_format, swap_chain_extent,
+                             composite_final_layout);
+    }
+
+    RecordSecondaryWindows(command_buffer);
+
+    // Finish recording the command buffer
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+}
+
+void TriangleApplication::RecordScenePass(VkCommandBuffer command_buffer,
+                                          const PostProcessTarget& target,
+                                          const Camera& view_camera) {
+    uint32_t scene_scope = gpu_profiler.BeginScope(command_buffer, "scene");
+
     /* Starting a render pass */
     // Describe the render pass information
+    // The scene is rendered into the HDR target of the post-processing chain
     VkRenderPassBeginInfo render_pass_info{};
     render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     render_pass_info.renderPass = render_pass;
-    render_pass_info.framebuffer = swap_chain_framebuffers[image_index];
+    render_pass_info.framebuffer = target.scene_framebuffer;
 
     // The two parameters define the size of the render area
     render_pass_info.renderArea.offset = {0, 0};
-    render_pass_info.renderArea.extent = swap_chain_extent;
+    render_pass_info.renderArea.extent = target.extent;
 
     // The two parameters define the clear values to use for
     // VK_ATTACHMENT_LOAD_OP_CLEAR, which we used as the load operation for the
@@ -1239,28 +2010,40 @@ void TriangleApplication::RecordCommandBuffer(VkCommandBuffer command_buffer,
     */
 
     // Begin render pass
-    vkCmdBeginRenderPass(command_buffer, &render_pass_info,
-                         VK_SUBPASS_CONTENTS_INLINE);
+    // Shader objects draw without a render pass, so its layout transition
+    // and dependencies become barriers around dynamic rendering
+    if (shader_objects.IsEnabled()) {
+        scene_barriers.AddImageBarrier(
+            target.hdr_image, ColorLevels(0, 1), VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR |
+             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR |
+             VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR},
+            {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+             VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR});
+        scene_barriers.Flush(command_buffer, synchronization2);
+        shader_objects.CmdBeginRendering(command_buffer, target.hdr_image_view,
+                                         target.extent, clear_color.color);
+    } else {
+        vkCmdBeginRenderPass(command_buffer, &render_pass_info,
+                             VK_SUBPASS_CONTENTS_INLINE);
+    }
 
     /* Basic draw commands */
-    // Bind the graphics pipeline
-    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      graphics_pipeline);
-
     // Set the viewport and scissor state in the command buffer before issuing
     // the draw command.
     VkViewport viewport{};
     viewport.x = 0.0F;
     viewport.y = 0.0F;
-    viewport.width = static_cast<float>(swap_chain_extent.width);
-    viewport.height = static_cast<float>(swap_chain_extent.height);
+    viewport.width = static_cast<float>(target.extent.width);
+    viewport.height = static_cast<float>(target.extent.height);
     viewport.minDepth = 0.0F;
     viewport.maxDepth = 1.0F;
     vkCmdSetViewport(command_buffer, 0, 1, &viewport);
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = swap_chain_extent;
+    scissor.extent = target.extent;
     vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
     /* The vkCmdDraw function has the following parameters aside from the
@@ -1274,17 +2057,52 @@ void TriangleApplication::RecordCommandBuffer(VkCommandBuffer command_buffer,
      lowest value of gl_InstanceIndex.
      */
 
+    // Draw the streamed texture behind the triangle
+    RecordTexturedQuad(command_buffer, view_camera, target.extent);
+
+    // Bind the graphics pipeline, or the shaders of the triangle with the
+    // state the pipeline would hold
+    if (shader_objects.IsEnabled()) {
+        shader_objects.CmdBindShaders(command_buffer, triangle_shaders,
+                                      TRIANGLE_RASTER_STATE, target.extent);
+    } else {
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          graphics_pipeline);
+        extended_dynamic_state.CmdSetState(command_buffer,
+                                           TRIANGLE_RASTER_STATE);
+    }
+
+    CameraPushConstants camera_constants =
+        ComputeCameraPushConstants(view_camera, target.extent);
+    vkCmdPushConstants(command_buffer, pipeline_layout,
+                       VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(camera_constants),
+                       &camera_constants);
+
     // Issue the draw command for the triangle
     vkCmdDraw(command_buffer, 3, 1, 0, 0);
+    draw_counts.draws++;
 
     /* Finishing up */
     // End the render pass
-    vkCmdEndRenderPass(command_buffer);
-
-    // Finish recording the command buffer
-    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
+    if (shader_objects.IsEnabled()) {
+        shader_objects.CmdEndRendering(command_buffer);
+
+        // Make the scene color visible to the post-processing chain
+        scene_barriers.AddImageBarrier(
+            target.hdr_image, ColorLevels(0, 1),
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+             VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR},
+            {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR |
+                 VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR,
+             VK_ACCESS_2_SHADER_READ_BIT_KHR});
+        scene_barriers.Flush(command_buffer, synchronization2);
+    } else {
+        vkCmdEndRenderPass(command_buffer);
     }
+
+    gpu_profiler.EndScope(command_buffer, scene_scope);
 }
 
 void TriangleApplication::DrawFrame() {
@@ -1306,10 +2124,42 @@ void TriangleApplication::DrawFrame() {
     // value of a 64 bit unsigned integer.
     // UINT64_MAX disables the timeout.
 
+    // The CPU time of every phase is shown by the performance overlay
+    auto phase_start = std::chrono::steady_clock::now();
+    double frame_time = AddFrameTime(phase_start);
+
     // Wait until the previous frame has finished, so that the command buffer
     // and semaphores are available to use.
-    vkWaitForFences(device, 1, &in_flight_fences[current_frame], VK_TRUE,
-                    UINT64_MAX);
+    if (vkWaitForFences(device, 1, &in_flight_fences[current_frame], VK_TRUE,
+                        UINT64_MAX) == VK_ERROR_DEVICE_LOST) {
+        HandleDeviceLost("vkWaitForFences");
+        return;
+    }
+
+    // The GPU timings of the frame that previously used this slot are
+    // available now
+    bool gpu_timings_collected = gpu_profiler.Collect(current_frame);
+    UpdateWindowTitle();
+
+    if (metrics.IsRunning()) {
+        metrics.AddFrame(frame_time / 1000.0);
+        if (gpu_timings_collected) {
+            metrics.AddGpuTimings(gpu_profiler.GetResults());
+        }
+        metrics.SetDroppedFrames(frame_pacer.GetDroppedFrames());
+    }
+
+    // So is a capture recorded into the slot, which is written on a worker
+    // thread
+    frame_readback.Collect(current_frame, image_writer);
+    video_capture.Collect(current_frame);
+
+    // Reacting to the memory budget may recreate the render targets, which
+    // is done before any of them is recorded
+    UpdateMemoryPressure();
+
+    // Waiting includes collecting the results of the frame slot
+    phase_start = EndPhase(cpu_timing_sums.wait, phase_start);
 
     /* Suboptimal or out-of-date swap chain
     The vkAcquireNextImageKHR and vkQueuePresentKHR functions can return the
@@ -1327,14 +2177,41 @@ void TriangleApplication::DrawFrame() {
         vkAcquireNextImageKHR(device, swap_chain, UINT64_MAX,
                               image_available_semaphores[current_frame],
                               VK_NULL_HANDLE, &image_index);
+    phase_start = EndPhase(cpu_timing_sums.acquire, phase_start);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
         RecreateSwapChain();
         return;
+    } else if (result == VK_ERROR_DEVICE_LOST) {
+        HandleDeviceLost("vkAcquireNextImageKHR");
+        return;
     } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
         throw std::runtime_error("failed to acquire swap chain image!");
     }
 
+    // The secondary windows are drawn by the same submission, which waits
+    // for all of their images
+    std::vector<VkSemaphore> wait_semaphores = {
+        image_available_semaphores[current_frame]};
+    if (!AcquireSecondaryImages(wait_semaphores)) {
+        // Consume the semaphores of the images that were acquired, so they
+        // are unsignaled again when the frame slot is reused. Nothing waits
+        // for them.
+        std::vector<VkSemaphoreSubmitInfoKHR> consumed;
+        for (VkSemaphore semaphore : wait_semaphores) {
+            consumed.push_back(
+                SemaphoreSubmit(semaphore, VK_PIPELINE_STAGE_2_NONE_KHR));
+        }
+
+        if (synchronization2.Submit(graphics_queue, consumed, {}, {},
+                                    VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit semaphore waits!");
+        }
+
+        RecreateSwapChain();
+        return;
+    }
+
     /* Fixing a deadlock */
     // Only reset the fence if we are submitting work
     vkResetFences(device, 1, &in_flight_fences[current_frame]);
@@ -1345,43 +2222,40 @@ void TriangleApplication::DrawFrame() {
 
     // record the commands
     RecordCommandBuffer(command_buffers[current_frame], image_index);
+    phase_start = EndPhase(cpu_timing_sums.record, phase_start);
 
     /* Submitting the command buffer */
-    // Configure queue submission and synchronization
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    // Configure queue submission and synchronization. Only the composite
+    // pass writes the swap chain images, so everything before it overlaps
+    // with the wait for the images.
+    std::vector<VkSemaphoreSubmitInfoKHR> waits;
+    for (VkSemaphore semaphore : wait_semaphores) {
+        waits.push_back(SemaphoreSubmit(
+            semaphore, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR));
+    }
 
-    std::array<VkSemaphore, 1> wait_semaphores = {
-        image_available_semaphores[current_frame]};
-    std::array<VkPipelineStageFlags, 1> wait_stages = {
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-
-    // The first three parameters specify which semaphores to wait on before
-    // the execution begins and in which stage(s) of the pipeline to wait.
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = wait_semaphores.data();
-    submit_info.pWaitDstStageMask = wait_stages.data();
-
-    // The two parameters specify which command buffers to actually submit for
-    // execution.
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffers[current_frame];
-
-    // The signalSemaphoreCount and pSignalSemaphores parameters specify which
-    // semaphores to signal once the command buffer(s) have finished execution.
-    std::array<VkSemaphore, 1> signal_semaphores = {
-        render_finished_semaphores[current_frame]};
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = signal_semaphores.data();
+    // The semaphore that the presentation waits for is signaled once the
+    // command buffer has finished execution. A frame may end with a copy or
+    // a compute dispatch that reads the swap chain image, so it waits for
+    // every stage.
+    std::vector<VkSemaphoreSubmitInfoKHR> signals = {
+        SemaphoreSubmit(render_finished_semaphores[current_frame],
+                        VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR)};
 
     // On the next frame, the CPU will wait for this command buffer to finish
     // executing before it records new commands into it.
 
     // Submit the command buffer to the graphics queue
-    if (vkQueueSubmit(graphics_queue, 1, &submit_info,
-                      in_flight_fences[current_frame]) != VK_SUCCESS) {
+    result = synchronization2.Submit(graphics_queue, waits,
+                                     {command_buffers[current_frame]},
+                                     signals, in_flight_fences[current_frame]);
+    if (result == VK_ERROR_DEVICE_LOST) {
+        HandleDeviceLost("vkQueueSubmit");
+        return;
+    } else if (result != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
+    phase_start = EndPhase(cpu_timing_sums.submit, phase_start);
 
     /* Presentation */
     VkPresentInfoKHR present_info{};
@@ -1390,28 +2264,59 @@ void TriangleApplication::DrawFrame() {
     // Two paramets specify which semaphores to wait on before presentation can
     // happen.
     present_info.waitSemaphoreCount = 1;
-    present_info.pWaitSemaphores = signal_semaphores.data();
+    present_info.pWaitSemaphores = &render_finished_semaphores[current_frame];
 
     // Two parameters specify the swap chains to present images to and the index
-    // of the image for each swap chain. This will almost always be a single
-    // one.
-    std::array<VkSwapchainKHR, 1> swap_chains = {swap_chain};
-    present_info.swapchainCount = 1;
+    // of the image for each swap chain. Every window is presented by the same
+    // call.
+    std::vector<VkSwapchainKHR> swap_chains = {swap_chain};
+    std::vector<uint32_t> image_indices = {image_index};
+    for (const SecondaryWindow& secondary : secondary_windows) {
+        swap_chains.push_back(secondary.swap_chain);
+        image_indices.push_back(secondary.image_index);
+    }
+    present_info.swapchainCount = static_cast<uint32_t>(swap_chains.size());
     present_info.pSwapchains = swap_chains.data();
-    present_info.pImageIndices = &image_index;
+    present_info.pImageIndices = image_indices.data();
 
     // pResults allows you to specify an array of VkResult values to check every
     // individual swap chain if presentation was successful.
-    // It is not required if you're only using a single swap chain, because you
-    // can simply use the return value of the present function.
-    present_info.pResults = nullptr;  // Optional
+    std::vector<VkResult> results(swap_chains.size(), VK_SUCCESS);
+    present_info.pResults = results.data();
+
+    // The frame pacer waits for this id to find out when the frame is shown
+    std::vector<uint64_t> present_ids(swap_chains.size(),
+                                      frame_pacer.GetNextPresentId());
+    VkPresentIdKHR present_id_info{};
+    present_id_info.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    present_id_info.swapchainCount = static_cast<uint32_t>(present_ids.size());
+    present_id_info.pPresentIds = present_ids.data();
+    if (frame_pacer.IsUsingPresentWait()) {
+        present_info.pNext = &present_id_info;
+    }
 
     // Submit the request to present an image to the swap chain.
     result = vkQueuePresentKHR(present_queue, &present_info);
+    EndPhase(cpu_timing_sums.present, phase_start);
+    frame_pacer.FramePresented(frame_input_time);
+
+    // The return value only reports one of the swap chains
+    bool out_of_date = false;
+    for (VkResult swap_chain_result : results) {
+        out_of_date = out_of_date ||
+                      swap_chain_result == VK_ERROR_OUT_OF_DATE_KHR ||
+                      swap_chain_result == VK_SUBOPTIMAL_KHR;
+    }
+
+    // Recovery starts over with the first frame slot
+    if (result == VK_ERROR_DEVICE_LOST) {
+        HandleDeviceLost("vkQueuePresentKHR");
+        return;
+    }
 
     // Handling resizes explicitly
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR ||
-        framebuffer_resized) {
+    if (out_of_date || result == VK_ERROR_OUT_OF_DATE_KHR ||
+        result == VK_SUBOPTIMAL_KHR || framebuffer_resized) {
         framebuffer_resized = false;
         RecreateSwapChain();
     } else if (result != VK_SUCCESS) {
@@ -1419,7 +2324,47 @@ void TriangleApplication::DrawFrame() {
     }
 
     // Advance to the next frame every time
-    current_frame = (current_frame + 1) & MAX_FRAMES_IN_FLIGHT;
+    current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+void TriangleApplication::DrawOffscreenFrame() {
+    /* Same as DrawFrame, minus the swap chain. The offscreen image of the
+    frame slot is free once its fence has signaled, so there is nothing to
+    acquire or present and no semaphores to wait on. A lost device is not
+    recovered, since the images of the frames in flight would be missing. */
+    if (vkWaitForFences(device, 1, &in_flight_fences[current_frame], VK_TRUE,
+                        UINT64_MAX) == VK_ERROR_DEVICE_LOST) {
+        FailDeviceLost("vkWaitForFences");
+    }
+
+    gpu_profiler.Collect(current_frame);
+    frame_readback.Collect(current_frame, image_writer);
+    video_capture.Collect(current_frame);
+
+    vkResetFences(device, 1, &in_flight_fences[current_frame]);
+    vkResetCommandBuffer(command_buffers[current_frame], 0);
+    RecordCommandBuffer(command_buffers[current_frame], current_frame);
+
+    if (synchronization2.Submit(graphics_queue, {},
+                                {command_buffers[current_frame]}, {},
+                                in_flight_fences[current_frame]) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to submit draw command buffer!");
+    }
+
+    current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+void TriangleApplication::WarmUpStreaming() {
+    for (uint32_t frame = 0; frame < MAX_WARMUP_FRAMES; frame++) {
+        DrawOffscreenFrame();
+
+        TextureStreamerStats stats = texture_streamer.GetStats();
+        if (frame >= MAX_FRAMES_IN_FLIGHT &&
+            stats.resident_levels == stats.total_levels) {
+            break;
+        }
+    }
 }
 
 void TriangleApplication::CreateSyncObjects() {
@@ -1465,27 +2410,46 @@ void TriangleApplication::CreateSyncObjects() {
             throw std::runtime_error(
                 "failed to create synchronization objects for a frame!");
         }
+
+        std::string frame = std::to_string(i);
+        debug_markers.SetName(image_available_semaphores[i],
+                              "image available semaphore " + frame);
+        debug_markers.SetName(render_finished_semaphores[i],
+                              "render finished semaphore " + frame);
+        debug_markers.SetName(in_flight_fences[i], "in flight fence " + frame);
     }
 }
 
 void TriangleApplication::RecreateSwapChain() {
     /* Recreating the swap chain */
     /* Handling minimization */
-    int width = 0;
-    int height = 0;
-    glfwGetFramebufferSize(window, &width, &height);
-    while (width == 0 || height == 0) {
-        glfwGetFramebufferSize(window, &width, &height);
-        glfwWaitEvents();
+    // Try again once every window has a size, the render loop does not draw
+    // in the meantime
+    if (IsAnyWindowMinimized()) {
+        framebuffer_resized = true;
+        return;
     }
 
+    // Frames of the old swap chains are never waited for
+    frame_pacer.Reset();
+    metrics.CountSwapChainRecreation();
+
     vkDeviceWaitIdle(device);
 
     CleanupSwapChain();
+    DestroyPostProcessTarget(post_target);
 
     CreateSwapChain();
     CreateImageViews();
     CreateFramebuffers();
+    CreatePostProcessTarget(post_target, GetRenderExtent(swap_chain_extent),
+                            "main");
+
+    // A resize of any window recreates the swap chains of all of them
+    for (SecondaryWindow& secondary : secondary_windows) {
+        CleanupSecondarySwapChain(secondary);
+        CreateSecondarySwapChain(secondary);
+    }
 }
 
 void TriangleApplication::CleanupSwapChain() {
@@ -1497,6 +2461,14 @@ void TriangleApplication::CleanupSwapChain() {
         vkDestroyImageView(device, swap_chain_image_views[i], nullptr);
     }
 
+    // Offscreen images are owned by the application, swap chain images by
+    // the swap chain
+    for (size_t i = 0; i < offscreen_image_memory.size(); i++) {
+        vkDestroyImage(device, swap_chain_images[i], nullptr);
+        vkFreeMemory(device, offscreen_image_memory[i], nullptr);
+    }
+    offscreen_image_memory.clear();
+
     vkDestroySwapchainKHR(device, swap_chain, nullptr);
 }
 
@@ -1504,5 +2476,200 @@ void TriangleApplication::FramebufferResizeCallback(GLFWwindow* window,
                                                     int width, int height) {
     auto* app = reinterpret_cast<TriangleApplication*>(
         glfwGetWindowUserPointer(window));
-    app->framebuffer_resized = true;
-}
\ No newline at end of file
+
+    WindowEvent event;
+    event.type = WINDOW_EVENT_RESIZE;
+    event.window = app->GetWindowIndex(window);
+    event.framebuffer_size = {static_cast<uint32_t>(width),
+                              static_cast<uint32_t>(height)};
+    app->PushWindowEvent(event);
+}
+
+void TriangleApplication::KeyCallback(GLFWwindow* window, int key,
+                                      int scancode, int action, int mods) {
+    if (action != GLFW_PRESS) {
+        return;
+    }
+
+    auto* app = reinterpret_cast<TriangleApplication*>(
+        glfwGetWindowUserPointer(window));
+
+    WindowEvent event;
+    event.type = WINDOW_EVENT_KEY;
+    event.window = app->GetWindowIndex(window);
+    event.key = key;
+    app->PushWindowEvent(event);
+}
+
+uint32_t TriangleApplication::GetWindowIndex(GLFWwindow* event_window) const {
+    for (size_t i = 0; i < secondary_windows.size(); i++) {
+        if (secondary_windows[i].window == event_window) {
+            return static_cast<uint32_t>(i + 1);
+        }
+    }
+    return 0;
+}
+
+void TriangleApplication::PushWindowEvent(WindowEvent event) {
+    event.time = std::chrono::steady_clock::now();
+    if (!window_events.Push(event)) {
+        std::cerr << "window event queue is full, dropping an event!"
+                  << std::endl;
+    }
+}
+
+void TriangleApplication::ProcessWindowEvents() {
+    // Without input, the latency of a frame is counted from here
+    frame_input_time = std::chrono::steady_clock::now();
+
+    WindowEvent event;
+    while (window_events.Pop(event)) {
+        frame_input_time = std::min(frame_input_time, event.time);
+
+        if (event.type == WINDOW_EVENT_KEY) {
+            HandleKey(event.key);
+        } else if (event.window == 0) {
+            framebuffer_size = event.framebuffer_size;
+            framebuffer_resized = true;
+        } else if (event.window <= secondary_windows.size()) {
+            secondary_windows[event.window - 1].framebuffer_size =
+                event.framebuffer_size;
+            framebuffer_resized = true;
+        }
+    }
+}
+
+void TriangleApplication::HandleKey(int key) {
+    // F12 saves the next presented image
+    if (key == GLFW_KEY_F12) {
+        TakeScreenshot();
+        return;
+    }
+
+    // F1 shows or hides the performance overlay
+    if (key == GLFW_KEY_F1) {
+        overlay_visible = !overlay_visible;
+        return;
+    }
+
+    /* The number keys 1 to 4 toggle the post-processing stages */
+    if (key < GLFW_KEY_1 ||
+        key >= GLFW_KEY_1 + static_cast<int>(POST_STAGE_COUNT)) {
+        return;
+    }
+
+    auto stage = static_cast<size_t>(key - GLFW_KEY_1);
+    post_stage_enabled[stage] = !post_stage_enabled[stage];
+}
+
+double TriangleApplication::GetGpuFrameTime() const {
+    double milliseconds = 0.0;
+    for (const auto& timing : gpu_profiler.GetResults()) {
+        milliseconds += timing.milliseconds;
+    }
+    return milliseconds;
+}
+
+bool TriangleApplication::IsAnyWindowMinimized() const {
+    auto is_minimized = [](VkExtent2D size) {
+        return size.width == 0 || size.height == 0;
+    };
+    if (is_minimized(framebuffer_size)) {
+        return true;
+    }
+    return std::any_of(secondary_windows.begin(), secondary_windows.end(),
+                       [&](const SecondaryWindow& secondary) {
+                           return is_minimized(secondary.framebuffer_size);
+                       });
+}
+
+void TriangleApplication::UpdateWindowTitle() {
+    /* Show the GPU timings in the window title once per second */
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_title_update < std::chrono::seconds(1)) {
+        return;
+    }
+    last_title_update = now;
+
+    std::ostringstream title;
+    title << "Vulkan window";
+    if (shader_objects.IsEnabled()) {
+        title << " (shader objects)";
+    }
+    title.setf(std::ios::fixed);
+    title.precision(3);
+
+    // Invocation counts next to the time tell what bounds a pass
+    for (const auto& timing : gpu_profiler.GetResults()) {
+        title << " | " << timing.name << " " << timing.milliseconds << " ms";
+
+        std::string statistics = FormatStatistics(timing.statistics);
+        if (timing.has_statistics && !statistics.empty()) {
+            title << " (" << statistics << ")";
+        }
+    }
+
+    // Input-to-present latency, marked as estimated without present timing
+    title << " | latency " << frame_pacer.GetAverageLatency() << " ms"
+          << (frame_pacer.IsUsingPresentWait() ? "" : " (est.)");
+
+    // Streaming progress and texture memory in MiB
+    TextureStreamerStats stats = texture_streamer.GetStats();
+    if (stats.texture_count > 0) {
+        title << " | mips " << stats.resident_levels << "/"
+              << stats.total_levels << " | textures "
+              << (stats.allocated_bytes >> 20) << "/"
+              << (stats.budget_bytes >> 20) << " MiB";
+    }
+
+    // GLFW windows can only be changed on the main thread
+    {
+        std::lock_guard<std::mutex> lock(window_title_mutex);
+        pending_window_title = title.str();
+    }
+    glfwPostEmptyEvent();
+}
+
+void TriangleApplication::TakeScreenshot() {
+    if (!swap_chain_capture_supported) {
+        std::cerr << "screenshots are not supported by the swap chain!"
+                  << std::endl;
+        return;
+    }
+
+    // The image is copied at the end of the next frame and written once the
+    // GPU has finished it
+    std::ostringstream path;
+    path << SCREENSHOT_PREFIX << std::setw(4) << std::setfill('0')
+         << screenshot_count++ << ".png";
+    frame_readback.RequestCapture(path.str());
+}
+
+void TriangleApplication::InitVideoCapture() {
+    if (!swap_chain_capture_supported) {
+        std::cerr << "video capture is not supported by the swap chain"
+                  << std::endl;
+        return;
+    }
+
+    VideoFormat format = options.video_format;
+    if (format == VIDEO_FORMAT_YUV420 && !swap_chain_sampling_supported) {
+        std::cerr << "swap chain images cannot be sampled, capturing RGB "
+                     "video instead"
+                  << std::endl;
+        format = VIDEO_FORMAT_RGB;
+    }
+
+    // The pipeline keeps what it needs, the module can go right away
+    VkShaderModule shader_module = VK_NULL_HANDLE;
+    if (format == VIDEO_FORMAT_YUV420) {
+        shader_module = CreateShaderModule(ReadFile("shaders/rgb_to_yuv.spv"));
+    }
+
+    video_capture.Init(physical_device, device, shader_module,
+                       VIDEO_CAPTURE_RING_SIZE, options.video_path, format);
+
+    if (shader_module != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, shader_module, nullptr);
+    }
+}
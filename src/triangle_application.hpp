@@ -4,32 +4,63 @@
 /* Third party libraries */
 #include <vulkan/vulkan.h>
 
-#define VK_USE_PLATFORM_WIN32_KHR
+// GLFW creates the window surface for the platform it runs on, which is
+// Win32 on Windows and X11 or Wayland on Linux, so no native window system
+// headers are needed
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
-#define GLFW_EXPOSE_NATIVE_WIN32
-#include <GLFW/glfw3native.h>
 
 #define GLM_FORCE_RADIUS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
-#include <mat4x4.hpp>
-#include <vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
 
-/* Standard libraries */
-#include <Windows.h>
+/* Local header files */
+#include "app_options.hpp"
+#include "barrier_batch.hpp"
+#include "batch_job.hpp"
+#include "breadcrumbs.hpp"
+#include "debug_markers.hpp"
+#include "descriptor_allocator.hpp"
+#include "diagnostics_log.hpp"
+#include "extended_dynamic_state.hpp"
+#include "frame_pacer.hpp"
+#include "frame_readback.hpp"
+#include "gpu_profiler.hpp"
+#include "image_compare.hpp"
+#include "image_writer.hpp"
+#include "ktx2_validation.hpp"
+#include "memory_budget.hpp"
+#include "metrics_exporter.hpp"
+#include "mip_generator.hpp"
+#include "perf_overlay.hpp"
+#include "shader_objects.hpp"
+#include "spsc_queue.hpp"
+#include "texture_streamer.hpp"
+#include "video_capture.hpp"
 
+/* Standard libraries */
 #include <algorithm>  // Required for std::clamp
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdint>  // Required for uint32_t
 #include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <limits>  // Required for std::numeric_limits
 #include <map>
+#include <mutex>
 #include <optional>
 #include <set>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 const uint32_t WIDTH = 800;
@@ -46,21 +77,179 @@ const std::array<const char*, 3> DEVICE_EXTENSIONS = {
     VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
 };
 
-#define NDEBUG
+// Optional extensions that let the frame pacer wait for frames to be shown
+const std::array<const char*, 2> PRESENT_TIMING_EXTENSIONS = {
+    VK_KHR_PRESENT_ID_EXTENSION_NAME,
+    VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+};
 
-#ifndef NDEBUG  // not debug
-const bool ENABLE_VALIDATION_LAYERS = false;
-#else
-const bool ENABLE_VALIDATION_LAYERS = true;
-#endif
+// Optional extensions that let descriptors be written straight into a buffer
+const std::array<const char*, 3> DESCRIPTOR_BUFFER_EXTENSIONS = {
+    VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME,
+    VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
+    VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+};
+
+// Optional extensions that move the raster state out of the pipelines, in
+// the order they build on each other
+const std::array<const char*, 3> EXTENDED_DYNAMIC_STATE_EXTENSIONS = {
+    VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME,
+    VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME,
+    VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME,
+};
+
+// Extensions of the shader object path. Shader objects draw with dynamic
+// rendering, which needs the render pass 2 extensions in Vulkan 1.1.
+const std::array<const char*, 4> SHADER_OBJECT_EXTENSIONS = {
+    VK_EXT_SHADER_OBJECT_EXTENSION_NAME,
+    VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+    VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+    VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+};
 
 const unsigned int MAX_FRAMES_IN_FLIGHT = 2;
 
+// The scene is rendered into a high dynamic range target before it is tone
+// mapped into the format of the swap chain
+const VkFormat HDR_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+const VkFormat LDR_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+// Number of mip levels in the bloom downsample/upsample pyramid
+const uint32_t MAX_BLOOM_MIP_LEVELS = 6;
+
+// Edge length of the 3D color grading lookup table
+const uint32_t COLOR_GRADING_LUT_SIZE = 16;
+
+// Maximum number of GPU profiler scopes recorded in a single frame of the
+// main target
+const uint32_t MAX_GPU_PROFILER_SCOPES = 16;
+
+// GPU profiler scopes recorded for each offscreen view or secondary window:
+// the scene, the post processing passes and the composite
+const uint32_t GPU_PROFILER_SCOPES_PER_VIEW = 6;
+
+// Lost devices that are recovered before the application gives up, since a
+// device that is lost again right away will not recover
+const uint32_t MAX_DEVICE_RECOVERIES = 3;
+
+// Raster state of the draws. The triangle is culled from behind, while the
+// quads generated in the vertex shaders are drawn from both sides and the
+// overlay is blended over the scene.
+const RasterState TRIANGLE_RASTER_STATE = {
+    VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_CLOCKWISE,
+    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, false, false};
+const RasterState QUAD_RASTER_STATE = {};
+const RasterState OVERLAY_RASTER_STATE = {
+    VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE,
+    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, false, true};
+
+// Texture shown on a quad behind the triangle. It is only drawn if the file
+// exists next to the executable.
+const char* const STREAMED_TEXTURE_PATH = "textures/streamed.ktx2";
+
+// Limits of the texture streamer. The staging size is reserved for every
+// frame in flight and bounds how many bytes are uploaded per frame.
+const uint32_t MAX_STREAMED_TEXTURES = 16;
+const VkDeviceSize TEXTURE_MEMORY_BUDGET = VkDeviceSize{256} << 20;
+const VkDeviceSize TEXTURE_STAGING_SIZE = VkDeviceSize{4} << 20;
+
+/* Response to the device local memory budget of VK_EXT_memory_budget. The
+texture budget shrinks so the total usage stays under the target share of
+the budget, which evicts mips. If the usage still stays above the critical
+share, the render resolution drops a step, which shrinks the render targets
+of the post-processing chain. It rises again once the usage has stayed
+below the relaxed share. */
+const double MEMORY_TARGET_USAGE = 0.85;
+const double MEMORY_CRITICAL_USAGE = 0.95;
+const double MEMORY_RELAXED_USAGE = 0.70;
+
+// Frames the usage has to stay past a mark before the resolution changes,
+// since every change recreates the render targets
+const uint32_t RENDER_SCALE_HYSTERESIS_FRAMES = 120;
+const std::array<float, 3> RENDER_SCALES = {1.0F, 0.75F, 0.5F};
+
+// Images, sizes and number of timed runs of the mip generation benchmark.
+// The last size is past the limit of the compute path and not a power of
+// two, so only the blit path is timed for it.
+const VkFormat MIP_BENCHMARK_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+const std::array<uint32_t, 6> MIP_BENCHMARK_SIZES = {256, 512, 1024, 2048,
+                                                     4096, 5000};
+const uint32_t MIP_BENCHMARK_ITERATIONS = 10;
+
+// Screenshots taken with F12 are numbered and written next to the executable
+const char* const SCREENSHOT_PREFIX = "screenshot_";
+const uint32_t IMAGE_WRITER_THREADS = 1;
+
+// Readback buffers of the video capture. Frames beyond the frames in flight
+// give the writer time to catch up before frames are dropped.
+const uint32_t VIDEO_CAPTURE_RING_SIZE = MAX_FRAMES_IN_FLIGHT + 4;
+
+// Headless rendering draws into offscreen images of this format instead of
+// the swap chain
+const VkFormat HEADLESS_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
+// Frames rendered at most before offline captures, so streamed textures are
+// fully resident
+const uint32_t MAX_WARMUP_FRAMES = 256;
+
+// Limits of an accepted golden image. The tolerance is on a scale of 0 to
+// 255 and absorbs rounding differences between drivers, the fraction allows
+// for pixels along rasterized edges.
+const float GOLDEN_PIXEL_TOLERANCE = 3.0F;
+const double GOLDEN_MAX_DIFFERING_FRACTION = 0.001;
+
+// Batch rendering writes images on more threads and lets at most this many
+// images wait for a writer before it stops rendering ahead
+const uint32_t BATCH_IMAGE_WRITER_THREADS = 4;
+const size_t BATCH_MAX_PENDING_IMAGES = 8;
+
+// Quads of the performance overlay per frame, each a glyph or a rectangle
+const uint32_t OVERLAY_MAX_QUADS = 1024;
+
+// Frames in the frame time graph of the overlay and the time at its top
+const uint32_t OVERLAY_GRAPH_FRAMES = 120;
+const float OVERLAY_GRAPH_MAX_MS = 33.3F;
+
+// The numbers of the overlay are averages over this interval, so they can
+// be read
+const std::chrono::milliseconds OVERLAY_TEXT_INTERVAL(250);
+
+// Window events waiting for the render thread. A full queue drops events, so
+// it holds far more than arrive between two frames.
+const size_t WINDOW_EVENT_QUEUE_SIZE = 1024;
+
+// The render thread checks for events at this interval while a window is
+// minimized and nothing can be drawn
+const std::chrono::milliseconds MINIMIZED_WAIT_INTERVAL(10);
+
+// Window events handed from the main thread to the render thread
+enum WindowEventType : uint32_t {
+    WINDOW_EVENT_KEY,
+    WINDOW_EVENT_RESIZE,
+};
+
+// Compute stages of the post-processing chain in execution order
+enum PostStage : uint32_t {
+    POST_STAGE_BLOOM_DOWNSAMPLE,
+    POST_STAGE_BLOOM_UPSAMPLE,
+    POST_STAGE_TONE_MAP,
+    POST_STAGE_COLOR_GRADE,
+    POST_STAGE_COUNT
+};
+
 class TriangleApplication {
    private:
     GLFWwindow* window{};
     VkInstance instance{};
     VkDebugUtilsMessengerEXT debug_messenger{};
+
+    // Messages of the validation layers, written on a background thread
+    DiagnosticsLog diagnostics_log;
+
+    // Objects are named and command buffers labeled if VK_EXT_debug_utils
+    // is enabled, which debug builds do whenever it is available
+    bool debug_utils_enabled = false;
+    DebugMarkers debug_markers;
     VkPhysicalDevice physical_device = VK_NULL_HANDLE;
     VkDevice device{};
     VkQueue graphics_queue{};
@@ -75,6 +264,15 @@ class TriangleApplication {
     VkPipelineLayout pipeline_layout{};
     VkPipeline graphics_pipeline{};
     std::vector<VkFramebuffer> swap_chain_framebuffers;
+
+    // Headless rendering owns the images standing in for the swap chain,
+    // one for every frame in flight
+    std::vector<VkDeviceMemory> offscreen_image_memory;
+
+    VkExtent2D offscreen_extent = {WIDTH, HEIGHT};
+
+    // Layout the composite pass leaves the swap chain image in
+    VkImageLayout composite_final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
     VkCommandPool command_pool = VK_NULL_HANDLE;
     std::vector<VkCommandBuffer> command_buffers;
     std::vector<VkSemaphore> image_available_semaphores;
@@ -82,7 +280,249 @@ class TriangleApplication {
     std::vector<VkFence> in_flight_fences;
     uint32_t current_frame = 0;
 
+    // Only touched by the render thread once it runs. The size of the
+    // framebuffer is tracked from resize events, because GLFW only allows
+    // querying it on the main thread.
     bool framebuffer_resized = false;
+    VkExtent2D framebuffer_size{};
+
+    // Key press or new framebuffer size of a window, where window 0 is the
+    // main window and window i the secondary window i - 1
+    struct WindowEvent {
+        WindowEventType type = WINDOW_EVENT_KEY;
+        uint32_t window = 0;
+        int key = 0;
+        VkExtent2D framebuffer_size{};
+
+        // Set when the event is queued
+        std::chrono::steady_clock::time_point time;
+    };
+
+    /* The main thread handles the window events and frames are drawn on the
+    render thread, so input and resize drags do not stall rendering. GLFW
+    calls stay on the main thread. */
+    SpscQueue<WindowEvent, WINDOW_EVENT_QUEUE_SIZE> window_events;
+    std::thread render_thread;
+    std::atomic<bool> render_thread_running{false};
+    std::exception_ptr render_thread_error;
+
+    // Oldest input handled by the frame being drawn
+    std::chrono::steady_clock::time_point frame_input_time;
+
+    FramePacer frame_pacer;
+    bool present_wait_supported = false;
+    bool memory_budget_supported = false;
+    bool buffer_marker_supported = false;
+
+    // Barriers and submissions name the exact stages and accesses they
+    // order if the device supports VK_KHR_synchronization2
+    bool synchronization2_supported = false;
+    Synchronization2 synchronization2;
+
+    // The streamed textures are bound from a descriptor buffer instead of
+    // descriptor sets if the device supports VK_EXT_descriptor_buffer
+    bool descriptor_buffer_supported = false;
+
+    // Number of the extended dynamic state extensions that are enabled. The
+    // pipelines declare the raster state dynamic up to that level, and the
+    // draws set it.
+    uint32_t extended_dynamic_state_level = 0;
+    ExtendedDynamicState extended_dynamic_state;
+
+    // With the shader object path, the scene is drawn with these shaders
+    // instead of the triangle and textured quad pipelines, and the layout of
+    // its color target is changed by barriers instead of the render pass
+    ShaderObjects shader_objects;
+    ShaderPair triangle_shaders;
+    ShaderPair textured_shaders;
+    BarrierBatch scene_barriers;
+
+    // Progress of the GPU through the profiled passes, and the number of
+    // times a lost device was recovered
+    Breadcrumbs breadcrumbs;
+    uint32_t device_recoveries = 0;
+
+    // Device local memory read at the start of the last frame, and the step
+    // of the render resolution chosen to stay within its budget
+    DeviceMemoryBudget device_memory;
+    uint32_t render_scale_index = 0;
+    uint32_t memory_pressure_frames = 0;
+    uint32_t memory_headroom_frames = 0;
+
+    // Exports frame, GPU and memory metrics if a file or socket was given
+    MetricsExporter metrics;
+    bool pipeline_statistics_supported = false;
+    double display_refresh_rate = 0.0;
+
+    // Title set by the render thread and applied by the main thread
+    std::mutex window_title_mutex;
+    std::string pending_window_title;
+
+    // Resources of the post-processing chain that depend on the size of the
+    // render target
+    struct PostProcessTarget {
+        VkExtent2D extent{};
+
+        // Scene color in high dynamic range
+        VkImage hdr_image = VK_NULL_HANDLE;
+        VkDeviceMemory hdr_image_memory = VK_NULL_HANDLE;
+        VkImageView hdr_image_view = VK_NULL_HANDLE;
+        VkFramebuffer scene_framebuffer = VK_NULL_HANDLE;
+
+        // Bloom pyramid starting at half the resolution of the target
+        VkImage bloom_image = VK_NULL_HANDLE;
+        VkDeviceMemory bloom_image_memory = VK_NULL_HANDLE;
+        std::vector<VkImageView> bloom_mip_views;
+
+        // Tone mapped and color graded result
+        VkImage ldr_image = VK_NULL_HANDLE;
+        VkDeviceMemory ldr_image_memory = VK_NULL_HANDLE;
+        VkImageView ldr_image_view = VK_NULL_HANDLE;
+
+        // Descriptor sets of every post-processing dispatch
+        VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> bloom_downsample_sets;
+        std::vector<VkDescriptorSet> bloom_upsample_sets;
+        VkDescriptorSet tone_map_set = VK_NULL_HANDLE;
+        VkDescriptorSet color_grade_set = VK_NULL_HANDLE;
+        VkDescriptorSet composite_ldr_set = VK_NULL_HANDLE;
+        VkDescriptorSet composite_hdr_set = VK_NULL_HANDLE;
+    };
+
+    // View of a batch job. All views of a frame share the device, pipelines
+    // and pools, and are submitted together.
+    struct RenderView {
+        std::string name;
+        Camera camera;
+        VkExtent2D extent{};
+        PostProcessTarget post_target;
+
+        // One image and command buffer for every frame in flight
+        std::vector<VkImage> images;
+        std::vector<VkDeviceMemory> image_memory;
+        std::vector<VkImageView> image_views;
+        std::vector<VkFramebuffer> framebuffers;
+        std::vector<VkCommandBuffer> command_buffers;
+        FrameReadback frame_readback;
+    };
+
+    // Window shown next to the main one. It has its own surface, swap chain
+    // and HDR target, and is drawn and presented together with the main
+    // window.
+    struct SecondaryWindow {
+        GLFWwindow* window = nullptr;
+        VkSurfaceKHR surface = VK_NULL_HANDLE;
+        VkSwapchainKHR swap_chain = VK_NULL_HANDLE;
+        VkExtent2D extent{};
+        VkExtent2D framebuffer_size{};
+        std::vector<VkImage> images;
+        std::vector<VkImageView> image_views;
+        std::vector<VkFramebuffer> framebuffers;
+        PostProcessTarget post_target;
+
+        // One for every frame in flight
+        std::vector<VkSemaphore> image_available_semaphores;
+
+        // Image acquired for the frame being drawn
+        uint32_t image_index = 0;
+    };
+
+    // Push constants shared by every post-processing pipeline
+    struct PostPushConstants {
+        std::array<float, 4> params{};
+    };
+
+    VkRenderPass composite_render_pass{};
+    VkPipeline composite_pipeline{};
+    VkDescriptorSetLayout post_descriptor_set_layout{};
+    VkPipelineLayout post_pipeline_layout{};
+    std::array<VkPipeline, POST_STAGE_COUNT> post_pipelines{};
+    VkSampler post_sampler{};
+    VkImage color_grading_lut_image{};
+    VkDeviceMemory color_grading_lut_image_memory{};
+    VkImageView color_grading_lut_image_view{};
+    PostProcessTarget post_target;
+    std::array<bool, POST_STAGE_COUNT> post_stage_enabled = {true, true, true,
+                                                             true};
+
+    // Barrier between two post-processing stages, reused every frame
+    BarrierBatch post_barriers;
+
+    /* Performance overlay drawn over the main window. Every glyph and
+    rectangle is an instance of one quad, read from the slice of the quad
+    ring that belongs to the frame in flight. */
+    bool overlay_visible = false;
+    VkImage overlay_atlas_image{};
+    VkDeviceMemory overlay_atlas_image_memory{};
+    VkImageView overlay_atlas_image_view{};
+    VkSampler overlay_sampler{};
+    VkBuffer overlay_quad_buffer{};
+    VkDeviceMemory overlay_quad_buffer_memory{};
+    void* overlay_quad_data = nullptr;
+    VkDeviceSize overlay_slice_size = 0;
+    uint32_t overlay_quad_count = 0;
+    VkDescriptorSetLayout overlay_descriptor_set_layout{};
+    VkDescriptorPool overlay_descriptor_pool{};
+    VkDescriptorSet overlay_descriptor_set{};
+    VkPipelineLayout overlay_pipeline_layout{};
+    VkPipeline overlay_pipeline{};
+    std::vector<std::string> overlay_lines;
+    std::chrono::steady_clock::time_point last_overlay_text_update;
+
+    // CPU time of the phases of DrawFrame in milliseconds, summed up until
+    // the overlay shows their averages
+    struct CpuFrameTimings {
+        double frame = 0.0;
+        double wait = 0.0;
+        double acquire = 0.0;
+        double record = 0.0;
+        double submit = 0.0;
+        double present = 0.0;
+    };
+
+    CpuFrameTimings cpu_timing_sums;
+    uint32_t cpu_timing_frames = 0;
+    std::chrono::steady_clock::time_point last_frame_start;
+
+    // Ring of the latest frame times, the index is the oldest one
+    std::array<float, OVERLAY_GRAPH_FRAMES> frame_time_history{};
+    uint32_t frame_time_index = 0;
+
+    // Commands recorded for the frame being drawn and the previous one
+    struct DrawCounts {
+        uint32_t draws = 0;
+        uint32_t dispatches = 0;
+    };
+
+    DrawCounts draw_counts;
+    DrawCounts last_draw_counts;
+
+    // Descriptor sets of the current frame slot, and long-lived sets cached
+    // by their contents
+    DescriptorAllocator descriptor_allocator;
+
+    TextureStreamer texture_streamer;
+    VkPipelineLayout textured_pipeline_layout{};
+    VkPipeline textured_pipeline{};
+    std::optional<uint32_t> streamed_texture;
+    std::string scene_texture_path = STREAMED_TEXTURE_PATH;
+    Camera camera;
+    MipGenerator mip_generator;
+
+    AppOptions options;
+    BatchJob batch_job;
+    std::vector<RenderView> render_views;
+    std::vector<SecondaryWindow> secondary_windows;
+    GpuProfiler gpu_profiler;
+
+    // Captures of the presented swap chain images
+    FrameReadback frame_readback;
+    ImageWriter image_writer;
+    bool swap_chain_capture_supported = false;
+    bool swap_chain_sampling_supported = false;
+    VideoCapture video_capture;
+    uint32_t screenshot_count = 0;
+    std::chrono::steady_clock::time_point last_title_update;
 
     struct QueueFamilyIndices {
         std::optional<uint32_t> graphics_family;
@@ -101,10 +541,18 @@ class TriangleApplication {
     void InitVulkan();
     void MainLoop();
     void CleanUp();
+
+    // Everything that belongs to the logical device, which is created anew
+    // when a lost device is recovered
+    void CreateDeviceResources();
+    // Scopes of a frame, including those of every view and window
+    uint32_t GetGpuProfilerScopeCount() const;
+    void DestroyDeviceResources();
     static void CheckExtensionSupport();
     void CreateInstance();
     static bool CheckValidationLayerSupport();
-    static std::vector<const char*> GetRequiredExtensions();
+    static bool IsInstanceExtensionSupported(const char* extension_name);
+    std::vector<const char*> GetRequiredExtensions() const;
     static VKAPI_ATTR VkBool32 VKAPI_CALL
     DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
                   VkDebugUtilsMessageTypeFlagsEXT message_type,
@@ -119,7 +567,7 @@ class TriangleApplication {
     static void DestroyDebugUtilsMessengerEXT(
         VkInstance instance, VkDebugUtilsMessengerEXT debug_messenger,
         const VkAllocationCallbacks* p_allocator);
-    static void PopulateDebugMessengerCreateInfo(
+    void PopulateDebugMessengerCreateInfo(
         VkDebugUtilsMessengerCreateInfoEXT& create_info);
     void PickPhysicalDevice();
     bool IsDeviceSuitable(VkPhysicalDevice device);
@@ -127,14 +575,20 @@ class TriangleApplication {
     void CreateLogicalDevice();
     void CreateSurface();
     static bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
-    SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device);
+    static bool IsDeviceExtensionSupported(VkPhysicalDevice device,
+                                           const char* extension_name);
+    SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device,
+                                                  VkSurfaceKHR target_surface);
     static VkSurfaceFormatKHR ChooseSwapSurfaceFormat(
         const std::vector<VkSurfaceFormatKHR>& available_formats);
     static VkPresentModeKHR ChooseSwapPresentMode(
         const std::vector<VkPresentModeKHR>& available_present_modes);
-    VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
+    static VkExtent2D ChooseSwapExtent(
+        const VkSurfaceCapabilitiesKHR& capabilities,
+        VkExtent2D framebuffer_size);
     void CreateSwapChain();
     void CreateImageViews();
+    void CreateOffscreenTargets();
     void CreateGraphicsPipeline();
     static std::vector<char> ReadFile(const std::string& filename);
     VkShaderModule CreateShaderModule(const std::vector<char>& code);
@@ -144,14 +598,174 @@ class TriangleApplication {
     void CreateCommandBuffers();
     void RecordCommandBuffer(VkCommandBuffer command_buffer,
                              uint32_t image_index);
+
+    // Draws the scene into the HDR target, ready for post-processing
+    void RecordScenePass(VkCommandBuffer command_buffer,
+                         const PostProcessTarget& target,
+                         const Camera& view_camera);
     void DrawFrame();
+    void DrawOffscreenFrame();
     void CreateSyncObjects();
     void RecreateSwapChain();
     void CleanupSwapChain();
     static void FramebufferResizeCallback(GLFWwindow* window, int width,
                                           int height);
+    static void KeyCallback(GLFWwindow* window, int key, int scancode,
+                            int action, int mods);
+    uint32_t GetWindowIndex(GLFWwindow* event_window) const;
+    void PushWindowEvent(WindowEvent event);
+    void RenderLoop();
+    void ProcessWindowEvents();
+    void HandleKey(int key);
+    bool IsAnyWindowMinimized() const;
+
+    // Sum of the GPU profiler scopes of the last collected frame
+    double GetGpuFrameTime() const;
+    void UpdateWindowTitle();
+    void TakeScreenshot();
+    void InitVideoCapture();
+
+    /* Resource helpers */
+    uint32_t FindMemoryType(uint32_t type_filter,
+                            VkMemoryPropertyFlags properties);
+    void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                      VkMemoryPropertyFlags properties, VkBuffer& buffer,
+                      VkDeviceMemory& buffer_memory);
+    void CreateImage(VkImageType image_type, VkExtent3D extent,
+                     uint32_t mip_levels, VkFormat format,
+                     VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
+                     VkImage& image, VkDeviceMemory& image_memory);
+    VkImageView CreateImageView(VkImage image, VkImageViewType view_type,
+                                VkFormat format, uint32_t base_mip_level,
+                                uint32_t level_count);
+    VkPipeline CreateVertexlessPipeline(const std::string& vert_filename,
+                                        const std::string& frag_filename,
+                                        VkPipelineLayout layout,
+                                        VkRenderPass render_pass,
+                                        const RasterState& state = {},
+                                        VkPipelineCreateFlags flags = 0);
+    VkCommandBuffer BeginSingleTimeCommands();
+    void EndSingleTimeCommands(VkCommandBuffer command_buffer);
+    void TransitionImageLayout(VkCommandBuffer command_buffer, VkImage image,
+                               VkImageLayout old_layout,
+                               VkImageLayout new_layout, uint32_t mip_levels);
+
+    // Same transition, added to a batch that is flushed by the caller
+    static void AddLayoutTransition(BarrierBatch& barriers, VkImage image,
+                                    VkImageLayout old_layout,
+                                    VkImageLayout new_layout,
+                                    uint32_t mip_levels);
+    static void CopyBufferToImage(VkCommandBuffer command_buffer,
+                                  VkBuffer buffer, VkImage image,
+                                  VkExtent3D extent, uint32_t mip_level);
+
+    /* Post-processing */
+    void CreateCompositeRenderPass();
+    void CreatePostProcessingPipelines();
+    VkPipeline CreateComputePipeline(const std::string& filename,
+                                     VkPipelineLayout layout);
+    void CreateCompositePipeline();
+    void CreateColorGradingLut();
+    // The name prefixes the debug names of the resources of the target
+    void CreatePostProcessTarget(PostProcessTarget& target, VkExtent2D extent,
+                                 const std::string& name);
+    void DestroyPostProcessTarget(PostProcessTarget& target);
+    void WritePostDescriptorSet(VkDescriptorSet descriptor_set,
+                                VkImageView input_view,
+                                VkImageLayout input_layout,
+                                VkImageView output_view,
+                                VkImageView auxiliary_view,
+                                VkImageLayout auxiliary_layout);
+    void CleanupPostProcessing();
+    void RecordPostProcessing(VkCommandBuffer command_buffer,
+                              const PostProcessTarget& target);
+    void PostBarrier(VkCommandBuffer command_buffer, SyncScope src,
+                     SyncScope dst);
+    void RecordCompositePass(VkCommandBuffer command_buffer,
+                             VkFramebuffer framebuffer, VkExtent2D extent,
+                             const PostProcessTarget& target,
+                             bool draw_overlay);
+
+    /* Texture streaming */
+    void InitTextureStreaming();
+    void CleanupTextureStreaming();
+    void RecordTexturedQuad(VkCommandBuffer command_buffer,
+                            const Camera& view_camera, VkExtent2D extent);
+
+    /* Device loss */
+    // Reports the progress of the frames in flight, then recovers the device
+    // if requested and throws otherwise
+    void HandleDeviceLost(const std::string& call);
+    // Reports the progress of the frames in flight and throws. Used where the
+    // frames lost with the device cannot be made up for, such as offline
+    // rendering.
+    void FailDeviceLost(const std::string& call);
+    void ReportDeviceLost(const std::string& call);
+    void RecoverDevice();
+
+    /* Memory budget */
+    // Adapts the texture budget and the render resolution to the memory
+    // budget of the device, every frame after the fence of the frame slot
+    void UpdateMemoryPressure();
+
+    // Size of the scene and post-processing targets of a window
+    VkExtent2D GetRenderExtent(VkExtent2D window_extent) const;
+
+    /* Performance overlay */
+    void InitPerfOverlay();
+    void CleanupPerfOverlay();
+
+    // Returns the time since the previous frame started in milliseconds
+    double AddFrameTime(std::chrono::steady_clock::time_point frame_start);
+
+    // Writes the quads of the frame in flight, nothing if it is hidden
+    void UpdatePerfOverlay();
+    void UpdatePerfOverlayText();
+
+    // Drawn inside the composite render pass, over the final image
+    void RecordPerfOverlay(VkCommandBuffer command_buffer, VkExtent2D extent);
+
+    /* Mip generation benchmark */
+    void RunMipBenchmark();
+    double TimeMipGeneration(VkQueryPool query_pool, VkImage image,
+                             VkExtent2D extent, uint32_t level_count,
+                             bool use_compute);
+
+    // Renders until every streamed mip level is resident
+    void WarmUpStreaming();
+
+    /* Golden image regression */
+    bool RunGoldenImages();
+    bool CheckGoldenImage(const std::string& name,
+                          const std::string& golden_path,
+                          const std::string& actual_path);
+
+    /* Batch rendering */
+    bool RunBatchJob();
+    void PrintGpuAverages() const;
+    void CreateRenderViews(const std::vector<BatchView>& views);
+    void DestroyRenderViews();
+    void RecordRenderView(RenderView& view, const Camera& base_camera);
+    void DrawRenderViews();
+
+    /* Multiple windows */
+    void CreateSecondaryWindows();
+    void DestroySecondaryWindows();
+    void CreateSecondarySwapChain(SecondaryWindow& secondary);
+    void CleanupSecondarySwapChain(SecondaryWindow& secondary);
+
+    // Swap chain and semaphores, which the window outlives
+    void CreateSecondaryDeviceObjects(SecondaryWindow& secondary);
+    void DestroySecondaryDeviceObjects(SecondaryWindow& secondary);
+    bool IsAnyWindowClosed() const;
+
+    // Acquires an image of every secondary window and adds the semaphores
+    // that are signaled to the list. False if a swap chain is out of date.
+    bool AcquireSecondaryImages(std::vector<VkSemaphore>& wait_semaphores);
+    void RecordSecondaryWindows(VkCommandBuffer command_buffer);
 
    public:
+    explicit TriangleApplication(const AppOptions& options = {});
     void Run();
 };
 
@@ -0,0 +1,551 @@
+/* Local header files */
+#include "video_capture.hpp"
+
+/* Standard libraries */
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include <algorithm>  // Required for std::sort
+#include <array>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Invocations of the conversion shader in each dimension of a work group.
+// Every invocation converts a block of 8x2 pixels.
+const uint32_t CONVERSION_GROUP_SIZE = 8;
+const uint32_t CONVERSION_BLOCK_WIDTH = 8;
+const uint32_t CONVERSION_BLOCK_HEIGHT = 2;
+
+struct ConversionPushConstants {
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    // Sampling an sRGB image returns linear values, which have to be
+    // encoded again before they are converted
+    uint32_t encode_srgb = 0;
+};
+
+bool IsSrgb(VkFormat format) {
+    return format == VK_FORMAT_R8G8B8A8_SRGB ||
+           format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+// Name of the pixel format as ffmpeg expects it after -pixel_format
+const char* GetPixelFormatName(VideoFormat format, VkFormat image_format) {
+    if (format == VIDEO_FORMAT_YUV420) {
+        return "yuv420p";
+    }
+
+    bool bgr = image_format == VK_FORMAT_B8G8R8A8_UNORM ||
+               image_format == VK_FORMAT_B8G8R8A8_SRGB;
+    return bgr ? "bgra" : "rgba";
+}
+
+}  // namespace
+
+void VideoCapture::Init(VkPhysicalDevice physical_device, VkDevice device,
+                        VkShaderModule shader_module, uint32_t ring_size,
+                        const std::string& path, VideoFormat format) {
+    this->physical_device = physical_device;
+    this->device = device;
+    this->format = format;
+
+    // "-" streams to stdout, e.g. into a pipe to an encoder
+    if (path == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        output = stdout;
+        output_is_stdout = true;
+    } else {
+        output = std::fopen(path.c_str(), "wb");
+        if (output == nullptr) {
+            throw std::runtime_error("failed to open video output: " + path +
+                                     "!");
+        }
+    }
+
+    ring.resize(ring_size);
+    if (format == VIDEO_FORMAT_YUV420) {
+        CreatePipeline(shader_module, ring_size);
+    }
+
+    writer = std::thread(&VideoCapture::WriterLoop, this);
+    active = true;
+}
+
+void VideoCapture::Destroy() {
+    if (!active && !writer.joinable()) {
+        return;
+    }
+
+    {
+        // Every recorded frame has completed, so they are written in the
+        // order they were captured
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::vector<uint32_t> recorded;
+        for (uint32_t i = 0; i < ring.size(); i++) {
+            if (ring[i].state == ENTRY_STATE_RECORDED) {
+                recorded.push_back(i);
+            }
+        }
+        std::sort(recorded.begin(), recorded.end(),
+                  [this](uint32_t a, uint32_t b) {
+                      return ring[a].sequence < ring[b].sequence;
+                  });
+
+        for (uint32_t index : recorded) {
+            ring[index].state = ENTRY_STATE_WRITING;
+            write_queue.push_back(index);
+        }
+        stopping = true;
+    }
+    entry_queued.notify_one();
+    writer.join();
+
+    if (output_is_stdout) {
+        std::fflush(output);
+    } else {
+        std::fclose(output);
+    }
+    output = nullptr;
+    active = false;
+
+    std::cerr << "video capture: " << written_frames << " frames written, "
+              << dropped_frames << " dropped" << std::endl;
+
+    for (auto& entry : ring) {
+        entry.readback_buffer.Free(device);
+    }
+    ring.clear();
+
+    if (format == VIDEO_FORMAT_YUV420) {
+        vkDestroySampler(device, sampler, nullptr);
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
+        vkDestroyDescriptorPool(device, descriptor_pool, nullptr);
+        vkDestroyDescriptorSetLayout(device, descriptor_set_layout, nullptr);
+    }
+}
+
+bool VideoCapture::IsActive() const { return active; }
+
+void VideoCapture::Record(VkCommandBuffer command_buffer, uint32_t frame,
+                          VkImage image, VkImageView image_view,
+                          VkFormat image_format, VkExtent2D image_extent,
+                          VkImageLayout layout) {
+    if (!active) {
+        return;
+    }
+
+    // The conversion works on blocks of 8x2 pixels, the remaining columns
+    // and rows are cropped
+    VkExtent2D capture_extent = image_extent;
+    if (format == VIDEO_FORMAT_YUV420) {
+        capture_extent.width -= capture_extent.width % CONVERSION_BLOCK_WIDTH;
+        capture_extent.height -=
+            capture_extent.height % CONVERSION_BLOCK_HEIGHT;
+    }
+
+    if (frame_size == 0) {
+        if (!FrameReadback::IsFormatSupported(image_format) ||
+            capture_extent.width == 0 || capture_extent.height == 0) {
+            throw std::runtime_error("image cannot be captured as video!");
+        }
+
+        this->image_format = image_format;
+        AllocateRing(capture_extent);
+
+        // The stream has no header, so the encoder has to be told the size
+        std::cerr << "video capture: " << extent.width << "x" << extent.height
+                  << " " << GetPixelFormatName(format, image_format)
+                  << std::endl;
+    }
+
+    // A raw stream cannot change its size, e.g. after a window resize
+    if (capture_extent.width != extent.width ||
+        capture_extent.height != extent.height) {
+        dropped_frames++;
+        return;
+    }
+
+    RingEntry* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (write_failed) {
+            active = false;
+            return;
+        }
+
+        for (auto& candidate : ring) {
+            if (candidate.state == ENTRY_STATE_FREE) {
+                entry = &candidate;
+                break;
+            }
+        }
+
+        // The writer has fallen behind, rendering does not wait for it
+        if (entry == nullptr) {
+            dropped_frames++;
+            return;
+        }
+
+        entry->state = ENTRY_STATE_RECORDED;
+        entry->frame = frame;
+        entry->sequence = next_sequence++;
+    }
+
+    if (format == VIDEO_FORMAT_YUV420) {
+        RecordConversion(command_buffer, *entry, image, image_view, layout);
+    } else {
+        RecordCopy(command_buffer, *entry, image, layout);
+    }
+}
+
+void VideoCapture::Collect(uint32_t frame) {
+    if (!active) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < ring.size(); i++) {
+            if (ring[i].state == ENTRY_STATE_RECORDED &&
+                ring[i].frame == frame) {
+                ring[i].state = ENTRY_STATE_WRITING;
+                write_queue.push_back(i);
+            }
+        }
+    }
+    entry_queued.notify_one();
+}
+
+void VideoCapture::CreatePipeline(VkShaderModule shader_module,
+                                  uint32_t ring_size) {
+    /* Binding 0: the captured image
+    Binding 1: the planes of the converted frame */
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+    layout_info.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr,
+                                    &descriptor_set_layout) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create video capture descriptor set layout!");
+    }
+
+    // Every entry of the ring owns a descriptor set, which is only rewritten
+    // while the entry is free
+    std::array<VkDescriptorPoolSize, 2> pool_sizes{};
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_sizes[0].descriptorCount = ring_size;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_sizes[1].descriptorCount = ring_size;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
+    pool_info.maxSets = ring_size;
+
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr,
+                               &descriptor_pool) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create video capture descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(ring_size,
+                                               descriptor_set_layout);
+    std::vector<VkDescriptorSet> descriptor_sets(ring_size);
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = descriptor_pool;
+    alloc_info.descriptorSetCount = ring_size;
+    alloc_info.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &alloc_info,
+                                 descriptor_sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to allocate video capture descriptor sets!");
+    }
+
+    for (uint32_t i = 0; i < ring_size; i++) {
+        ring[i].descriptor_set = descriptor_sets[i];
+    }
+
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(ConversionPushConstants);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr,
+                               &pipeline_layout) != VK_SUCCESS) {
+        throw std::runtime_error(
+            "failed to create video capture pipeline layout!");
+    }
+
+    VkComputePipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_info.stage.module = shader_module;
+    pipeline_info.stage.pName = "main";
+    pipeline_info.layout = pipeline_layout;
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeline_info,
+                                 nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create video capture pipeline!");
+    }
+
+    // Pixels are fetched one by one, no filtering is involved
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_NEAREST;
+    sampler_info.minFilter = VK_FILTER_NEAREST;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &sampler) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create video capture sampler!");
+    }
+}
+
+void VideoCapture::AllocateRing(VkExtent2D extent) {
+    this->extent = extent;
+
+    // A 4:2:0 frame stores a full resolution luma plane and two chroma
+    // planes at a quarter of the resolution each
+    VkDeviceSize pixel_count = VkDeviceSize{extent.width} * extent.height;
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (format == VIDEO_FORMAT_YUV420) {
+        frame_size = pixel_count * 3 / 2;
+        usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    } else {
+        frame_size = pixel_count * 4;
+    }
+
+    for (auto& entry : ring) {
+        entry.readback_buffer.Allocate(physical_device, device, frame_size,
+                                       usage);
+    }
+}
+
+void VideoCapture::WriterLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        entry_queued.wait(lock,
+                          [this] { return stopping || !write_queue.empty(); });
+
+        if (write_queue.empty()) {
+            return;
+        }
+
+        uint32_t index = write_queue.front();
+        write_queue.pop_front();
+        bool skip = write_failed;
+        lock.unlock();
+
+        // The mapped memory is written out directly, the entry stays out of
+        // the ring until then
+        const ReadbackBuffer& readback_buffer = ring[index].readback_buffer;
+        bool written = false;
+        if (!skip) {
+            readback_buffer.Invalidate(device);
+            written = std::fwrite(readback_buffer.mapped_data, 1, frame_size,
+                                  output) == frame_size;
+            if (!written) {
+                std::cerr << "failed to write video frame!" << std::endl;
+            }
+        }
+
+        lock.lock();
+        ring[index].state = ENTRY_STATE_FREE;
+        if (written) {
+            written_frames++;
+        } else {
+            write_failed = true;
+        }
+    }
+}
+
+void VideoCapture::RecordConversion(VkCommandBuffer command_buffer,
+                                    RingEntry& entry, VkImage image,
+                                    VkImageView image_view,
+                                    VkImageLayout layout) {
+    VkDescriptorImageInfo image_info{};
+    image_info.sampler = sampler;
+    image_info.imageView = image_view;
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkDescriptorBufferInfo buffer_info{};
+    buffer_info.buffer = entry.readback_buffer.buffer;
+    buffer_info.offset = 0;
+    buffer_info.range = frame_size;
+
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = entry.descriptor_set;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].descriptorCount = 1;
+    writes[0].pImageInfo = &image_info;
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = entry.descriptor_set;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[1].descriptorCount = 1;
+    writes[1].pBufferInfo = &buffer_info;
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()),
+                           writes.data(), 0, nullptr);
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr,
+                         0, nullptr, 1, &barrier);
+
+    ConversionPushConstants push_constants;
+    push_constants.width = extent.width;
+    push_constants.height = extent.height;
+    push_constants.encode_srgb = IsSrgb(image_format) ? 1 : 0;
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipeline_layout, 0, 1, &entry.descriptor_set, 0,
+                            nullptr);
+    vkCmdPushConstants(command_buffer, pipeline_layout,
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push_constants),
+                       &push_constants);
+
+    const uint32_t group_width = CONVERSION_GROUP_SIZE * CONVERSION_BLOCK_WIDTH;
+    const uint32_t group_height =
+        CONVERSION_GROUP_SIZE * CONVERSION_BLOCK_HEIGHT;
+    vkCmdDispatch(command_buffer,
+                  (extent.width + group_width - 1) / group_width,
+                  (extent.height + group_height - 1) / group_height, 1);
+
+    // Hand the image back and make the planes visible to the host
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = layout;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = 0;
+
+    VkBufferMemoryBarrier buffer_barrier{};
+    buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    buffer_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    buffer_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.buffer = entry.readback_buffer.buffer;
+    buffer_barrier.offset = 0;
+    buffer_barrier.size = frame_size;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT |
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &buffer_barrier, 1, &barrier);
+}
+
+void VideoCapture::RecordCopy(VkCommandBuffer command_buffer, RingEntry& entry,
+                              VkImage image, VkImageLayout layout) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+
+    vkCmdCopyImageToBuffer(command_buffer, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           entry.readback_buffer.buffer, 1, &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = layout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+
+    VkBufferMemoryBarrier buffer_barrier{};
+    buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    buffer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    buffer_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.buffer = entry.readback_buffer.buffer;
+    buffer_barrier.offset = 0;
+    buffer_barrier.size = frame_size;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT |
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &buffer_barrier, 1, &barrier);
+}
@@ -0,0 +1,122 @@
+#ifndef VIDEO_CAPTURE_H
+#define VIDEO_CAPTURE_H
+
+/* Third party libraries */
+#include <vulkan/vulkan.h>
+
+/* Local header files */
+#include "frame_readback.hpp"
+
+/* Standard libraries */
+#include <condition_variable>
+#include <cstdint>  // Required for uint32_t
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pixel layout of the raw video stream
+enum VideoFormat : uint32_t {
+    // Planar 8 bit 4:2:0 with BT.709 limited range, ffmpeg's yuv420p
+    VIDEO_FORMAT_YUV420,
+
+    // The four channels of the captured image as they are stored in memory
+    VIDEO_FORMAT_RGB
+};
+
+/* Streams every presented frame as raw video into a file or a pipe, for
+example into ffmpeg reading from stdin.
+
+Each frame is captured into the next free buffer of a ring. Once the fence
+of the frame has signaled, the buffer is handed to a writer thread that
+writes it straight from the mapped memory and then returns it to the ring.
+With more buffers than frames in flight, a slow write does not hold back
+rendering. If the ring runs dry, the frame is dropped instead.
+
+In YUV mode, a compute shader converts the image before the readback,
+which halves the number of bytes read back and written. */
+class VideoCapture {
+   private:
+    enum EntryState : uint32_t {
+        ENTRY_STATE_FREE,
+        ENTRY_STATE_RECORDED,
+        ENTRY_STATE_WRITING
+    };
+
+    struct RingEntry {
+        ReadbackBuffer readback_buffer;
+        VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+        EntryState state = ENTRY_STATE_FREE;
+        uint32_t frame = 0;
+
+        // Order in which the entries were captured
+        uint64_t sequence = 0;
+    };
+
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VideoFormat format = VIDEO_FORMAT_YUV420;
+    bool active = false;
+
+    VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+    VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    // The size of the stream is fixed by the first captured frame
+    VkExtent2D extent{};
+    VkFormat image_format = VK_FORMAT_UNDEFINED;
+    VkDeviceSize frame_size = 0;
+
+    // The ring is shared with the writer thread
+    std::vector<RingEntry> ring;
+    std::deque<uint32_t> write_queue;
+    std::mutex mutex;
+    std::condition_variable entry_queued;
+    std::thread writer;
+    bool stopping = false;
+    bool write_failed = false;
+    uint64_t next_sequence = 0;
+
+    std::FILE* output = nullptr;
+    bool output_is_stdout = false;
+    uint64_t written_frames = 0;
+    uint64_t dropped_frames = 0;
+
+    void CreatePipeline(VkShaderModule shader_module, uint32_t ring_size);
+    void AllocateRing(VkExtent2D extent);
+    void WriterLoop();
+    void RecordConversion(VkCommandBuffer command_buffer, RingEntry& entry,
+                          VkImage image, VkImageView image_view,
+                          VkImageLayout layout);
+    void RecordCopy(VkCommandBuffer command_buffer, RingEntry& entry,
+                    VkImage image, VkImageLayout layout);
+
+   public:
+    // The shader module is only needed for VIDEO_FORMAT_YUV420
+    void Init(VkPhysicalDevice physical_device, VkDevice device,
+              VkShaderModule shader_module, uint32_t ring_size,
+              const std::string& path, VideoFormat format);
+
+    // Writes the captured frames that are still queued and closes the
+    // output. The device must be idle.
+    void Destroy();
+
+    bool IsActive() const;
+
+    // Record the capture of the image into the command buffer of the frame
+    // slot. The image is expected in the given layout after it has been
+    // written as a color attachment and is left in that layout.
+    void Record(VkCommandBuffer command_buffer, uint32_t frame, VkImage image,
+                VkImageView image_view, VkFormat image_format,
+                VkExtent2D image_extent, VkImageLayout layout);
+
+    // Queue the frames recorded into the slot for writing. Must be called
+    // after the fence of the slot has signaled.
+    void Collect(uint32_t frame);
+};
+
+#endif  // VIDEO_CAPTURE_H
@@ -1,10 +1,9 @@
 /* Local header files */
 #include "triangle_application.hpp"
 
-int main() {
-    TriangleApplication app;
-
+int main(int argc, char* argv[]) {
     try {
+        TriangleApplication app(ParseArguments(argc, argv));
         app.Run();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;